@@ -1,7 +1,20 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include "emergency.h"
+#include "fast_boot.h"
+#include "panel_pm.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "task_monitor.h"
+#include "event_log.h"
+#include "estop_logic.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "hal/gpio_ll.h"
+#endif
 
 #define TAG "EMERGENCY_ALARM"
 
@@ -14,17 +27,228 @@
  *  - PLC or controller can see this as many ON/OFF events
  * 
  * In safety systems we want ONE clean event per press.
- * Software debounce = wait a short time, then recheck.
- *  - Here: 50 ms is used (commonly safe for panel push buttons)
+ * Software debounce = the level must stay unchanged for a short time.
+ *  - Default: 50 ms (commonly safe for panel push buttons)
+ * 
+ * The input bus (input_bus.h) does this once per pin, so the same
+ * button can also feed the mode selector without a second debounce.
+ */
+// Debounce time and blink speed: emergency_config_t (menuconfig defaults)
+
+#define EMERGENCY_TASK_STACK    3072
+#define EMERGENCY_TASK_PRIORITY 6   // Above the other panel tasks: safety first
+#define EMERGENCY_STOP_TIMEOUT_MS 1000
+
+/*
+ * RETAINED ALARM STATE:
+ * ---------------------
+ * An emergency must NOT be forgotten just because the controller
+ * rebooted (watchdog, brownout, firmware panic).
+ * The alarm flag is kept in RTC memory and re-applied at start-up.
+ */
+static FAST_BOOT_SLOT_ATTR fast_boot_slot_t retained_alarm[CONFIG_EMERGENCY_MAX_INSTANCES];
+
+/*
+ * E-STOP LATCH (interrupt level):
+ * -------------------------------
+ * The alarm lamp must not wait for the task to be scheduled, finish a
+ * blink or sit out the debounce. While the alarm is OFF the button
+ * interrupt is armed for LOW, and its IRAM handler switches the lamp
+ * ON through the GPIO register at once, taking the pin back from a
+ * LEDC mode blink sharing the lamp. It also posts ON to the output
+ * manager, so that blink cannot switch it off again.
+ * 
+ * The task does everything else afterwards:
+ *  - Debounce: a trip that is not confirmed 50 ms later was noise →
+ *    lamp is released again (logged as glitch). A spike already gone
+ *    when the bus samples the pin also arrives as GLITCH.
+ *  - Acknowledge: a press while the alarm is active resets it; this is
+ *    never done in the interrupt
+ * 
+ * WORST-CASE REACTION TIME:
+ *  - Bus task waiting  → interrupt latency only (a few µs)
+ *  - Bus task sampling → the pin interrupt is off for that short pass
+ *    and fires the moment the bus re-arms it
+ *  The latch stays armed while this loop runs; only an active alarm or
+ *  a held button disarms it. The loop's busy time is still measured
+ *  every iteration and checked against CONFIG_EMERGENCY_REACTION_BOUND_US;
+ *  every trip logs both numbers.
+ */
+typedef struct {
+    gpio_num_t button_pin;
+    panel_output_t *lamp;      // Alarm-priority request on the lamp pin
+    volatile bool armed;       // Task: alarm is OFF, ISR may latch
+    volatile bool tripped;     // ISR: lamp switched ON, not yet seen by the task
+    volatile int64_t isr_us;   // ISR entry time of the last trip
+    volatile int64_t lamp_us;  // Lamp output written
+} estop_latch_t;
+
+/*
+ * RUNTIME STATE PER INSTANCE:
+ *  - Static (not on the task stack) so the console can read the
+ *    status, inject button presses and stop the loop
  */
-#define DEBOUNCE_DELAY 50  // Wait 50ms to confirm button press
+typedef struct {
+    emergency_config_t config;     // Copy used by the running loop
+    TaskHandle_t task;
+    input_bus_sub_t sub;           // E-STOP button events
+    panel_output_t lamp;           // Alarm lamp, alarm priority
+    estop_latch_t latch;
+    volatile bool active;          // Loop running (or its task starting)
+    volatile bool stop_requested;
+    emergency_status_t status;
+} emergency_instance_t;
+
+static emergency_instance_t instances[CONFIG_EMERGENCY_MAX_INSTANCES];
+
+static void IRAM_ATTR estop_latch_isr(void *arg)
+{
+    estop_latch_t *latch = (estop_latch_t *)arg;
+    int64_t entry_us = esp_timer_get_time();
+
+#if CONFIG_IDF_TARGET_LINUX
+    // Host build: simulated pins, no register access
+    int level = gpio_get_level(latch->button_pin);
+#else
+    int level = gpio_ll_get_level(&GPIO, latch->button_pin);
+#endif
+    // Release interrupt or alarm already active: nothing to latch
+    if (!latch->armed || level != 0) {
+        return;
+    }
+    panel_output_set_from_isr(latch->lamp, true);  // Writes the pin, even out of a STATUS blink
+    latch->lamp_us = esp_timer_get_time();
+    latch->isr_us = entry_us;
+    latch->armed = false;
+    latch->tripped = true;
+}
+
+static bool config_valid(const emergency_config_t *config)
+{
+    return config && config->instance < CONFIG_EMERGENCY_MAX_INSTANCES &&
+           GPIO_IS_VALID_GPIO(config->button_pin) &&
+           GPIO_IS_VALID_OUTPUT_GPIO(config->alarm_led_pin);
+}
+
+void emergency_alarm_fast_restore(const emergency_config_t *config)
+{
+    uint32_t value;
+    if (!config_valid(config) || !fast_boot_slot_load(&retained_alarm[config->instance], &value)) {
+        return;
+    }
 
-void emergency_alarm_run(void)
+    // Drive the alarm lamp immediately - no banner, no button setup yet
+    panel_output_restore(config->alarm_led_pin, value != 0);
+}
+
+static void emergency_alarm_task(void *arg)
 {
+    emergency_alarm_run((const emergency_config_t *)arg);
+    vTaskDelete(NULL);  // Stopped
+}
+
+esp_err_t emergency_alarm_start(const emergency_config_t *config)
+{
+    if (!config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    emergency_instance_t *self = &instances[config->instance];
+    if (self->active) {
+        return ESP_ERR_INVALID_STATE;  // Already running
+    }
+    self->config = *config;
+    self->stop_requested = false;
+    self->active = true;
+    if (xTaskCreate(emergency_alarm_task, "emergency", EMERGENCY_TASK_STACK,
+                    &self->config, EMERGENCY_TASK_PRIORITY, &self->task) != pdPASS) {
+        self->active = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t emergency_alarm_stop(uint8_t instance)
+{
+    if (instance >= CONFIG_EMERGENCY_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    emergency_instance_t *self = &instances[instance];
+    if (!self->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    self->stop_requested = true;
+    xTaskNotifyGive(self->task);
+
+    // Loop finishes its current step, releases the pins and returns
+    for (int waited_ms = 0; self->active; waited_ms += 10) {
+        if (waited_ms >= EMERGENCY_STOP_TIMEOUT_MS) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
+
+esp_err_t emergency_alarm_press(uint8_t instance, bool pressed)
+{
+    if (instance >= CONFIG_EMERGENCY_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!instances[instance].status.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return input_bus_inject(instances[instance].config.button_pin, pressed);
+}
+
+esp_err_t emergency_alarm_get_status(uint8_t instance, emergency_status_t *status)
+{
+    if (instance >= CONFIG_EMERGENCY_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *status = instances[instance].status;
+    return ESP_OK;
+}
+
+void emergency_alarm_run(const emergency_config_t *config)
+{
+    if (!config_valid(config)) {
+        ESP_LOGE(TAG, "Invalid emergency alarm config");
+        return;
+    }
+    emergency_instance_t *self = &instances[config->instance];
+    if (config != &self->config) {
+        self->config = *config;  // Called directly, not through emergency_alarm_start()
+        self->stop_requested = false;
+    }
+    config = &self->config;
+    self->task = xTaskGetCurrentTaskHandle();
+    self->active = true;
+
+    const gpio_num_t button_pin = config->button_pin;
+    const gpio_num_t alarm_led = config->alarm_led_pin;
+    fast_boot_slot_t *retained = &retained_alarm[config->instance];
+    emergency_status_t *status = &self->status;
+
     /*
-     * GPIO SETUP - EMERGENCY PUSH BUTTON
+     * ALARM INDICATOR (output manager):
+     * ---------------------------------
+     * Output driving:
+     *  - Panel LED
+     *  - Tower light
+     *  - Small siren via driver
+     * Posted at ALARM priority: overrides any other module on the pin.
+     * A lamp already driven by fast-restore is left untouched.
+     */
+    if (panel_output_open(&self->lamp, alarm_led, PANEL_OUTPUT_PRIO_ALARM, "emergency") != ESP_OK) {
+        ESP_LOGE(TAG, "Alarm lamp GPIO %d not available", alarm_led);
+        self->active = false;
+        return;
+    }
+
+    /*
+     * EMERGENCY PUSH BUTTON (input bus):
      * ----------------------------------
-     * Input with internal PULL‑UP:
+     * Input with internal PULL‑UP, configured by the bus on first use:
      *  - Normal (not pressed)  → logic HIGH (1)
      *  - Pressed (to GND)      → logic LOW  (0)
      * 
@@ -32,129 +256,179 @@ void emergency_alarm_run(void)
      *  - Fewer external resistors
      *  - Better noise immunity
      */
-
-    gpio_reset_pin(BUTTON_PIN);
-    gpio_set_direction(BUTTON_PIN, GPIO_MODE_INPUT);
-    gpio_set_pull_mode(BUTTON_PIN, GPIO_PULLUP_ONLY);
-    
-    /*
-     * GPIO SETUP - ALARM INDICATOR
-     * -----------------------------
-     * Output driving:
-     *  - Panel LED
-     *  - Tower light
-     *  - Small siren via driver
-     */
-
-    gpio_reset_pin(ALARM_LED);
-    gpio_set_direction(ALARM_LED, GPIO_MODE_OUTPUT);
+    if (input_bus_subscribe(&self->sub, button_pin, config->debounce_ms, "emergency") != ESP_OK) {
+        ESP_LOGE(TAG, "E-STOP button GPIO %d not available", button_pin);
+        panel_output_close(&self->lamp);
+        self->active = false;
+        return;
+    }
     
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "Industrial Emergency Alarm Module Ready");
-    ESP_LOGI(TAG, "Button: GPIO %d (E-STOP simulation)", BUTTON_PIN);
-    ESP_LOGI(TAG, "Alarm LED: GPIO %d (tower lamp / siren)", ALARM_LED);
+    ESP_LOGI(TAG, "Industrial Emergency Alarm Module Ready (instance %d)", config->instance);
+    ESP_LOGI(TAG, "Button: GPIO %d (E-STOP simulation)", button_pin);
+    ESP_LOGI(TAG, "Alarm LED: GPIO %d (tower lamp / siren)", alarm_led);
     ESP_LOGI(TAG, "Press button to TOGGLE emergency alarm state");
     ESP_LOGI(TAG, "========================================");
+
+    // Button events wake this loop (the bus task wakes the chip from light sleep)
+    panel_pm_wake_counter_t wakes = PANEL_PM_WAKE_COUNTER("emergency");
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "emergency");
+
+    // Lamp latch runs inside the button interrupt
+    estop_latch_t *latch = &self->latch;
+    latch->button_pin = button_pin;
+    latch->lamp = &self->lamp;
+    latch->armed = false;
+    latch->tripped = false;
+    if (input_bus_set_isr_hook(button_pin, estop_latch_isr, latch) != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d already has an interrupt latch - lamp follows the task only", button_pin);
+    }
+
+    fast_boot_mark("emergency loop ready");
+    fast_boot_report();
     
     /*
      * STATE VARIABLES:
      * ----------------
-     * alarm_active:
-     *  - false → System in normal condition, alarm off
-     *  - true  → Emergency state active, alarm blinking fast
+     * logic (estop_logic.h):
+     *  - Toggle decision, no GPIO inside (debounce 0: the bus did it)
+     *  - alarm_active false → normal condition, alarm off
+     *  - alarm_active true  → emergency state active, alarm blinking fast
+     *  - ONE toggle per press, even while the button is held
      * 
-     * last_button_state:
-     *  - Used to detect the "edge" (transition) from not‑pressed → pressed
-     *  - Avoids multiple triggers while button is held
+     * status (read by the console "status" command):
+     *  - alarm_count: how many times emergency was activated
+     *  - isr_latches / glitches / busy_max_us: E-STOP latch health
      * 
-     * alarm_count:
-     *  - How many times emergency was activated
-     *  - Useful for logging and analysis in real plants
+     * alarm_active starts from the retained value after a warm reset.
      */
 
-    bool alarm_active = false;
-    int last_button_state = 1;  // Start HIGH due to pull‑up (button released)
-    int alarm_count = 0;
+    uint32_t retained_value = 0;
+    bool alarm_active = fast_boot_slot_load(retained, &retained_value) && retained_value;
+    estop_logic_t logic;
+    estop_logic_init(&logic, 0, alarm_active);
+    bool pressed = false;  // Debounced level, from the last PRESS / RELEASE
+    *status = (emergency_status_t){ .running = true, .alarm_active = alarm_active };
+
+    /*
+     * ALARM VISUAL PATTERN:
+     * ---------------------
+     * When alarm_active == true:
+     *  - Blink LED fast (blink_ms ON / blink_ms OFF, default 100ms)
+     *  - Represents high‑priority emergency in industrial panels
+     * 
+     * When alarm_active == false:
+     *  - Lamp released (OFF, or whatever a lower-priority module shows)
+     * 
+     * Posted only when the alarm state changes. The blink runs in LEDC
+     * hardware or the output manager task, never in this loop.
+     */
+    if(alarm_active) {
+        panel_output_blink(&self->lamp, config->blink_ms);
+    }
     
-    while(1) {
+    while(!self->stop_requested) {
+        panel_pm_wake_count(&wakes);
+        task_monitor_loop_begin(&loop_stats);
+        int64_t busy_start_us = esp_timer_get_time();
+
         /*
-         * READ BUTTON STATE:
-         * ------------------
-         * gpio_get_level():
-         *  - Returns 1 → input HIGH
-         *  - Returns 0 → input LOW
-         * 
-         * With pull‑up wiring:
-         *  - 1 → Button NOT pressed (normal)
-         *  - 0 → Button PRESSED (emergency)
+         * READ BUTTON EVENT (one per iteration):
+         * --------------------------------------
+         * The bus has already debounced the pin:
+         *  - PRESS   → LOW for debounce_ms (or a virtual press from the console)
+         *  - RELEASE → back HIGH
+         *  - GLITCH  → a LOW that did not last (contact bounce / noise)
          */
-        int current_state = gpio_get_level(BUTTON_PIN);
-        
+        input_event_t input;
+        bool have_input = input_bus_receive(&self->sub, &input);
+        bool level_event = have_input && input.type != INPUT_EVENT_GLITCH;
+        if(level_event) {
+            pressed = (input.type == INPUT_EVENT_PRESS);
+        }
+
         /*
-         * EDGE DETECTION (HIGH → LOW):
-         * ----------------------------
-         * Detect only the transition from:
-         *  - last = 1 (released)
-         *  - now  = 0 (just pressed)
-         * 
-         * This ensures ONE event per press, even if loop runs very fast.
+         * TOGGLE:
+         * -------
+         * The accepted press toggles the alarm:
+         *  - If alarm OFF → turn ON (enter emergency state)
+         *  - If alarm ON  → turn OFF (acknowledge/reset)
          */
-        if(last_button_state == 1 && current_state == 0) {
-            
-            /*
-             * SOFTWARE DEBOUNCE STEP:
-             * -----------------------
-             * 1. Detected possible press
-             * 2. Wait DEBOUNCE_DELAY ms for contacts to settle
-             * 3. Read again to confirm it is a real press
-             */
-            vTaskDelay(DEBOUNCE_DELAY / portTICK_PERIOD_MS);
-            current_state = gpio_get_level(BUTTON_PIN);
-            
-            if(current_state == 0) {  // Still LOW → confirmed valid press
-                /*
-                 * TOGGLE EMERGENCY STATE:
-                 * -----------------------
-                 * alarm_active = !alarm_active;
-                 *  - If alarm OFF → turn ON (enter emergency state)
-                 *  - If alarm ON  → turn OFF (acknowledge/reset)
-                 */
-                alarm_active = !alarm_active;
-                alarm_count++;
-                
-                if(alarm_active) {
-                    ESP_LOGE(TAG, "----------------------------------------");
-                    ESP_LOGE(TAG, "!!! EMERGENCY ALARM TRIGGERED #%d !!!", alarm_count);
-                    ESP_LOGE(TAG, "Status: CRITICAL");
-                    ESP_LOGE(TAG, "Action: Stop machine / alert operator");
-                    ESP_LOGE(TAG, "----------------------------------------");
-                } else {
-                    ESP_LOGI(TAG, "Emergency alarm reset - System back to NORMAL");
-                }
+        estop_event_t event = level_event ? estop_logic_feed(&logic, pressed, input.time_ms) : ESTOP_EVENT_NONE;
+
+        // Lamp already switched ON by the interrupt? Judged by the bus verdict on that LOW
+        bool tripped = have_input && input.type != INPUT_EVENT_RELEASE && latch->tripped;
+        if(tripped) {
+            latch->tripped = false;
+            status->isr_latches++;
+        }
+
+        if(event != ESTOP_EVENT_NONE) {
+            alarm_active = logic.alarm_active;
+            status->alarm_active = alarm_active;
+            fast_boot_slot_store(retained, alarm_active);
+        }
+
+        if(event == ESTOP_EVENT_ALARM_ON) {
+            status->alarm_count++;
+            event_log_add("emergency", "alarm ON", status->alarm_count);
+            ESP_LOGE(TAG, "----------------------------------------");
+            panel_output_blink(&self->lamp, config->blink_ms);
+            ESP_LOGE(TAG, "!!! EMERGENCY ALARM TRIGGERED #%lu !!!", (unsigned long)status->alarm_count);
+            ESP_LOGE(TAG, "Status: CRITICAL");
+            ESP_LOGE(TAG, "Action: Stop machine / alert operator");
+            if(tripped) {
+                ESP_LOGE(TAG, "Lamp latched in ISR: %" PRId64 " us, worst busy gap %" PRId64 " us (bound %d us)",
+                         latch->lamp_us - latch->isr_us, status->busy_max_us, CONFIG_EMERGENCY_REACTION_BOUND_US);
             }
+            ESP_LOGE(TAG, "----------------------------------------");
+        } else if(event == ESTOP_EVENT_ALARM_OFF) {
+            panel_output_release(&self->lamp);
+            event_log_add("emergency", "alarm reset", status->alarm_count);
+            ESP_LOGI(TAG, "Emergency alarm reset - System back to NORMAL");
+        } else if(tripped) {
+            status->glitches++;
+            panel_output_release(&self->lamp);  // Latch disarmed until the loop ends: no race with the ISR
+            event_log_add("emergency", "glitch", status->glitches);
+            // Interrupt saw a LOW that did not last: contact bounce / noise
+            ESP_LOGW(TAG, "E-STOP glitch shorter than %lu ms ignored - lamp released",
+                     (unsigned long)config->debounce_ms);
         }
-        
+
         /*
-         * ALARM VISUAL PATTERN:
-         * ---------------------
-         * When alarm_active == true:
-         *  - Blink LED fast (100ms ON / 100ms OFF)
-         *  - Represents high‑priority emergency in industrial panels
-         * 
-         * When alarm_active == false:
-         *  - LED OFF (no active alarm)
+         * SLEEP UNTIL SOMETHING HAPPENS:
+         * ------------------------------
+         *  - Only a button event (or a stop request) can wake us
+         *  - More events queued → no sleep at all
          */
-        if(alarm_active) {
-            gpio_set_level(ALARM_LED, 1);
-            vTaskDelay(100 / portTICK_PERIOD_MS);
-            gpio_set_level(ALARM_LED, 0);
-            vTaskDelay(100 / portTICK_PERIOD_MS);
-        } else {
-            gpio_set_level(ALARM_LED, 0);
-            vTaskDelay(50 / portTICK_PERIOD_MS);  // Small delay to reduce CPU usage
+
+        // Only a released button with the alarm OFF may be latched by the ISR
+        latch->armed = !alarm_active && !pressed;
+        int64_t busy_us = esp_timer_get_time() - busy_start_us;
+        if(latch->armed && busy_us > status->busy_max_us) {
+            status->busy_max_us = busy_us;
+            if(busy_us > CONFIG_EMERGENCY_REACTION_BOUND_US) {
+                ESP_LOGW(TAG, "Loop busy %" PRId64 " us - E-STOP reaction bound (%d us) exceeded",
+                         busy_us, CONFIG_EMERGENCY_REACTION_BOUND_US);
+            }
         }
-        
-        // Save current state to detect edge in next loop
-        last_button_state = current_state;
+        task_monitor_loop_end(&loop_stats);
+        input_bus_wait(&self->sub, PANEL_PM_WAIT_FOREVER);
     }
+    latch->armed = false;
+
+    /*
+     * STOPPED (console "stop emergency"):
+     *  - Leave the input bus and output manager, release monitor entry
+     *  - Lamp request withdrawn; the retained alarm flag is kept for the next start
+     */
+    input_bus_set_isr_hook(button_pin, NULL, NULL);
+    input_bus_unsubscribe(&self->sub);
+    panel_output_close(&self->lamp);
+    task_monitor_loop_unregister(&loop_stats);
+    event_log_add("emergency", "stopped", config->instance);
+    ESP_LOGW(TAG, "Emergency alarm monitoring STOPPED (instance %d)", config->instance);
+    status->running = false;
+    self->active = false;
 }
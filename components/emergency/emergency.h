@@ -1,7 +1,10 @@
 #ifndef EMERGENCY_H
 #define EMERGENCY_H
 
+#include <stdbool.h>
 #include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -18,15 +21,81 @@
  * - How fast blinking indicates critical condition
  */
 
-#define BUTTON_PIN  GPIO_NUM_18   // Emergency push button (E‑STOP)
-#define ALARM_LED   GPIO_NUM_2    // Alarm indicator (tower light / siren)
+/*
+ * PER-INSTANCE CONFIGURATION:
+ * ---------------------------
+ * Pins and timing are no longer fixed #defines. Each E-STOP station
+ * gets its own config, so one firmware can watch several buttons.
+ * Defaults come from menuconfig → "Emergency Alarm".
+ */
+typedef struct {
+    gpio_num_t button_pin;     // Emergency push button (E‑STOP), active LOW
+    gpio_num_t alarm_led_pin;  // Alarm indicator (tower light / siren)
+    uint32_t debounce_ms;      // Contact bounce filter
+    uint32_t blink_ms;         // Alarm lamp ON / OFF time
+    uint8_t instance;          // 0 .. CONFIG_EMERGENCY_MAX_INSTANCES-1 (retained state slot)
+} emergency_config_t;
+
+#define EMERGENCY_CONFIG_DEFAULT() {                    \
+    .button_pin = CONFIG_EMERGENCY_BUTTON_GPIO,         \
+    .alarm_led_pin = CONFIG_EMERGENCY_ALARM_LED_GPIO,   \
+    .debounce_ms = CONFIG_EMERGENCY_DEBOUNCE_MS,        \
+    .blink_ms = CONFIG_EMERGENCY_BLINK_MS,              \
+    .instance = 0,                                      \
+}
+
+/*
+ * RUNTIME STATUS (console "status" command):
+ */
+typedef struct {
+    bool running;              // Loop is active
+    bool alarm_active;         // Alarm lamp blinking
+    uint32_t alarm_count;      // Alarm activations since start
+    uint32_t isr_latches;      // Lamp switched ON by the button interrupt
+    uint32_t glitches;         // Interrupt trips not confirmed by debounce
+    int64_t busy_max_us;       // Worst loop iteration while the E-STOP latch is armed
+} emergency_status_t;
 
 /*
- * @brief Run the emergency alarm task (blocking)
+ * @brief Re-apply the alarm lamp state kept across a soft reset
  * 
- * Call this from app_main() to start monitoring the emergency button.
- * In a real project, this would normally run in its own FreeRTOS task.
+ * Call this as the FIRST thing in app_main(), before any logging.
+ * Does nothing after a cold power-on.
  */
-void emergency_alarm_run(void);
+void emergency_alarm_fast_restore(const emergency_config_t *config);
+
+/*
+ * @brief Run the emergency alarm loop (blocking)
+ * 
+ * Runs in the calling task until emergency_alarm_stop() is called
+ * for the same instance.
+ */
+void emergency_alarm_run(const emergency_config_t *config);
+
+/*
+ * @brief Run the emergency alarm loop in its own FreeRTOS task
+ * 
+ * The config is copied, the caller may reuse it.
+ * @return ESP_ERR_INVALID_ARG for a bad instance number or pin,
+ *         ESP_ERR_INVALID_STATE if the instance is already running
+ */
+esp_err_t emergency_alarm_start(const emergency_config_t *config);
+
+/*
+ * @brief Stop a running instance and release its pins
+ * 
+ * Blocks until the loop has exited (ESP_ERR_TIMEOUT after 1 s).
+ */
+esp_err_t emergency_alarm_stop(uint8_t instance);
+
+/*
+ * @brief Virtual E-STOP press / release (commissioning, tests)
+ * 
+ * Overrides the physical input while pressed == true.
+ */
+esp_err_t emergency_alarm_press(uint8_t instance, bool pressed);
+
+// Copy the runtime status of an instance
+esp_err_t emergency_alarm_get_status(uint8_t instance, emergency_status_t *status);
 
 #endif
@@ -0,0 +1,22 @@
+#include "estop_logic.h"
+
+void estop_logic_init(estop_logic_t *logic, uint32_t debounce_ms, bool alarm_active)
+{
+    debounce_init(&logic->debounce, debounce_ms, false);
+    logic->alarm_active = alarm_active;
+    logic->alarm_count = 0;
+}
+
+estop_event_t estop_logic_feed(estop_logic_t *logic, bool raw_pressed, uint32_t now_ms)
+{
+    // Only the debounced press edge counts, release does nothing
+    if (!debounce_feed(&logic->debounce, raw_pressed, now_ms) || !logic->debounce.stable_pressed) {
+        return ESTOP_EVENT_NONE;
+    }
+    logic->alarm_active = !logic->alarm_active;
+    if (!logic->alarm_active) {
+        return ESTOP_EVENT_ALARM_OFF;
+    }
+    logic->alarm_count++;
+    return ESTOP_EVENT_ALARM_ON;
+}
@@ -0,0 +1,52 @@
+#ifndef ESTOP_LOGIC_H
+#define ESTOP_LOGIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "debounce.h"
+
+/*
+ * E-STOP Toggle Logic
+ * -------------------
+ * The decision part of the emergency alarm, without GPIO, lamp or
+ * FreeRTOS: every debounced press toggles the alarm, exactly once,
+ * no matter how long it is held or how much the contacts bounce.
+ * 
+ * emergency_alarm_run() drives it from the real button; the soak
+ * harness (panel_soak) drives it with millions of generated presses.
+ */
+
+typedef enum {
+    ESTOP_EVENT_NONE = 0,
+    ESTOP_EVENT_ALARM_ON,     // Press while alarm was off
+    ESTOP_EVENT_ALARM_OFF,    // Press while alarm was on (acknowledge / reset)
+} estop_event_t;
+
+typedef struct {
+    debounce_t debounce;
+    bool alarm_active;
+    uint32_t alarm_count;     // ALARM_ON events since init
+} estop_logic_t;
+
+void estop_logic_init(estop_logic_t *logic, uint32_t debounce_ms, bool alarm_active);
+
+/*
+ * @brief Feed the raw button level (true = pressed / LOW)
+ * 
+ * Call on every level change and when estop_logic_ms_to_deadline() passed.
+ */
+estop_event_t estop_logic_feed(estop_logic_t *logic, bool raw_pressed, uint32_t now_ms);
+
+// Milliseconds until the next feed is needed (DEBOUNCE_NO_DEADLINE if idle)
+static inline uint32_t estop_logic_ms_to_deadline(const estop_logic_t *logic, uint32_t now_ms)
+{
+    return debounce_ms_to_deadline(&logic->debounce, now_ms);
+}
+
+// True while a level change is still being debounced
+static inline bool estop_logic_settling(const estop_logic_t *logic)
+{
+    return logic->debounce.pending;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <string.h>
+#include "event_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_console.h"
+
+static event_log_entry_t entries[CONFIG_EVENT_LOG_ENTRIES];
+static uint32_t total = 0;   // Next write position = total % size
+static portMUX_TYPE log_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void event_log_add(const char *source, const char *what, int32_t value)
+{
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    taskENTER_CRITICAL(&log_lock);
+    event_log_entry_t *e = &entries[total % CONFIG_EVENT_LOG_ENTRIES];
+    e->time_ms = now_ms;
+    e->source = source;
+    e->what = what;
+    e->value = value;
+    total++;
+    taskEXIT_CRITICAL(&log_lock);
+}
+
+void event_log_print(void)
+{
+    uint32_t end = event_log_total();
+    uint32_t start = end > CONFIG_EVENT_LOG_ENTRIES ? end - CONFIG_EVENT_LOG_ENTRIES : 0;
+
+    for (uint32_t i = start; i < end; i++) {
+        // Copy first: a writer may be overwriting the oldest entry
+        event_log_entry_t e;
+        taskENTER_CRITICAL(&log_lock);
+        e = entries[i % CONFIG_EVENT_LOG_ENTRIES];
+        bool overwritten = total - i > CONFIG_EVENT_LOG_ENTRIES;
+        taskEXIT_CRITICAL(&log_lock);
+        if (!overwritten) {
+            printf("%5lu %10lu ms  %-14s %-20s %ld\n", (unsigned long)i, (unsigned long)e.time_ms,
+                   e.source, e.what, (long)e.value);
+        }
+    }
+    printf("%lu event(s) since boot, last %d kept\n", (unsigned long)end, CONFIG_EVENT_LOG_ENTRIES);
+}
+
+void event_log_clear(void)
+{
+    taskENTER_CRITICAL(&log_lock);
+    total = 0;
+    memset(entries, 0, sizeof(entries));
+    taskEXIT_CRITICAL(&log_lock);
+}
+
+uint32_t event_log_total(void)
+{
+    return __atomic_load_n(&total, __ATOMIC_RELAXED);
+}
+
+static int cmd_events(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+        event_log_clear();
+        printf("Event log cleared\n");
+        return 0;
+    }
+    event_log_print();
+    return 0;
+}
+
+esp_err_t event_log_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "events",
+        .help = "Show the panel event log. 'events clear' empties it",
+        .hint = "[clear]",
+        .func = &cmd_events,
+    };
+    return esp_console_cmd_register(&cmd);
+}
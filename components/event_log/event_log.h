@@ -0,0 +1,41 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * Panel Event Log
+ * ---------------
+ * Small RAM ring buffer of "what happened when" - alarm on/off,
+ * mode changes, power sequences, injected presses.
+ *  - Fixed size (CONFIG_EVENT_LOG_ENTRIES), oldest entry overwritten
+ *  - Source and text must be string literals (only pointers are kept)
+ *  - Safe to call from any task (short critical section)
+ *
+ * Read back with event_log_print() or the console command "events".
+ */
+
+typedef struct {
+    uint32_t time_ms;     // Since boot
+    const char *source;   // e.g. "emergency"
+    const char *what;     // e.g. "alarm on"
+    int32_t value;        // Counter / mode / state, meaning depends on event
+} event_log_entry_t;
+
+// Add an event (source / what: string literals)
+void event_log_add(const char *source, const char *what, int32_t value);
+
+// Print all kept events, oldest first
+void event_log_print(void);
+
+// Forget all events
+void event_log_clear(void);
+
+// Total events since boot (including overwritten ones)
+uint32_t event_log_total(void);
+
+// Add the "events" command ("events clear" empties the log)
+esp_err_t event_log_register_console(void);
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include "fast_boot.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "FAST_BOOT"
+
+#define FAST_BOOT_MAGIC     0x46425354  // "FBST"
+#define FAST_BOOT_MAX_MARKS 8
+
+typedef struct {
+    const char *label;
+    int64_t time_us;
+} fast_boot_mark_t;
+
+static fast_boot_mark_t marks[FAST_BOOT_MAX_MARKS];
+static int mark_count = 0;
+
+bool fast_boot_is_warm_start(void)
+{
+    /*
+     * RESET REASONS:
+     * --------------
+     * Power-on → RTC memory content is random, nothing to restore.
+     * Software reset, panic, watchdog, brownout, deep sleep wake
+     *          → RTC memory was kept, previous state is still there.
+     * Linux host build → always cold.
+     */
+#if CONFIG_IDF_TARGET_LINUX
+    return false;
+#else
+    esp_reset_reason_t reason = esp_reset_reason();
+    return reason != ESP_RST_POWERON && reason != ESP_RST_UNKNOWN;
+#endif
+}
+
+bool fast_boot_slot_load(const fast_boot_slot_t *slot, uint32_t *value)
+{
+    if (!fast_boot_is_warm_start()) {
+        return false;
+    }
+    if (slot->magic != FAST_BOOT_MAGIC || slot->check != ~slot->value) {
+        return false;
+    }
+    *value = slot->value;
+    return true;
+}
+
+void fast_boot_slot_store(fast_boot_slot_t *slot, uint32_t value)
+{
+    slot->value = value;
+    slot->check = ~value;
+    slot->magic = FAST_BOOT_MAGIC;
+}
+
+void fast_boot_mark(const char *label)
+{
+    if (mark_count < FAST_BOOT_MAX_MARKS) {
+        marks[mark_count].label = label;
+        marks[mark_count].time_us = esp_timer_get_time();
+        mark_count++;
+    }
+}
+
+void fast_boot_report(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    ESP_LOGI(TAG, "Start-up timing (host build, cold start):");
+#else
+    ESP_LOGI(TAG, "Start-up timing (reset reason %d, %s start):",
+             esp_reset_reason(), fast_boot_is_warm_start() ? "warm" : "cold");
+#endif
+    for (int i = 0; i < mark_count; i++) {
+        int64_t delta = (i > 0) ? marks[i].time_us - marks[i - 1].time_us : 0;
+        ESP_LOGI(TAG, "  %-28s %8" PRId64 " us  (+%" PRId64 " us)",
+                 marks[i].label, marks[i].time_us, delta);
+    }
+}
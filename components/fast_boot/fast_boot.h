@@ -0,0 +1,61 @@
+#ifndef FAST_BOOT_H
+#define FAST_BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_attr.h"
+#include "sdkconfig.h"
+
+/*
+ * Fast-Boot State Retention
+ * -------------------------
+ * After a soft reset, watchdog reset or brownout the controller should
+ * NOT wait for the whole application start-up before showing the
+ * operator the machine state again. A lamp that was ON must come back
+ * ON within the first milliseconds of app_main().
+ *
+ * Each module keeps its own small "slot" in RTC memory that is NOT
+ * cleared on reset (RTC_NOINIT). A magic word and a check word protect
+ * against the random content found after a cold power-on.
+ *
+ * Timing marks let us print how early outputs were restored compared
+ * to the moment the normal *_run() loop was ready.
+ */
+
+// Put this in front of a fast_boot_slot_t so it survives soft resets
+#if CONFIG_IDF_TARGET_LINUX
+#define FAST_BOOT_SLOT_ATTR            // Host build: no RTC memory, every start is cold
+#else
+#define FAST_BOOT_SLOT_ATTR  RTC_NOINIT_ATTR
+#endif
+
+// One retained value (mode, power state, alarm flag ...)
+typedef struct {
+    uint32_t magic;   // FAST_BOOT magic when slot was written
+    uint32_t value;   // Retained value
+    uint32_t check;   // Inverted copy of value (detects corruption)
+} fast_boot_slot_t;
+
+/*
+ * @brief True if the last reset kept RTC memory (not a cold power-on)
+ */
+bool fast_boot_is_warm_start(void);
+
+/*
+ * @brief Read a retained value
+ *
+ * @return true and fills *value if the slot holds a valid value
+ *         and the last reset was a warm start
+ */
+bool fast_boot_slot_load(const fast_boot_slot_t *slot, uint32_t *value);
+
+// Store a value so it survives the next soft reset / brownout
+void fast_boot_slot_store(fast_boot_slot_t *slot, uint32_t value);
+
+// Record a start-up timestamp (label must be a string literal)
+void fast_boot_mark(const char *label);
+
+// Log all start-up marks with their time since boot
+void fast_boot_report(void);
+
+#endif
@@ -0,0 +1,36 @@
+#include "debounce.h"
+
+void debounce_init(debounce_t *d, uint32_t debounce_ms, bool pressed)
+{
+    d->debounce_ms = debounce_ms;
+    d->stable_pressed = pressed;
+    d->pending = false;
+    d->change_ms = 0;
+}
+
+bool debounce_feed(debounce_t *d, bool raw_pressed, uint32_t now_ms)
+{
+    if (raw_pressed == d->stable_pressed) {
+        d->pending = false;  // Bounced back: start over on the next change
+        return false;
+    }
+    if (!d->pending) {
+        d->pending = true;
+        d->change_ms = now_ms;
+    }
+    if (now_ms - d->change_ms < d->debounce_ms) {
+        return false;
+    }
+    d->pending = false;
+    d->stable_pressed = raw_pressed;
+    return true;
+}
+
+uint32_t debounce_ms_to_deadline(const debounce_t *d, uint32_t now_ms)
+{
+    if (!d->pending) {
+        return DEBOUNCE_NO_DEADLINE;
+    }
+    uint32_t elapsed_ms = now_ms - d->change_ms;
+    return elapsed_ms >= d->debounce_ms ? 0 : d->debounce_ms - elapsed_ms;
+}
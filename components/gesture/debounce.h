@@ -0,0 +1,45 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Push-Button Debounce
+ * --------------------
+ * A raw level is accepted only after it stayed unchanged for
+ * debounce_ms. Contact bounce and short noise pulses never reach the
+ * logic behind it.
+ * 
+ * Like gesture.h: no GPIO, no sleeping. The caller reads the pin,
+ * feeds the level with a millisecond timestamp, and feeds again when
+ * debounce_ms_to_deadline() has passed.
+ */
+
+#define DEBOUNCE_NO_DEADLINE  UINT32_MAX
+
+typedef struct {
+    uint32_t debounce_ms;
+    bool stable_pressed;    // Debounced level
+    bool pending;           // Raw level differs from the stable level
+    uint32_t change_ms;     // When that difference was first seen
+} debounce_t;
+
+void debounce_init(debounce_t *d, uint32_t debounce_ms, bool pressed);
+
+/*
+ * @brief Feed the raw level
+ * 
+ * @return true if the debounced level changed (now in d->stable_pressed);
+ *         d->change_ms is then the time of the raw edge
+ */
+bool debounce_feed(debounce_t *d, bool raw_pressed, uint32_t now_ms);
+
+/*
+ * @brief Milliseconds until the pending level is accepted
+ * 
+ * @return DEBOUNCE_NO_DEADLINE if the raw level equals the stable level
+ */
+uint32_t debounce_ms_to_deadline(const debounce_t *d, uint32_t now_ms);
+
+#endif
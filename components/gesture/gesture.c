@@ -0,0 +1,132 @@
+#include <string.h>
+#include "gesture.h"
+
+/*
+ * STATE MACHINE (per button):
+ * ---------------------------
+ * IDLE      --press-->            HELD      (deadline = long press time)
+ * HELD      --release-->          COUNTING  (clicks++, deadline = click window)
+ * COUNTING  --press in window-->  HELD      (same click sequence continues)
+ * COUNTING  --window closed-->    IDLE      → CLICK(clicks)
+ * HELD      --long press time-->  LONG      → LONG_PRESS (pending clicks dropped)
+ * LONG      --repeat interval-->  LONG      → HOLD_REPEAT
+ * LONG      --release-->          IDLE      → LONG_RELEASE
+ * 
+ * Time compares use signed differences so the 32-bit ms counter
+ * may wrap around (after ~49 days) without breaking anything.
+ */
+
+static bool time_reached(uint32_t now_ms, uint32_t deadline_ms)
+{
+    return (int32_t)(now_ms - deadline_ms) >= 0;
+}
+
+static void arm(gesture_t *g, uint32_t deadline_ms)
+{
+    g->deadline_ms = deadline_ms;
+    g->deadline_armed = true;
+}
+
+static void report(gesture_event_t *event, gesture_type_t type, const gesture_t *g, uint32_t now_ms)
+{
+    event->type = type;
+    event->clicks = g->clicks;
+    event->repeats = g->repeats;
+    event->time_ms = now_ms;
+}
+
+void gesture_init(gesture_t *g, const gesture_config_t *cfg)
+{
+    memset(g, 0, sizeof(*g));
+    g->cfg = *cfg;
+    if (g->cfg.max_clicks == 0) {
+        g->cfg.max_clicks = 1;
+    }
+}
+
+bool gesture_feed(gesture_t *g, bool pressed, uint32_t now_ms, gesture_event_t *event)
+{
+    if (pressed == g->pressed) {
+        return false;  // Not an edge
+    }
+    g->pressed = pressed;
+
+    if (pressed) {
+        // Click window closed before anyone polled: finish that sequence first
+        bool flushed = false;
+        if (g->clicks > 0 && g->deadline_armed && time_reached(now_ms, g->deadline_ms)) {
+            report(event, GESTURE_CLICK, g, g->deadline_ms);
+            g->clicks = 0;
+            flushed = true;
+        }
+        g->long_fired = false;
+        g->repeats = 0;
+        arm(g, now_ms + g->cfg.long_press_ms);
+        return flushed;
+    }
+
+    // Released
+    if (g->long_fired) {
+        report(event, GESTURE_LONG_RELEASE, g, now_ms);
+        g->clicks = 0;
+        g->deadline_armed = false;
+        return true;
+    }
+
+    g->clicks++;
+    if (g->clicks >= g->cfg.max_clicks) {
+        // No higher count possible - do not make the operator wait
+        report(event, GESTURE_CLICK, g, now_ms);
+        g->clicks = 0;
+        g->deadline_armed = false;
+        return true;
+    }
+    arm(g, now_ms + g->cfg.click_window_ms);
+    return false;
+}
+
+bool gesture_poll(gesture_t *g, uint32_t now_ms, gesture_event_t *event)
+{
+    if (!g->deadline_armed || !time_reached(now_ms, g->deadline_ms)) {
+        return false;
+    }
+
+    if (g->pressed && !g->long_fired) {
+        g->long_fired = true;
+        g->clicks = 0;
+        report(event, GESTURE_LONG_PRESS, g, now_ms);
+        if (g->cfg.repeat_interval_ms) {
+            arm(g, g->deadline_ms + g->cfg.repeat_interval_ms);
+        } else {
+            g->deadline_armed = false;
+        }
+        return true;
+    }
+
+    if (g->pressed) {
+        g->repeats++;
+        report(event, GESTURE_HOLD_REPEAT, g, now_ms);
+        arm(g, g->deadline_ms + g->cfg.repeat_interval_ms);
+        return true;
+    }
+
+    // Released and click window closed
+    g->deadline_armed = false;
+    if (g->clicks == 0) {
+        return false;
+    }
+    report(event, GESTURE_CLICK, g, now_ms);
+    g->clicks = 0;
+    return true;
+}
+
+uint32_t gesture_ms_to_deadline(const gesture_t *g, uint32_t now_ms)
+{
+    if (!g->deadline_armed) {
+        return GESTURE_NO_DEADLINE;
+    }
+    if (time_reached(now_ms, g->deadline_ms)) {
+        return 0;
+    }
+    return g->deadline_ms - now_ms;
+}
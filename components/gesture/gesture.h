@@ -0,0 +1,91 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Push-Button Gesture Recognizer
+ * ------------------------------
+ * Turns debounced button edges (pressed / released + timestamp) into
+ * operator gestures:
+ *  - Single / double / triple click (N-way, up to max_clicks)
+ *  - Long press (fires once while the button is still held)
+ *  - Press-and-hold repeat (fires every repeat_interval_ms after long press)
+ *  - Release after a long press
+ * 
+ * Nothing in here blocks, sleeps or touches GPIO:
+ *  - gesture_feed()  → call on every debounced edge
+ *  - gesture_poll()  → call when the deadline returned by
+ *                      gesture_ms_to_deadline() has passed
+ * Timestamps are plain milliseconds, so the same code runs on the
+ * ESP32 (xTaskGetTickCount) and on a PC with recorded event streams.
+ */
+
+#define GESTURE_NO_DEADLINE  UINT32_MAX
+
+typedef enum {
+    GESTURE_NONE = 0,
+    GESTURE_CLICK,          // Button clicked 'clicks' times in a row
+    GESTURE_LONG_PRESS,     // Held for long_press_ms (button still down)
+    GESTURE_HOLD_REPEAT,    // Still held, repeat number 'repeats'
+    GESTURE_LONG_RELEASE    // Released after a long press
+} gesture_type_t;
+
+typedef struct {
+    gesture_type_t type;
+    uint8_t clicks;         // GESTURE_CLICK: number of clicks (1..max_clicks)
+    uint16_t repeats;       // HOLD_REPEAT / LONG_RELEASE: repeats so far
+    uint32_t time_ms;       // When the gesture was recognised
+} gesture_event_t;
+
+typedef struct {
+    uint32_t click_window_ms;     // Max gap release → next press for multi-click
+    uint32_t long_press_ms;       // Hold time for a long press
+    uint32_t repeat_interval_ms;  // Hold-repeat period, 0 = no repeat
+    uint8_t max_clicks;           // Reaching this count reports at once
+} gesture_config_t;
+
+#define GESTURE_CONFIG_DEFAULT() {      \
+    .click_window_ms = 400,             \
+    .long_press_ms = 1000,              \
+    .repeat_interval_ms = 0,            \
+    .max_clicks = 3,                    \
+}
+
+// Recognizer state (one per button, no heap)
+typedef struct {
+    gesture_config_t cfg;
+    bool pressed;           // Current debounced level
+    bool long_fired;        // Long press already reported for this hold
+    uint8_t clicks;         // Clicks counted in the current sequence
+    uint16_t repeats;       // Hold-repeat count for the current hold
+    uint32_t deadline_ms;   // Next time gesture_poll() has work to do
+    bool deadline_armed;
+} gesture_t;
+
+void gesture_init(gesture_t *g, const gesture_config_t *cfg);
+
+/*
+ * @brief Feed one debounced edge
+ * 
+ * @return true if the edge completed a gesture (stored in *event)
+ */
+bool gesture_feed(gesture_t *g, bool pressed, uint32_t now_ms, gesture_event_t *event);
+
+/*
+ * @brief Handle time-outs (click window closed, long press, repeat)
+ * 
+ * Reports at most one gesture per call.
+ * @return true if a gesture was recognised (stored in *event)
+ */
+bool gesture_poll(gesture_t *g, uint32_t now_ms, gesture_event_t *event);
+
+/*
+ * @brief Milliseconds until gesture_poll() must be called again
+ * 
+ * @return 0 if already due, GESTURE_NO_DEADLINE if idle
+ */
+uint32_t gesture_ms_to_deadline(const gesture_t *g, uint32_t now_ms);
+
+#endif
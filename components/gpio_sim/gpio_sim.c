@@ -0,0 +1,229 @@
+#include <stdbool.h>
+#include "gpio_sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef struct {
+    gpio_mode_t mode;
+    bool pull_up;
+    int input_level;        // Driven by gpio_sim_set_input()
+    int output_level;       // Written by gpio_set_level()
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t handler;
+    void *handler_arg;
+} sim_pin_t;
+
+static sim_pin_t pins[GPIO_NUM_MAX];
+static bool isr_service_installed = false;
+static uint64_t last_set_mask = 0;
+static uint64_t last_clear_mask = 0;
+static uint32_t mask_writes = 0;
+static portMUX_TYPE sim_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool level_matches(gpio_int_type_t type, int level)
+{
+    return (type == GPIO_INTR_LOW_LEVEL && level == 0) ||
+           (type == GPIO_INTR_HIGH_LEVEL && level == 1);
+}
+
+static int read_level(const sim_pin_t *pin)
+{
+    if (pin->mode == GPIO_MODE_OUTPUT || pin->mode == GPIO_MODE_INPUT_OUTPUT) {
+        return pin->output_level;
+    }
+    return pin->input_level;
+}
+
+/*
+ * Level interrupt: fires once when enabled while the level matches.
+ * The handler normally disables the interrupt itself (like on the chip);
+ * handlers run outside the lock so they may call gpio_* again.
+ */
+static void check_interrupt(gpio_num_t gpio_num)
+{
+    gpio_isr_t handler = NULL;
+    void *arg = NULL;
+
+    taskENTER_CRITICAL(&sim_lock);
+    sim_pin_t *pin = &pins[gpio_num];
+    if (isr_service_installed && pin->intr_enabled && pin->handler &&
+        level_matches(pin->intr_type, read_level(pin))) {
+        handler = pin->handler;
+        arg = pin->handler_arg;
+    }
+    taskEXIT_CRITICAL(&sim_lock);
+
+    if (handler) {
+        handler(arg);
+    }
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&sim_lock);
+    sim_pin_t *pin = &pins[gpio_num];
+    gpio_isr_t handler = pin->handler;
+    void *arg = pin->handler_arg;
+    *pin = (sim_pin_t){ .mode = GPIO_MODE_INPUT, .pull_up = true, .input_level = 1,
+                        .handler = handler, .handler_arg = arg };
+    taskEXIT_CRITICAL(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num) ||
+        ((mode == GPIO_MODE_OUTPUT || mode == GPIO_MODE_INPUT_OUTPUT) && !GPIO_IS_VALID_OUTPUT_GPIO(gpio_num))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&sim_lock);
+    pins[gpio_num].pull_up = (pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN);
+    pins[gpio_num].input_level = pins[gpio_num].pull_up ? 1 : 0;  // Nothing connected yet
+    taskEXIT_CRITICAL(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].output_level = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return 0;
+    }
+    return read_level(&pins[gpio_num]);
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_enabled = true;
+    check_interrupt(gpio_num);  // Level already present: fires at once, like the chip
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    if (isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;  // Same answer as the driver
+    }
+    isr_service_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    taskENTER_CRITICAL(&sim_lock);
+    pins[gpio_num].handler = isr_handler;
+    pins[gpio_num].handler_arg = args;
+    taskEXIT_CRITICAL(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    return gpio_isr_handler_add(gpio_num, NULL, NULL);
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL) {
+        return ESP_ERR_INVALID_ARG;  // Chip: only level triggers can wake
+    }
+    return gpio_set_intr_type(gpio_num, intr_type);
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num)
+{
+    return gpio_set_intr_type(gpio_num, GPIO_INTR_DISABLE);
+}
+
+esp_err_t gpio_sim_set_input(gpio_num_t gpio_num, int level)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pins[gpio_num].input_level = level ? 1 : 0;
+    check_interrupt(gpio_num);
+    return ESP_OK;
+}
+
+int gpio_sim_get_output(gpio_num_t gpio_num)
+{
+    if (!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return 0;
+    }
+    return pins[gpio_num].output_level;
+}
+
+void gpio_sim_write_masks(uint64_t set_mask, uint64_t clear_mask)
+{
+    taskENTER_CRITICAL(&sim_lock);
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (set_mask & (1ULL << pin)) {
+            pins[pin].output_level = 1;
+        } else if (clear_mask & (1ULL << pin)) {
+            pins[pin].output_level = 0;
+        }
+    }
+    last_set_mask = set_mask;
+    last_clear_mask = clear_mask;
+    mask_writes++;
+    taskEXIT_CRITICAL(&sim_lock);
+}
+
+uint32_t gpio_sim_get_last_masks(uint64_t *set_mask, uint64_t *clear_mask)
+{
+    taskENTER_CRITICAL(&sim_lock);
+    *set_mask = last_set_mask;
+    *clear_mask = last_clear_mask;
+    uint32_t writes = mask_writes;
+    taskEXIT_CRITICAL(&sim_lock);
+    return writes;
+}
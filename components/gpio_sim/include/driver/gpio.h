@@ -0,0 +1,69 @@
+#ifndef GPIO_SIM_DRIVER_GPIO_H
+#define GPIO_SIM_DRIVER_GPIO_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * driver/gpio.h for the Linux host build
+ * --------------------------------------
+ * Same names and signatures as the ESP-IDF driver, only the functions
+ * used by the panel components. Backed by gpio_sim.c.
+ * Pin range and output-capable pins follow the ESP32.
+ */
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC   (-1)
+#define GPIO_NUM_MAX  40
+
+#define GPIO_IS_VALID_GPIO(gpio_num)         ((gpio_num) >= 0 && (gpio_num) < GPIO_NUM_MAX)
+#define GPIO_IS_VALID_OUTPUT_GPIO(gpio_num)  ((gpio_num) >= 0 && (gpio_num) < 34)  // 34..39 input only
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+    GPIO_MODE_INPUT_OUTPUT,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_ONLY,
+    GPIO_PULLDOWN_ONLY,
+    GPIO_PULLUP_PULLDOWN,
+    GPIO_FLOATING,
+} gpio_pull_mode_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+#ifndef ESP_INTR_FLAG_IRAM
+#define ESP_INTR_FLAG_IRAM  (1 << 10)  // Accepted and ignored
+#endif
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+
+// Light-sleep wake source on the chip; here only sets the level interrupt type
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num);
+
+#endif
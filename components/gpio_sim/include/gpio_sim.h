@@ -0,0 +1,45 @@
+#ifndef GPIO_SIM_H
+#define GPIO_SIM_H
+
+#include <stdint.h>
+#include "driver/gpio.h"
+
+/*
+ * Simulated GPIO (Linux host build)
+ * ---------------------------------
+ * The ESP-IDF Linux target has no GPIO driver. This component keeps
+ * one level per pin in RAM and offers the subset of driver/gpio.h the
+ * panel components use, so the controllers run unchanged on a PC:
+ *  - Inputs with pull-up read 1 until a test drives them
+ *  - Outputs read back what was written
+ *  - Level interrupts fire when a test changes an input
+ *
+ * Interrupt handlers run in the task that calls gpio_sim_set_input().
+ */
+
+/*
+ * @brief Drive an input pin as the outside world would (button, sensor)
+ *
+ * Calls the pin's handler if its level interrupt is enabled and matches.
+ */
+esp_err_t gpio_sim_set_input(gpio_num_t gpio_num, int level);
+
+// Last level written to an output (what an LED would show)
+int gpio_sim_get_output(gpio_num_t gpio_num);
+
+/*
+ * @brief Stand-in for one W1TS + W1TC register write (output_bank.h)
+ *
+ * Applies both masks in one step and records them, so a test can
+ * check which pins changed together.
+ */
+void gpio_sim_write_masks(uint64_t set_mask, uint64_t clear_mask);
+
+/*
+ * @brief Masks of the last gpio_sim_write_masks() call
+ *
+ * @return number of mask writes since start (0 = none yet)
+ */
+uint32_t gpio_sim_get_last_masks(uint64_t *set_mask, uint64_t *clear_mask);
+
+#endif
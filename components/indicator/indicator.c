@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include "indicator.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "hal/gpio_ll.h"
+#endif
+
+#define TAG "INDICATOR"
+
+#if CONFIG_PANEL_INDICATOR_LEDC
+#include "hal/ledc_hal.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_sig_map.h"
+#include "esp_rom_gpio.h"
+
+/*
+ * LEDC AS A SLOW BLINKER:
+ * -----------------------
+ *  - Low-speed mode, 50% duty, full timer width
+ *  - RC_FAST clock source: keeps running in light sleep and does not
+ *    change when power management scales the APB clock
+ *  - With ~8 MHz and 20 bits the usable range is about 0.3 .. 7 Hz,
+ *    which covers every panel blink pattern (0.5 .. 5 Hz)
+ */
+#define INDICATOR_LEDC_MODE     LEDC_LOW_SPEED_MODE
+#define INDICATOR_LEDC_BITS     SOC_LEDC_TIMER_BIT_WIDTH
+#define INDICATOR_LEDC_DIV_MAX  0x3FFFF   // 10.8 fixed-point clock divider register
+
+// One bit per LEDC timer + channel pair in use
+static uint32_t ledc_slots_used = 0;
+static portMUX_TYPE ledc_slots_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int ledc_slot_alloc(void)
+{
+    int slot = -1;
+    taskENTER_CRITICAL(&ledc_slots_lock);
+    for (int i = 0; i < LEDC_TIMER_MAX && i < LEDC_CHANNEL_MAX; i++) {
+        if (!(ledc_slots_used & (1u << i))) {
+            ledc_slots_used |= 1u << i;
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&ledc_slots_lock);
+    return slot;
+}
+
+static void ledc_slot_free(int slot)
+{
+    taskENTER_CRITICAL(&ledc_slots_lock);
+    ledc_slots_used &= ~(1u << slot);
+    taskEXIT_CRITICAL(&ledc_slots_lock);
+}
+
+/*
+ * ledc_timer_config() only accepts whole Hz, but MANUAL (0.5 Hz) and
+ * MAINTENANCE (2.5 Hz) are fractional. So configure the next higher
+ * whole frequency first (selects clock + resolution), then stretch the
+ * fractional clock divider to the exact period.
+ */
+static bool ledc_start_blink(indicator_t *ind, uint32_t half_period_ms)
+{
+    uint32_t period_ms = 2 * half_period_ms;
+    uint32_t freq_hz = (1000 + period_ms - 1) / period_ms;
+
+    ledc_timer_config_t timer_cfg = {
+        .speed_mode = INDICATOR_LEDC_MODE,
+        .duty_resolution = INDICATOR_LEDC_BITS,
+        .timer_num = ind->timer,
+        .freq_hz = freq_hz,
+        .clk_cfg = LEDC_USE_RC_FAST_CLK,
+    };
+    if (ledc_timer_config(&timer_cfg) != ESP_OK) {
+        return false;
+    }
+
+    ledc_hal_context_t hal;
+    ledc_hal_init(&hal, INDICATOR_LEDC_MODE);
+    uint32_t divider;
+    ledc_hal_get_clock_divider(&hal, ind->timer, &divider);
+    uint64_t exact = (uint64_t)divider * freq_hz * period_ms / 1000;
+    if (exact > INDICATOR_LEDC_DIV_MAX) {
+        return false;
+    }
+    ledc_hal_set_clock_divider(&hal, ind->timer, (uint32_t)exact);
+    ledc_hal_ls_timer_update(&hal, ind->timer);
+
+    ledc_channel_config_t channel_cfg = {
+        .gpio_num = ind->pin,
+        .speed_mode = INDICATOR_LEDC_MODE,
+        .channel = ind->channel,
+        .intr_type = LEDC_INTR_DISABLE,
+        .timer_sel = ind->timer,
+        .duty = 1u << (INDICATOR_LEDC_BITS - 1),  // 50% → equal ON / OFF time
+        .hpoint = 0,                              // Period starts with lamp ON
+        .sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE,
+    };
+    if (ledc_channel_config(&channel_cfg) != ESP_OK) {
+        return false;
+    }
+    ind->attached = true;
+    return true;
+}
+#endif
+
+static void ledc_detach(indicator_t *ind, bool on)
+{
+#if CONFIG_PANEL_INDICATOR_LEDC
+    if (ind->attached) {
+        /*
+         * Stop the timer output, then hand the pin back to the plain
+         * GPIO output register. Steady levels are always GPIO-owned,
+         * so an interrupt handler may switch the lamp directly.
+         * The register gets the level first (not staged): it shows
+         * the moment the pin leaves LEDC.
+         */
+        ledc_stop(INDICATOR_LEDC_MODE, ind->channel, on);
+        gpio_set_level(ind->pin, on);
+        gpio_set_direction(ind->pin, GPIO_MODE_OUTPUT);
+        ind->attached = false;
+    }
+#endif
+}
+
+static void write_level(indicator_t *ind, bool on)
+{
+    ledc_detach(ind, on);
+    if (ind->bank) {
+        output_bank_stage(ind->bank, ind->pin, on);
+    } else {
+        gpio_set_level(ind->pin, on);
+    }
+}
+
+void indicator_init(indicator_t *ind, gpio_num_t pin, bool on)
+{
+    ind->pin = pin;
+    ind->half_period_ms = 0;
+    ind->level = on;
+    ind->next_toggle_ms = 0;
+    ind->hw_blink = false;
+    ind->bank = NULL;
+
+#if CONFIG_PANEL_INDICATOR_LEDC
+    // One LEDC timer + channel per indicator, first come first served
+    int slot = ledc_slot_alloc();
+    ind->has_ledc = slot >= 0;
+    ind->attached = false;
+    if (ind->has_ledc) {
+        ind->timer = (ledc_timer_t)slot;
+        ind->channel = (ledc_channel_t)slot;
+    } else {
+        ESP_LOGW(TAG, "No free LEDC timer for GPIO %d - software blink", pin);
+    }
+#endif
+
+    gpio_set_level(pin, on);
+}
+
+void indicator_deinit(indicator_t *ind)
+{
+    indicator_set(ind, false);  // Also hands the pin back from LEDC
+#if CONFIG_PANEL_INDICATOR_LEDC
+    if (ind->has_ledc) {
+        ledc_timer_rst(INDICATOR_LEDC_MODE, ind->timer);
+        ledc_slot_free(ind->timer);
+        ind->has_ledc = false;
+    }
+#endif
+}
+
+void indicator_set(indicator_t *ind, bool on)
+{
+    if (ind->half_period_ms == 0 && ind->level == on) {
+        return;  // Already showing this level
+    }
+    ind->half_period_ms = 0;
+    ind->hw_blink = false;
+    ind->level = on;
+    write_level(ind, on);
+}
+
+void IRAM_ATTR indicator_write_from_isr(const indicator_t *ind, bool on)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    gpio_set_level(ind->pin, on);
+#else
+    gpio_ll_set_level(&GPIO, ind->pin, on);
+#if CONFIG_PANEL_INDICATOR_LEDC
+    // A blink may own the pin: route it back to the GPIO output register (ROM, IRAM-safe)
+    esp_rom_gpio_connect_out_signal(ind->pin, SIG_GPIO_OUT_IDX, false, false);
+#endif
+#endif
+}
+
+void indicator_assume(indicator_t *ind, bool on)
+{
+    // LEDC may still run (or have been started again since): stop it for good
+    ledc_detach(ind, on);
+    ind->half_period_ms = 0;
+    ind->hw_blink = false;
+    ind->level = on;
+}
+
+void indicator_blink(indicator_t *ind, uint32_t half_period_ms, uint32_t now_ms)
+{
+    if (half_period_ms == 0) {
+        indicator_set(ind, true);
+        return;
+    }
+    if (ind->half_period_ms == half_period_ms) {
+        return;  // Same pattern already running - do not restart it
+    }
+    ind->half_period_ms = half_period_ms;
+
+#if CONFIG_PANEL_INDICATOR_LEDC
+    if (ind->has_ledc && ledc_start_blink(ind, half_period_ms)) {
+        ind->hw_blink = true;
+        return;
+    }
+#endif
+
+    // Software blink: start ON, owner loop toggles via indicator_update()
+    ind->hw_blink = false;
+    ind->level = true;
+    write_level(ind, true);
+    ind->next_toggle_ms = now_ms + half_period_ms;
+}
+
+uint32_t indicator_update(indicator_t *ind, uint32_t now_ms)
+{
+    if (ind->hw_blink || ind->half_period_ms == 0) {
+        return INDICATOR_NO_DEADLINE;
+    }
+    if ((int32_t)(now_ms - ind->next_toggle_ms) >= 0) {
+        ind->level = !ind->level;
+        write_level(ind, ind->level);
+        ind->next_toggle_ms = now_ms + ind->half_period_ms;
+    }
+    return ind->next_toggle_ms - now_ms;
+}
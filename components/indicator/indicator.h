@@ -0,0 +1,118 @@
+#ifndef INDICATOR_H
+#define INDICATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "output_bank.h"
+#include "sdkconfig.h"
+
+#if CONFIG_PANEL_INDICATOR_LEDC
+#include "driver/ledc.h"
+#endif
+
+/*
+ * Panel Indicator Output
+ * ----------------------
+ * One indicator = one lamp / LED on a GPIO. It can be:
+ *  - Steady ON or OFF
+ *  - Blinking with a constant ON/OFF time (50% duty)
+ * 
+ * HARDWARE BLINK (LEDC):
+ *  The LEDC PWM timer is slowed down to the blink frequency, so the
+ *  peripheral toggles the pin by itself. The CPU is only involved
+ *  when the pattern changes (e.g. mode switch, alarm on/off).
+ * 
+ * SOFTWARE BLINK (fallback):
+ *  Used on targets without LEDC, when all LEDC timers are taken or
+ *  when the frequency is out of range. The owner loop must call
+ *  indicator_update() and wake again after the returned time.
+ * 
+ * BATCHED WRITES (optional):
+ *  With indicator_use_bank() steady levels and software toggles are
+ *  only staged; the owner commits the bank once for all its
+ *  indicators (output_bank.h).
+ */
+
+#define INDICATOR_NO_DEADLINE  UINT32_MAX
+
+typedef struct {
+    gpio_num_t pin;
+    uint32_t half_period_ms;   // 0 = steady
+    bool level;                // Steady level / current software level
+    uint32_t next_toggle_ms;   // Software blink: next toggle time
+    bool hw_blink;             // LEDC is generating the current pattern
+    output_bank_t *bank;       // NULL = write each level at once
+#if CONFIG_PANEL_INDICATOR_LEDC
+    bool has_ledc;             // LEDC timer + channel reserved
+    bool attached;             // Pin is routed to the LEDC output
+    ledc_timer_t timer;
+    ledc_channel_t channel;
+#endif
+} indicator_t;
+
+/*
+ * @brief Bind an indicator to an output pin and drive it steady
+ * 
+ * The pin must already be configured as output. Pass the level it
+ * already shows (e.g. after fast-restore) to avoid a visible glitch.
+ */
+void indicator_init(indicator_t *ind, gpio_num_t pin, bool on);
+
+// Switch OFF and release the LEDC timer / channel for the next indicator
+void indicator_deinit(indicator_t *ind);
+
+/*
+ * @brief Stage level changes in a bank instead of writing them
+ * 
+ * The caller commits the bank after its indicator_set / _blink /
+ * _update calls. Handing the pin back from LEDC still writes at once.
+ */
+static inline void indicator_use_bank(indicator_t *ind, output_bank_t *bank)
+{
+    ind->bank = bank;
+}
+
+// Steady ON / OFF
+void indicator_set(indicator_t *ind, bool on);
+
+/*
+ * @brief Drive the pin from an interrupt handler (IRAM)
+ * 
+ * Writes the GPIO register and takes the pin back from a running LEDC
+ * blink. Leaves the indicator state alone: the owner must call
+ * indicator_assume() afterwards.
+ */
+void indicator_write_from_isr(const indicator_t *ind, bool on);
+
+/*
+ * @brief Record that the pin was driven from outside
+ * 
+ * After indicator_write_from_isr(). Stops a blink still configured
+ * in LEDC, so the next set / blink call rewrites the pin.
+ */
+void indicator_assume(indicator_t *ind, bool on);
+
+/*
+ * @brief Blink with half_period_ms ON and half_period_ms OFF
+ * 
+ * Starts with the lamp ON. Calling again with the same period does
+ * nothing (the running pattern is not restarted).
+ */
+void indicator_blink(indicator_t *ind, uint32_t half_period_ms, uint32_t now_ms);
+
+/*
+ * @brief Software blink step
+ * 
+ * @return ms until the next call is needed,
+ *         INDICATOR_NO_DEADLINE if steady or blinking in hardware
+ */
+uint32_t indicator_update(indicator_t *ind, uint32_t now_ms);
+
+// True if the current pattern runs in hardware (no wakeups needed)
+static inline bool indicator_is_hw_timed(const indicator_t *ind)
+{
+    return ind->hw_blink;
+}
+
+#endif
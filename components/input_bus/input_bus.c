@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <string.h>
+#include "input_bus.h"
+#include "panel_pm.h"
+#include "debounce.h"
+#include "task_monitor.h"
+#include "freertos/semphr.h"
+#include "esp_console.h"
+#include "esp_log.h"
+
+#define TAG "INPUT_BUS"
+
+#define INPUT_BUS_TASK_STACK  3072
+
+#define MAX_INPUTS  CONFIG_INPUT_BUS_MAX_INPUTS
+#define MAX_SUBS    CONFIG_INPUT_BUS_MAX_SUBSCRIBERS
+#define QUEUE_LEN   CONFIG_INPUT_BUS_QUEUE_LEN
+
+// head / tail are free-running 32-bit counters: index = counter % QUEUE_LEN
+_Static_assert((QUEUE_LEN & (QUEUE_LEN - 1)) == 0, "CONFIG_INPUT_BUS_QUEUE_LEN must be a power of two");
+
+/*
+ * ONE ENTRY PER PHYSICAL PIN:
+ *  - button:   level interrupt / wake source, notifies the bus task
+ *  - debounce: shared by all subscribers of the pin
+ *  - Slot is free while sub_count == 0
+ */
+typedef struct {
+    panel_pm_button_t button;
+    debounce_t debounce;
+    input_bus_sub_t *subs[MAX_SUBS];
+    uint8_t sub_count;
+    uint32_t presses;
+    uint32_t glitches;
+} bus_input_t;
+
+static bus_input_t inputs[MAX_INPUTS];
+static SemaphoreHandle_t bus_mutex = NULL;   // Input table (not the queues)
+static TaskHandle_t bus_task = NULL;
+
+// Caller holds bus_mutex
+static bus_input_t *find_input(gpio_num_t pin)
+{
+    for (int i = 0; i < MAX_INPUTS; i++) {
+        if (inputs[i].sub_count > 0 && inputs[i].button.pin == pin) {
+            return &inputs[i];
+        }
+    }
+    return NULL;
+}
+
+// Caller holds bus_mutex. Every pin: an unsubscribed sub holds no valid pin
+static bool is_subscribed(const input_bus_sub_t *sub)
+{
+    for (int i = 0; i < MAX_INPUTS; i++) {
+        for (int j = 0; j < inputs[i].sub_count; j++) {
+            if (inputs[i].subs[j] == sub) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * PUBLISH (bus task only):
+ *  - Full queue → the NEW event is dropped: the subscriber keeps a
+ *    consistent history up to the point it fell behind
+ *  - The subscriber is notified either way, so it wakes and drains
+ */
+static void publish(bus_input_t *in, const input_event_t *event)
+{
+    for (int i = 0; i < in->sub_count; i++) {
+        input_bus_sub_t *sub = in->subs[i];
+        uint32_t head = sub->head;
+        uint32_t tail = __atomic_load_n(&sub->tail, __ATOMIC_ACQUIRE);
+
+        if (head - tail >= QUEUE_LEN) {
+            sub->dropped++;
+        } else {
+            sub->events[head % QUEUE_LEN] = *event;
+            __atomic_store_n(&sub->head, head + 1, __ATOMIC_RELEASE);  // Event visible, then index
+        }
+        xTaskNotifyGive(sub->task);
+    }
+}
+
+/*
+ * Read, debounce and publish one pin; returns ms to its debounce deadline.
+ * Caller holds bus_mutex.
+ */
+static uint32_t sample_input(bus_input_t *in, uint32_t now_ms)
+{
+    panel_pm_button_disarm(&in->button);
+    bool raw_pressed = panel_pm_button_get_level(&in->button) == 0;  // LOW = pressed (pull-up)
+    bool was_pending = in->debounce.pending;
+    uint32_t edge_ms = in->debounce.change_ms;
+
+    if (debounce_feed(&in->debounce, raw_pressed, now_ms)) {
+        input_event_t event = {
+            .pin = in->button.pin,
+            .type = in->debounce.stable_pressed ? INPUT_EVENT_PRESS : INPUT_EVENT_RELEASE,
+            .time_ms = now_ms,
+            .edge_ms = in->debounce.change_ms,
+        };
+        if (event.type == INPUT_EVENT_PRESS) {
+            in->presses++;
+        }
+        publish(in, &event);
+    } else if (was_pending && !in->debounce.pending) {
+        // Level went back before debounce_ms: subscribers may have acted on the raw edge
+        input_event_t event = {
+            .pin = in->button.pin,
+            .type = INPUT_EVENT_GLITCH,
+            .time_ms = now_ms,
+            .edge_ms = edge_ms,
+        };
+        in->glitches++;
+        publish(in, &event);
+    } else if (in->button.fired && !in->debounce.pending) {
+        // Interrupt fired but the level was back before this pass: a spike the
+        // debounce never saw. ISR hooks may still have acted on it.
+        input_event_t event = {
+            .pin = in->button.pin,
+            .type = INPUT_EVENT_GLITCH,
+            .time_ms = now_ms,
+            .edge_ms = now_ms,  // Real edge time unknown
+        };
+        in->glitches++;
+        publish(in, &event);
+    }
+    return debounce_ms_to_deadline(&in->debounce, now_ms);
+}
+
+static TickType_t wait_ticks(uint32_t timeout_ms)
+{
+    if (timeout_ms == PANEL_PM_WAIT_FOREVER) {
+        return portMAX_DELAY;
+    }
+    // Round up: never wake before the deadline
+    return (timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
+
+/*
+ * BUS TASK:
+ *  1. Every used pin: read, debounce, publish, re-arm its interrupt
+ *  2. Sleep until a pin changes, a debounce deadline passes, or the
+ *     table changed (subscribe / inject / hook)
+ * With all buttons idle this is one wakeup per button change.
+ */
+static void input_bus_task(void *arg)
+{
+    panel_pm_wake_counter_t wakes = PANEL_PM_WAKE_COUNTER("input_bus");
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "input_bus");
+
+    while (1) {
+        panel_pm_wake_count(&wakes);
+        task_monitor_loop_begin(&loop_stats);
+        uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        uint32_t wait_ms = PANEL_PM_WAIT_FOREVER;
+
+        xSemaphoreTake(bus_mutex, portMAX_DELAY);
+        for (int i = 0; i < MAX_INPUTS; i++) {
+            if (inputs[i].sub_count == 0) {
+                continue;
+            }
+            uint32_t deadline_ms = sample_input(&inputs[i], now_ms);
+            if (deadline_ms < wait_ms) {
+                wait_ms = deadline_ms;
+            }
+            panel_pm_button_arm(&inputs[i].button);
+        }
+        xSemaphoreGive(bus_mutex);
+
+        task_monitor_loop_end(&loop_stats);
+        ulTaskNotifyTake(pdTRUE, wait_ticks(wait_ms));
+    }
+}
+
+esp_err_t input_bus_start(void)
+{
+    if (bus_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    bus_mutex = xSemaphoreCreateMutex();
+    if (bus_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(input_bus_task, "input_bus", INPUT_BUS_TASK_STACK, NULL,
+                    CONFIG_INPUT_BUS_TASK_PRIORITY, &bus_task) != pdPASS) {
+        vSemaphoreDelete(bus_mutex);
+        bus_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Started: %d inputs x %d subscribers, %d events per queue",
+             MAX_INPUTS, MAX_SUBS, QUEUE_LEN);
+    return ESP_OK;
+}
+
+/*
+ * GPIO SETUP - PANEL BUTTON (done once per pin):
+ *  - Input with internal PULL-UP: released = HIGH, pressed = LOW
+ *  - Level interrupt + light-sleep wake source for the bus task
+ */
+static esp_err_t add_input(bus_input_t *in, gpio_num_t pin, uint32_t debounce_ms)
+{
+    gpio_reset_pin(pin);
+    gpio_set_direction(pin, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+
+    esp_err_t err = panel_pm_button_init(&in->button, pin);
+    if (err != ESP_OK) {
+        return err;
+    }
+    in->button.task = bus_task;  // Initialised from the subscriber, owned by the bus
+    debounce_init(&in->debounce, debounce_ms, false);
+    in->presses = 0;
+    in->glitches = 0;
+    return ESP_OK;
+}
+
+esp_err_t input_bus_subscribe(input_bus_sub_t *sub, gpio_num_t pin, uint32_t debounce_ms, const char *name)
+{
+    return input_bus_subscribe_task(sub, xTaskGetCurrentTaskHandle(), pin, debounce_ms, name);
+}
+
+esp_err_t input_bus_subscribe_task(input_bus_sub_t *sub, TaskHandle_t task, gpio_num_t pin,
+                                   uint32_t debounce_ms, const char *name)
+{
+    if (!GPIO_IS_VALID_GPIO(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bus_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    if (is_subscribed(sub)) {
+        xSemaphoreGive(bus_mutex);  // Clearing it would lose the queue the bus task is filling
+        ESP_LOGE(TAG, "GPIO %d: %s already subscribed", pin, name);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(sub, 0, sizeof(*sub));
+    sub->task = task;
+    sub->pin = pin;
+    sub->name = name;
+
+    bus_input_t *in = find_input(pin);
+    if (in == NULL) {
+        for (int i = 0; i < MAX_INPUTS && in == NULL; i++) {
+            if (inputs[i].sub_count == 0) {
+                in = &inputs[i];
+            }
+        }
+        err = (in == NULL) ? ESP_ERR_NO_MEM : add_input(in, pin, debounce_ms);
+    } else if (in->sub_count >= MAX_SUBS) {
+        err = ESP_ERR_NO_MEM;
+    } else if (in->debounce.debounce_ms != debounce_ms) {
+        ESP_LOGW(TAG, "GPIO %d: %s asks for %lu ms debounce, pin keeps %lu ms", pin, name,
+                 (unsigned long)debounce_ms, (unsigned long)in->debounce.debounce_ms);
+    }
+    if (err == ESP_OK) {
+        in->subs[in->sub_count++] = sub;
+    }
+    xSemaphoreGive(bus_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "GPIO %d: %s not subscribed: %s", pin, name, esp_err_to_name(err));
+        return err;
+    }
+    xTaskNotifyGive(bus_task);  // Sample and arm the (new) pin
+    return ESP_OK;
+}
+
+void input_bus_unsubscribe(input_bus_sub_t *sub)
+{
+    if (bus_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    bus_input_t *in = find_input(sub->pin);
+    for (int i = 0; in != NULL && i < in->sub_count; i++) {
+        if (in->subs[i] == sub) {
+            in->subs[i] = in->subs[--in->sub_count];  // Order does not matter
+            if (in->sub_count == 0) {
+                panel_pm_button_deinit(&in->button);  // Last one: release the pin interrupt
+            }
+            break;
+        }
+    }
+    xSemaphoreGive(bus_mutex);
+}
+
+bool input_bus_receive(input_bus_sub_t *sub, input_event_t *event)
+{
+    uint32_t tail = sub->tail;
+    uint32_t head = __atomic_load_n(&sub->head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    *event = sub->events[tail % QUEUE_LEN];
+    __atomic_store_n(&sub->tail, tail + 1, __ATOMIC_RELEASE);  // Slot free for the bus task
+    return true;
+}
+
+bool input_bus_wait(input_bus_sub_t *sub, uint32_t timeout_ms)
+{
+    // An event queued after this check leaves a notification pending: no lost wakeup
+    if (input_bus_pending(sub)) {
+        return true;
+    }
+    ulTaskNotifyTake(pdTRUE, wait_ticks(timeout_ms));
+    return input_bus_pending(sub);
+}
+
+esp_err_t input_bus_inject(gpio_num_t pin, bool pressed)
+{
+    if (bus_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    bus_input_t *in = find_input(pin);
+    if (in != NULL) {
+        panel_pm_button_inject(&in->button, pressed);  // Wakes the bus task
+        err = ESP_OK;
+    }
+    xSemaphoreGive(bus_mutex);
+    return err;
+}
+
+esp_err_t input_bus_set_isr_hook(gpio_num_t pin, void (*hook)(void *arg), void *arg)
+{
+    if (bus_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    bus_input_t *in = find_input(pin);
+    if (in == NULL) {
+        err = ESP_ERR_NOT_FOUND;
+    } else if (hook != NULL && in->button.hook != NULL &&
+               (in->button.hook != hook || in->button.hook_arg != arg)) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        panel_pm_button_set_isr_hook(&in->button, hook, arg);  // Disarms the pin
+    }
+    xSemaphoreGive(bus_mutex);
+    xTaskNotifyGive(bus_task);  // Re-arm
+    return err;
+}
+
+void input_bus_print(void)
+{
+    if (bus_mutex == NULL) {
+        printf("Input bus not started\n");
+        return;
+    }
+    printf("GPIO  level  debounce  presses  glitches  subscribers (queued/dropped)\n");
+    xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_INPUTS; i++) {
+        bus_input_t *in = &inputs[i];
+        if (in->sub_count == 0) {
+            continue;
+        }
+        printf("%4d  %-5s  %5lu ms  %7lu  %8lu ", in->button.pin,
+               in->debounce.stable_pressed ? "LOW" : "HIGH", (unsigned long)in->debounce.debounce_ms,
+               (unsigned long)in->presses, (unsigned long)in->glitches);
+        for (int s = 0; s < in->sub_count; s++) {
+            const input_bus_sub_t *sub = in->subs[s];
+            printf(" %s (%lu/%lu)", sub->name, (unsigned long)(sub->head - sub->tail),
+                   (unsigned long)sub->dropped);
+        }
+        printf("\n");
+    }
+    xSemaphoreGive(bus_mutex);
+}
+
+static int cmd_inputs(int argc, char **argv)
+{
+    input_bus_print();
+    return 0;
+}
+
+esp_err_t input_bus_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "inputs",
+        .help = "Show panel input pins, their subscribers and dropped events",
+        .hint = NULL,
+        .func = &cmd_inputs,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,127 @@
+#ifndef INPUT_BUS_H
+#define INPUT_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/*
+ * Panel Input Bus
+ * ---------------
+ * One physical button, any number of functions behind it.
+ *
+ * Before: every controller did gpio_reset_pin() + its own interrupt
+ * and debounce on its button pin. Two controllers on the same pin
+ * (emergency + mode selector both default to GPIO 18) fought over it.
+ *
+ * Now:
+ *  - The bus task owns every input pin: configured ONCE, ONE level
+ *    interrupt / light-sleep wake source, ONE debounce
+ *  - Each debounced change is copied to every subscriber of that pin
+ *  - A subscriber has its own fixed-size queue (no heap, bounded RAM);
+ *    if it falls behind, new events are dropped and counted
+ *
+ * QUEUE (per subscriber, lock-free):
+ *  - Written only by the bus task, read only by the subscriber task
+ *    (single producer / single consumer) → no mutex on the hot path
+ *  - The subscriber task is woken with a task notification
+ *
+ * Console: "inputs" lists pins, subscribers and drop counters.
+ */
+
+typedef enum {
+    INPUT_EVENT_PRESS = 0,     // Debounced LOW (pull-up wiring)
+    INPUT_EVENT_RELEASE,       // Debounced HIGH
+    INPUT_EVENT_GLITCH,        // Level change rejected by the debounce, or gone before the bus sampled it
+} input_event_type_t;
+
+typedef struct {
+    gpio_num_t pin;
+    input_event_type_t type;
+    uint32_t time_ms;          // Accepted (end of debounce) / glitch seen
+    uint32_t edge_ms;          // Raw edge that started it
+} input_event_t;
+
+/*
+ * SUBSCRIPTION:
+ *  - Lives in the subscriber (static or controller instance struct)
+ *  - Must stay valid until input_bus_unsubscribe()
+ */
+typedef struct {
+    input_event_t events[CONFIG_INPUT_BUS_QUEUE_LEN];
+    volatile uint32_t head;     // Bus task only
+    volatile uint32_t tail;     // Subscriber only
+    volatile uint32_t dropped;  // Bus task only: events lost to a full queue
+    TaskHandle_t task;          // Notified on every event
+    gpio_num_t pin;
+    const char *name;
+} input_bus_sub_t;
+
+/*
+ * @brief Create the bus task (call once from app_main, before the demos)
+ */
+esp_err_t input_bus_start(void);
+
+/*
+ * @brief Subscribe the calling task to a (pull-up, active LOW) button
+ *
+ * The first subscriber of a pin configures it and sets its debounce
+ * time; later subscribers share both.
+ *
+ * @return ESP_ERR_INVALID_STATE if the bus is not started or sub is
+ *         already subscribed (unsubscribe it first),
+ *         ESP_ERR_NO_MEM if the input or subscriber table is full
+ */
+esp_err_t input_bus_subscribe(input_bus_sub_t *sub, gpio_num_t pin, uint32_t debounce_ms, const char *name);
+
+// Same, but the events wake 'task' (e.g. a manager subscribing from a console command)
+esp_err_t input_bus_subscribe_task(input_bus_sub_t *sub, TaskHandle_t task, gpio_num_t pin,
+                                   uint32_t debounce_ms, const char *name);
+
+// Leave the bus; the last subscriber of a pin releases it
+void input_bus_unsubscribe(input_bus_sub_t *sub);
+
+// Take the oldest queued event (subscriber task only), false if empty
+bool input_bus_receive(input_bus_sub_t *sub, input_event_t *event);
+
+// Events waiting in the queue
+static inline bool input_bus_pending(const input_bus_sub_t *sub)
+{
+    return sub->head != sub->tail;
+}
+
+/*
+ * @brief Block until an event is queued or timeout_ms passes
+ *
+ * Any other task notification (e.g. a stop request) also wakes it.
+ * @param timeout_ms  PANEL_PM_WAIT_FOREVER (UINT32_MAX) = no timer wakeup
+ * @return true if events are pending
+ */
+bool input_bus_wait(input_bus_sub_t *sub, uint32_t timeout_ms);
+
+/*
+ * @brief Virtual press / release, seen by EVERY subscriber of the pin
+ *
+ * @return ESP_ERR_NOT_FOUND if nobody subscribed to the pin
+ */
+esp_err_t input_bus_inject(gpio_num_t pin, bool pressed);
+
+/*
+ * @brief Run hook(arg) inside the pin interrupt (IRAM_ATTR, no blocking)
+ *
+ * One hook per pin (E-STOP lamp latch). hook = NULL removes it.
+ * @return ESP_ERR_INVALID_STATE if another hook is already set
+ */
+esp_err_t input_bus_set_isr_hook(gpio_num_t pin, void (*hook)(void *arg), void *arg);
+
+// Print inputs, subscribers and counters
+void input_bus_print(void);
+
+// Add the "inputs" command
+esp_err_t input_bus_register_console(void);
+
+#endif
@@ -0,0 +1,387 @@
+#include <stdio.h>
+#include <string.h>
+#include "led_anim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "LED_ANIM"
+
+#define LED_ANIM_TASK_STACK  3072
+#define MAX_LEDS             CONFIG_LED_ANIM_MAX_LEDS
+#define MAX_LAYERS           CONFIG_LED_ANIM_MAX_LAYERS
+#define Q16_ONE              65535u
+
+// Frame period in ticks (at least one tick)
+#define FRAME_TICKS  ((configTICK_RATE_HZ / CONFIG_LED_ANIM_FPS) > 0 ? (configTICK_RATE_HZ / CONFIG_LED_ANIM_FPS) : 1)
+
+static uint16_t frame[MAX_LEDS * 3];           // R, G, B per LED, 0..65535
+static led_anim_layer_t *layers[MAX_LAYERS];   // Bottom → top
+static uint8_t layer_count = 0;
+static uint16_t strip_leds = 0;
+static led_anim_push_t push_frame = NULL;
+static void *push_ctx = NULL;
+static bool dirty = false;                     // Layers changed since the last frame
+static SemaphoreHandle_t anim_mutex = NULL;    // Layers + frame buffer
+static TaskHandle_t anim_task = NULL;
+
+// Frame statistics (engine task writes, console reads)
+typedef struct {
+    uint32_t frames;
+    uint32_t dropped;
+    uint32_t frame_min_us;
+    uint32_t frame_max_us;
+    uint64_t frame_sum_us;      // Render + push
+    uint64_t render_sum_us;     // Render only
+} anim_stats_t;
+
+static anim_stats_t stats = { .frame_min_us = UINT32_MAX };
+
+/*
+ * EASING IN FIXED POINT:
+ *  - t and the result are Q16: 0 = start, 65535 = end
+ *  - Products of two Q16 values are shifted back by 16
+ */
+uint32_t led_anim_ease(led_anim_easing_t easing, uint32_t t)
+{
+    if (t > Q16_ONE) {
+        t = Q16_ONE;
+    }
+    uint32_t inv = Q16_ONE - t;
+    uint32_t eased;
+
+    switch (easing) {
+        case LED_ANIM_EASE_IN_QUAD:
+            eased = (t * t) >> 16;
+            break;
+        case LED_ANIM_EASE_OUT_QUAD:
+            eased = Q16_ONE - ((inv * inv) >> 16);
+            break;
+        case LED_ANIM_EASE_IN_OUT_CUBIC:
+            if (t < 32768) {
+                uint32_t t2 = (t * t) >> 16;
+                eased = 4 * ((t2 * t) >> 16);                // 4t³
+            } else {
+                uint32_t i2 = (inv * inv) >> 16;
+                eased = Q16_ONE - 4 * ((i2 * inv) >> 16);   // 1 - 4(1-t)³
+            }
+            break;
+        case LED_ANIM_EASE_SMOOTHSTEP:
+            eased = (uint32_t)(((uint64_t)t * t * (3 * 65536 - 2 * t)) >> 32);  // t²(3 - 2t)
+            break;
+        default:
+            eased = t;
+            break;
+    }
+    // Rounding can overshoot by one step at t = 1
+    return eased > Q16_ONE ? Q16_ONE : eased;
+}
+
+// Position inside the repeating period as Q16
+static uint32_t period_progress(uint32_t elapsed_ms, uint32_t period_ms)
+{
+    return (uint32_t)(((uint64_t)(elapsed_ms % period_ms) << 16) / period_ms);
+}
+
+// Time since play(); a frame scheduled just before play() counts as 0
+static uint32_t layer_elapsed(const led_anim_layer_t *layer, uint32_t now_ms)
+{
+    int32_t elapsed_ms = (int32_t)(now_ms - layer->start_ms);
+    return elapsed_ms > 0 ? (uint32_t)elapsed_ms : 0;
+}
+
+/*
+ * ALPHA OF A UNIFORM LAYER (everything except CHASE):
+ *  - Q16: a slow fade moves in 65536 steps, not 256
+ *  - *animating is set if the next frame will look different
+ */
+static uint32_t layer_alpha(const led_anim_layer_t *layer, uint32_t now_ms, bool *animating)
+{
+    uint32_t elapsed_ms = layer_elapsed(layer, now_ms);
+    uint32_t period_ms = layer->period_ms ? layer->period_ms : 1;
+
+    switch (layer->effect) {
+        case LED_ANIM_SOLID:
+            return Q16_ONE;
+        case LED_ANIM_FADE_IN:
+        case LED_ANIM_FADE_OUT: {
+            int32_t to = layer->effect == LED_ANIM_FADE_IN ? Q16_ONE : 0;
+            if (elapsed_ms >= period_ms) {
+                return (uint32_t)to;
+            }
+            *animating = true;
+            uint32_t t = (uint32_t)(((uint64_t)elapsed_ms << 16) / period_ms);
+            int64_t eased = led_anim_ease(layer->easing, t);
+            return (uint32_t)(layer->from_alpha + (((to - layer->from_alpha) * eased) >> 16));
+        }
+        case LED_ANIM_PULSE: {
+            *animating = true;
+            uint32_t t = period_progress(elapsed_ms, period_ms);
+            uint32_t up = t < 32768 ? t * 2 : (Q16_ONE - t) * 2;   // Triangle 0 → 1 → 0
+            return led_anim_ease(layer->easing, up);
+        }
+        case LED_ANIM_BLINK:
+            *animating = true;
+            return period_progress(elapsed_ms, period_ms) < 32768 ? Q16_ONE : 0;
+        default:
+            return 0;
+    }
+}
+
+// Blend one colour (8-bit, widened: 255 → 65535) over a frame pixel with Q16 alpha
+static inline void blend(uint16_t *px, led_anim_rgb_t c, uint32_t alpha)
+{
+    if (alpha == Q16_ONE) {
+        px[0] = c.r * 257;
+        px[1] = c.g * 257;
+        px[2] = c.b * 257;
+    } else if (alpha != 0) {
+        px[0] += ((int64_t)(c.r * 257 - px[0]) * alpha) >> 16;
+        px[1] += ((int64_t)(c.g * 257 - px[1]) * alpha) >> 16;
+        px[2] += ((int64_t)(c.b * 257 - px[2]) * alpha) >> 16;
+    }
+}
+
+/*
+ * CHASE:
+ *  - Eased position in Q16 pixels along the layer
+ *  - The dot is split over two neighbouring LEDs by the fraction, so
+ *    a slow chase glides instead of jumping LED by LED
+ */
+static void render_chase(const led_anim_layer_t *layer, uint32_t now_ms)
+{
+    uint32_t period_ms = layer->period_ms ? layer->period_ms : 1;
+    uint32_t t = led_anim_ease(layer->easing, period_progress(layer_elapsed(layer, now_ms), period_ms));
+    uint32_t pos_q16 = (uint32_t)(((uint64_t)t * (layer->count - 1) * 65536) / Q16_ONE);
+    uint32_t index = pos_q16 >> 16;
+    uint32_t frac = pos_q16 & 0xFFFF;
+
+    blend(&frame[(layer->first + index) * 3], layer->color, Q16_ONE - frac);
+    if (frac != 0 && index + 1 < layer->count) {
+        blend(&frame[(layer->first + index + 1) * 3], layer->color, frac);
+    }
+}
+
+/*
+ * RENDER ONE FRAME (caller holds anim_mutex):
+ *  - Clear, then every layer bottom → top
+ * Returns true if any layer is still animating.
+ */
+static bool render(uint32_t now_ms)
+{
+    bool animating = false;
+
+    memset(frame, 0, strip_leds * 3 * sizeof(frame[0]));
+    for (int i = 0; i < layer_count; i++) {
+        const led_anim_layer_t *layer = layers[i];
+        if (layer->effect == LED_ANIM_CHASE) {
+            if (layer->count > 0) {
+                render_chase(layer, now_ms);
+            }
+            animating = true;
+            continue;
+        }
+        uint32_t alpha = layer_alpha(layer, now_ms, &animating);
+        for (uint32_t led = layer->first; alpha != 0 && led < (uint32_t)layer->first + layer->count; led++) {
+            blend(&frame[led * 3], layer->color, alpha);
+        }
+    }
+    return animating;
+}
+
+/*
+ * FRAME CLOCK (engine task):
+ *  - Frame k is due at tick start + k * FRAME_TICKS; the animations
+ *    are evaluated at that scheduled time, not "now", so a late
+ *    wakeup does not bend the easing curves
+ *  - Woken more than a frame late → the missed frames are counted as
+ *    dropped and skipped, the schedule stays on the wall clock
+ *  - Nothing animating and nothing changed → sleep until play()
+ */
+static void led_anim_task(void *arg)
+{
+    TickType_t next_tick = xTaskGetTickCount();
+    bool animating = false;
+
+    while (1) {
+        xSemaphoreTake(anim_mutex, portMAX_DELAY);
+        bool active = animating || dirty;
+        xSemaphoreGive(anim_mutex);
+
+        if (!active) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            next_tick = xTaskGetTickCount();   // New animation: first frame at once
+            continue;
+        }
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(now - next_tick) < 0) {
+            ulTaskNotifyTake(pdTRUE, next_tick - now);
+            continue;
+        }
+        TickType_t late = now - next_tick;
+        if (late >= FRAME_TICKS) {
+            stats.dropped += late / FRAME_TICKS;
+            next_tick += (late / FRAME_TICKS) * FRAME_TICKS;
+        }
+        uint32_t frame_ms = next_tick * portTICK_PERIOD_MS;
+
+        int64_t start_us = esp_timer_get_time();
+        xSemaphoreTake(anim_mutex, portMAX_DELAY);
+        animating = render(frame_ms);
+        dirty = false;
+        xSemaphoreGive(anim_mutex);
+        int64_t render_us = esp_timer_get_time() - start_us;
+
+        push_frame(frame, strip_leds, push_ctx);   // Only this task writes the buffer
+        uint32_t frame_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        stats.frames++;
+        stats.render_sum_us += render_us;
+        stats.frame_sum_us += frame_us;
+        if (frame_us < stats.frame_min_us) {
+            stats.frame_min_us = frame_us;
+        }
+        if (frame_us > stats.frame_max_us) {
+            stats.frame_max_us = frame_us;
+        }
+        next_tick += FRAME_TICKS;
+    }
+}
+
+esp_err_t led_anim_start(uint16_t leds, led_anim_push_t push, void *ctx)
+{
+    if (anim_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (leds == 0 || leds > MAX_LEDS || push == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    anim_mutex = xSemaphoreCreateMutex();
+    if (anim_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    strip_leds = leds;
+    push_frame = push;
+    push_ctx = ctx;
+    dirty = true;   // First frame: all LEDs off
+    if (xTaskCreate(led_anim_task, "led_anim", LED_ANIM_TASK_STACK, NULL,
+                    CONFIG_LED_ANIM_TASK_PRIORITY, &anim_task) != pdPASS) {
+        vSemaphoreDelete(anim_mutex);
+        anim_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Started: %u LEDs, %d fps", leds, configTICK_RATE_HZ / FRAME_TICKS);
+    return ESP_OK;
+}
+
+esp_err_t led_anim_add(led_anim_layer_t *layer, uint16_t first, uint16_t count, const char *name)
+{
+    if (anim_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if ((uint32_t)first + count > strip_leds) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(layer, 0, sizeof(*layer));
+    layer->first = first;
+    layer->count = count;
+    layer->name = name;
+    layer->effect = LED_ANIM_OFF;
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(anim_mutex, portMAX_DELAY);
+    if (layer_count < MAX_LAYERS) {
+        layers[layer_count++] = layer;
+        err = ESP_OK;
+    }
+    xSemaphoreGive(anim_mutex);
+    return err;
+}
+
+void led_anim_remove(led_anim_layer_t *layer)
+{
+    if (anim_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(anim_mutex, portMAX_DELAY);
+    for (int i = 0; i < layer_count; i++) {
+        if (layers[i] == layer) {
+            // Shift down: keeps the stacking order of the others
+            memmove(&layers[i], &layers[i + 1], (layer_count - i - 1) * sizeof(layers[0]));
+            layer_count--;
+            dirty = true;
+            break;
+        }
+    }
+    xSemaphoreGive(anim_mutex);
+    xTaskNotifyGive(anim_task);
+}
+
+void led_anim_play(led_anim_layer_t *layer, led_anim_effect_t effect, led_anim_rgb_t color,
+                   uint32_t period_ms, led_anim_easing_t easing)
+{
+    if (anim_mutex == NULL) {
+        return;
+    }
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    bool animating = false;
+
+    xSemaphoreTake(anim_mutex, portMAX_DELAY);
+    // Fades continue from what is shown now (CHASE counts as transparent)
+    layer->from_alpha = layer_alpha(layer, now_ms, &animating);
+    layer->effect = effect;
+    layer->easing = easing;
+    layer->color = color;
+    layer->period_ms = period_ms;
+    layer->start_ms = now_ms;
+    dirty = true;
+    xSemaphoreGive(anim_mutex);
+    xTaskNotifyGive(anim_task);
+}
+
+void led_anim_print(void)
+{
+    static const char *effects[] = { "off", "solid", "fade-in", "fade-out", "pulse", "blink", "chase" };
+
+    if (anim_mutex == NULL) {
+        printf("LED animation not started\n");
+        return;
+    }
+    anim_stats_t s = stats;   // Snapshot; a torn counter only skews one line
+    printf("Frame clock: %d fps target (%d ticks per frame), %u LEDs\n",
+           configTICK_RATE_HZ / FRAME_TICKS, FRAME_TICKS, strip_leds);
+    printf("Frames: %lu sent, %lu dropped\n", (unsigned long)s.frames, (unsigned long)s.dropped);
+    if (s.frames > 0) {
+        printf("Frame time: min %lu us, avg %lu us (render %lu us), max %lu us\n",
+               (unsigned long)s.frame_min_us, (unsigned long)(s.frame_sum_us / s.frames),
+               (unsigned long)(s.render_sum_us / s.frames), (unsigned long)s.frame_max_us);
+    }
+    xSemaphoreTake(anim_mutex, portMAX_DELAY);
+    for (int i = 0; i < layer_count; i++) {
+        const led_anim_layer_t *layer = layers[i];
+        printf("  %d %-10s  LED %3u +%-3u  %-8s  #%02x%02x%02x  %lu ms\n", i, layer->name ? layer->name : "-",
+               layer->first, layer->count, layer->effect <= LED_ANIM_CHASE ? effects[layer->effect] : "?",
+               layer->color.r, layer->color.g, layer->color.b, (unsigned long)layer->period_ms);
+    }
+    xSemaphoreGive(anim_mutex);
+}
+
+static int cmd_anim(int argc, char **argv)
+{
+    led_anim_print();
+    return 0;
+}
+
+esp_err_t led_anim_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "anim",
+        .help = "Show LED animation frame rate, frame time, dropped frames and layers",
+        .hint = NULL,
+        .func = &cmd_anim,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,128 @@
+#ifndef LED_ANIM_H
+#define LED_ANIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * LED Animation Engine
+ * --------------------
+ * Fades, pulses and chases on an LED strip without a hand-written
+ * set_pixel / refresh / vTaskDelay loop per effect.
+ *
+ *  - LAYERS: each client owns a layer over a range of LEDs and PLAYS
+ *    an effect on it. Layers are composited in the order they were
+ *    added (later ones on top, blended by their alpha)
+ *  - EASING: effect progress runs through fixed-point curves (Q16,
+ *    no float): linear, quadratic in / out, cubic in-out, smoothstep
+ *  - 16-BIT FRAME: colours are 8-bit, but fades and the chase are
+ *    rendered with 16 bits per component, so a slow fade at low
+ *    brightness keeps its steps for a dithering stage
+ *  - FRAME CLOCK: one task renders into a frame buffer at the target
+ *    fps (menuconfig → "LED Animation") and hands each frame to the
+ *    push callback: ONE strip refresh per frame
+ *  - DROPPED FRAMES: if the task falls behind, the missed frames are
+ *    skipped and counted; the animations stay on the wall clock
+ *    instead of drifting slower
+ *  - IDLE: when no layer is animating the task sleeps until the next
+ *    play() - a steady strip costs no wakeups
+ *
+ * No GPIO and no led_strip in here: the owner of the strip (e.g.
+ * tower_light) supplies the push callback.
+ *
+ * Console: "anim" shows frame time (min / avg / max), drops and layers.
+ */
+
+typedef struct {
+    uint8_t r, g, b;
+} led_anim_rgb_t;
+
+typedef enum {
+    LED_ANIM_OFF = 0,       // Transparent at once (layers below show)
+    LED_ANIM_SOLID,         // Colour at once
+    LED_ANIM_FADE_IN,       // Current alpha → full over period_ms, then holds
+    LED_ANIM_FADE_OUT,      // Current alpha → transparent over period_ms
+    LED_ANIM_PULSE,         // Transparent → full → transparent every period_ms
+    LED_ANIM_BLINK,         // Full for the first half of period_ms, then off
+    LED_ANIM_CHASE,         // One dot runs first → last LED every period_ms
+} led_anim_effect_t;
+
+typedef enum {
+    LED_ANIM_EASE_LINEAR = 0,
+    LED_ANIM_EASE_IN_QUAD,
+    LED_ANIM_EASE_OUT_QUAD,
+    LED_ANIM_EASE_IN_OUT_CUBIC,
+    LED_ANIM_EASE_SMOOTHSTEP,
+} led_anim_easing_t;
+
+/*
+ * ONE LAYER:
+ *  - Lives in the client (static or instance struct)
+ *  - Must stay valid until led_anim_remove()
+ *  - Fields are owned by the engine, use led_anim_play()
+ */
+typedef struct {
+    uint16_t first;
+    uint16_t count;
+    const char *name;
+    uint8_t effect;             // led_anim_effect_t
+    uint8_t easing;             // led_anim_easing_t
+    led_anim_rgb_t color;
+    uint16_t from_alpha;        // FADE_*: alpha (Q16) when the fade started
+    uint32_t period_ms;
+    uint32_t start_ms;          // Frame clock time of play()
+} led_anim_layer_t;
+
+/*
+ * @brief Receives every finished frame (engine task)
+ *
+ * rgb holds leds * 3 components (R, G, B per LED), 16 bits each
+ * (0..65535). Write them to the strip and refresh once, or hand them
+ * to a dithering stage (led_dither) for an 8-bit strip.
+ */
+typedef void (*led_anim_push_t)(const uint16_t *rgb, uint16_t leds, void *ctx);
+
+/*
+ * @brief Create the engine task for a strip of 'leds' LEDs
+ *
+ * @return ESP_ERR_INVALID_ARG if leds exceeds CONFIG_LED_ANIM_MAX_LEDS,
+ *         ESP_ERR_INVALID_STATE if already started
+ */
+esp_err_t led_anim_start(uint16_t leds, led_anim_push_t push, void *ctx);
+
+/*
+ * @brief Add a layer on top of the existing ones (starts LED_ANIM_OFF)
+ *
+ * @return ESP_ERR_NO_MEM if CONFIG_LED_ANIM_MAX_LAYERS are in use
+ */
+esp_err_t led_anim_add(led_anim_layer_t *layer, uint16_t first, uint16_t count, const char *name);
+
+// Remove a layer; the LEDs below show again from the next frame
+void led_anim_remove(led_anim_layer_t *layer);
+
+/*
+ * @brief Start an effect on a layer (any task)
+ *
+ * Fades start from what the layer shows right now, so switching
+ * effects mid-fade does not jump.
+ */
+void led_anim_play(led_anim_layer_t *layer, led_anim_effect_t effect, led_anim_rgb_t color,
+                   uint32_t period_ms, led_anim_easing_t easing);
+
+/*
+ * @brief Apply an easing curve
+ *
+ * @param t  progress 0 .. 65535 (Q16)
+ * @return eased progress 0 .. 65535
+ */
+uint32_t led_anim_ease(led_anim_easing_t easing, uint32_t t);
+
+// Print frame clock, frame time statistics and layers
+void led_anim_print(void);
+
+// Add the "anim" command
+esp_err_t led_anim_register_console(void);
+
+#endif
@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "led_dither.h"
+#include "led_strip_dither.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "LED_DITHER"
+
+#define LED_DITHER_TASK_STACK     3072
+#define MAX_COMPONENTS            (CONFIG_LED_DITHER_MAX_LEDS * 3)
+#define REFRESH_US                (1000000 / CONFIG_LED_DITHER_FPS)
+// Low bits of the 8-bit fraction that are rounded away (see Kconfig "fraction bits")
+#define FRACTION_DROP             ((1u << (8 - CONFIG_LED_DITHER_FRACTION_BITS)) - 1)
+
+#define BENCH_MIN_LEDS            16
+#define BENCH_MAX_LEDS            512
+#define BENCH_DEFAULT_REFRESHES   2000
+#define YIELD_PERIOD_US           1000000   // Let the idle task run (task watchdog)
+
+static uint16_t levels[MAX_COMPONENTS];   // 8.8 fixed point: 65535 → 255.0
+static uint8_t errors[MAX_COMPONENTS];    // Fraction carried to the next refresh
+static uint8_t output[MAX_COMPONENTS];    // Dithered frame (task only)
+static uint16_t strip_leds = 0;
+static led_dither_push_t push_frame = NULL;
+static void *push_ctx = NULL;
+static bool fractional = false;           // Frame has fractions: keep refreshing
+static bool running = false;              // Refresh timer started
+static SemaphoreHandle_t dither_mutex = NULL;   // Levels + running
+static TaskHandle_t dither_task = NULL;
+static esp_timer_handle_t refresh_timer = NULL;
+
+// Refresh statistics (dithering task writes, console reads)
+typedef struct {
+    uint32_t refreshes;
+    uint32_t missed;
+    uint32_t idle_stops;
+    uint32_t refresh_min_us;
+    uint32_t refresh_max_us;
+    uint64_t refresh_sum_us;    // Dither + push
+    uint64_t dither_sum_us;     // Dither only
+} dither_stats_t;
+
+static dither_stats_t stats = { .refresh_min_us = UINT32_MAX };
+
+/*
+ * THE DITHERING PASS (per component):
+ *  - The step of the led_strip driver (led_strip_dither.h), the same
+ *    one a temporal_dither strip runs in its refresh
+ *  - Level (8.8) + the error carried from the last refresh; integer
+ *    part → output, fraction → error for the next refresh
+ *  - Two adds and a shift, no branch: this is the whole per-LED cost
+ *    of every refresh
+ */
+static void dither_pass(const uint16_t *level, uint8_t *error, uint8_t *rgb, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        rgb[i] = led_strip_dither_step(level[i], &error[i]);
+    }
+}
+
+/*
+ * 16-BIT COMPONENT → 8.8 LEVEL:
+ *  - Driver's level: 65535 is exactly 255.0 (full on never dithers)
+ *  - Fraction rounded to CONFIG_LED_DITHER_FRACTION_BITS; cannot pass
+ *    255.0, which is a multiple of every step
+ */
+static inline uint16_t to_level(uint32_t value)
+{
+    uint32_t level = led_strip_dither_level(value);
+    return (uint16_t)((level + (FRACTION_DROP >> 1)) & ~FRACTION_DROP);
+}
+
+static void refresh_timer_cb(void *arg)
+{
+    xTaskNotifyGive(dither_task);
+}
+
+/*
+ * REFRESH LOOP (dithering task):
+ *  - Woken by the refresh timer, or by a write while the timer is off
+ *  - Frame without fractions: this refresh already shows it exactly,
+ *    so the timer stops until a write brings fractions back
+ *  - More than one wakeup pending → the strip (or the CPU) did not
+ *    keep up; the extra refreshes are counted as missed, not queued
+ */
+static void led_dither_task(void *arg)
+{
+    while (1) {
+        uint32_t wakeups = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (wakeups > 1) {
+            stats.missed += wakeups - 1;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        xSemaphoreTake(dither_mutex, portMAX_DELAY);
+        dither_pass(levels, errors, output, strip_leds * 3);
+        if (!fractional && running) {
+            esp_timer_stop(refresh_timer);
+            running = false;
+            stats.idle_stops++;
+        }
+        xSemaphoreGive(dither_mutex);
+        int64_t dither_us = esp_timer_get_time() - start_us;
+
+        push_frame(output, strip_leds, push_ctx);   // Only this task writes the output
+        uint32_t refresh_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        stats.refreshes++;
+        stats.dither_sum_us += dither_us;
+        stats.refresh_sum_us += refresh_us;
+        if (refresh_us < stats.refresh_min_us) {
+            stats.refresh_min_us = refresh_us;
+        }
+        if (refresh_us > stats.refresh_max_us) {
+            stats.refresh_max_us = refresh_us;
+        }
+    }
+}
+
+esp_err_t led_dither_start(uint16_t leds, led_dither_push_t push, void *ctx)
+{
+    if (dither_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (leds == 0 || leds > CONFIG_LED_DITHER_MAX_LEDS || push == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dither_mutex = xSemaphoreCreateMutex();
+    if (dither_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    strip_leds = leds;
+    push_frame = push;
+    push_ctx = ctx;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = refresh_timer_cb,
+        .name = "led_dither",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &refresh_timer);
+    if (err != ESP_OK) {
+        vSemaphoreDelete(dither_mutex);
+        dither_mutex = NULL;
+        return err;
+    }
+    if (xTaskCreate(led_dither_task, "led_dither", LED_DITHER_TASK_STACK, NULL,
+                    CONFIG_LED_DITHER_TASK_PRIORITY, &dither_task) != pdPASS) {
+        esp_timer_delete(refresh_timer);
+        refresh_timer = NULL;
+        vSemaphoreDelete(dither_mutex);
+        dither_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(dither_task);   // First frame: all LEDs off
+    ESP_LOGI(TAG, "Started: %u LEDs, %d fps, %d fraction bits", leds, CONFIG_LED_DITHER_FPS,
+             CONFIG_LED_DITHER_FRACTION_BITS);
+    return ESP_OK;
+}
+
+/*
+ * WRITE:
+ *  - Converts the whole frame under the mutex: the refresh loop never
+ *    dithers half an old and half a new frame
+ *  - Timer running → the next refresh picks the frame up (at most one
+ *    refresh period late); timer off → one refresh at once, and the
+ *    timer starts only if the frame has fractions to dither
+ */
+esp_err_t led_dither_write(const uint16_t *rgb, uint16_t leds)
+{
+    if (dither_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (leds != strip_leds) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t fraction = 0;
+
+    xSemaphoreTake(dither_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < (uint32_t)leds * 3; i++) {
+        levels[i] = to_level(rgb[i]);
+        fraction |= levels[i] & 0xFF;
+    }
+    fractional = fraction != 0;
+    bool wake = !running;
+    if (fractional && !running) {
+        running = esp_timer_start_periodic(refresh_timer, REFRESH_US) == ESP_OK;
+    }
+    xSemaphoreGive(dither_mutex);
+
+    if (wake) {
+        xTaskNotifyGive(dither_task);
+    }
+    return ESP_OK;
+}
+
+// xorshift32: reproducible, never 0
+static uint32_t bench_rng(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * BENCH:
+ *  - Private buffers (malloc, freed at the end), random 16-bit levels
+ *    through the same conversion as led_dither_write()
+ *  - Only the pass itself is timed, back to back; a pass over a few
+ *    LEDs is shorter than the 1 us timer step, but the average over
+ *    many refreshes holds
+ */
+esp_err_t led_dither_bench(uint32_t leds, uint32_t refreshes, led_dither_bench_result_t *result)
+{
+    if (leds == 0 || refreshes == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t count = leds * 3;
+    uint16_t *bench_levels = malloc(count * sizeof(uint16_t));
+    uint8_t *bench_errors = calloc(count, 1);
+    uint8_t *bench_output = malloc(count);
+    if (bench_levels == NULL || bench_errors == NULL || bench_output == NULL) {
+        free(bench_levels);
+        free(bench_errors);
+        free(bench_output);
+        return ESP_ERR_NO_MEM;
+    }
+    uint32_t rng = 0x2545F491;
+    for (uint32_t i = 0; i < count; i++) {
+        bench_levels[i] = to_level(bench_rng(&rng) & 0xFFFF);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->leds = leds;
+    result->refreshes = refreshes;
+    int64_t yield_us = esp_timer_get_time();
+
+    for (uint32_t r = 0; r < refreshes; r++) {
+        int64_t start_us = esp_timer_get_time();
+        dither_pass(bench_levels, bench_errors, bench_output, count);
+        int64_t pass_us = esp_timer_get_time() - start_us;
+
+        result->total_us += pass_us;
+        if (pass_us > result->max_refresh_us) {
+            result->max_refresh_us = (uint32_t)pass_us;
+        }
+        if ((r & 0xff) == 0 && esp_timer_get_time() - yield_us > YIELD_PERIOD_US) {
+            vTaskDelay(1);
+            yield_us = esp_timer_get_time();
+        }
+    }
+    free(bench_levels);
+    free(bench_errors);
+    free(bench_output);
+    return ESP_OK;
+}
+
+void led_dither_print(void)
+{
+    if (dither_mutex == NULL) {
+        printf("LED dithering not started\n");
+        return;
+    }
+    dither_stats_t s = stats;   // Snapshot; a torn counter only skews one line
+    printf("Dithering: %d fps target, %d fraction bits, %u LEDs, %s\n", CONFIG_LED_DITHER_FPS,
+           CONFIG_LED_DITHER_FRACTION_BITS, strip_leds, running ? "refreshing" : "idle (steady frame)");
+    printf("Refreshes: %lu pushed, %lu missed, %lu idle stops\n", (unsigned long)s.refreshes,
+           (unsigned long)s.missed, (unsigned long)s.idle_stops);
+    if (s.refreshes > 0) {
+        printf("Refresh time: min %lu us, avg %lu us (dither %lu us), max %lu us\n",
+               (unsigned long)s.refresh_min_us, (unsigned long)(s.refresh_sum_us / s.refreshes),
+               (unsigned long)(s.dither_sum_us / s.refreshes), (unsigned long)s.refresh_max_us);
+    }
+}
+
+static int cmd_dither(int argc, char **argv)
+{
+    led_dither_print();
+    return 0;
+}
+
+// ditherbench [refreshes]
+static int cmd_ditherbench(int argc, char **argv)
+{
+    uint32_t refreshes = BENCH_DEFAULT_REFRESHES;
+    if (argc > 1) {
+        char *end;
+        refreshes = strtoul(argv[1], &end, 0);
+        if (*argv[1] == '\0' || *end != '\0') {
+            printf("'%s' is not a number\n", argv[1]);
+            return 1;
+        }
+    }
+
+    printf("    LEDs  refreshes  us/refresh  max us  ns/LED  CPU-bound fps\n");
+    for (uint32_t leds = BENCH_MIN_LEDS; leds <= BENCH_MAX_LEDS; leds *= 2) {
+        led_dither_bench_result_t r;
+        esp_err_t err = led_dither_bench(leds, refreshes, &r);
+        if (err != ESP_OK) {
+            printf("%8lu  failed: %s\n", (unsigned long)leds, esp_err_to_name(err));
+            return 1;
+        }
+        int64_t ns_per_refresh = r.total_us * 1000 / r.refreshes;
+        printf("%8lu  %9lu  %7lld.%02lld  %6lu  %6lld  %13lld\n", (unsigned long)r.leds,
+               (unsigned long)r.refreshes, (long long)(ns_per_refresh / 1000),
+               (long long)(ns_per_refresh % 1000 / 10), (unsigned long)r.max_refresh_us,
+               (long long)(ns_per_refresh / r.leds),
+               ns_per_refresh > 0 ? (long long)(1000000000LL / ns_per_refresh) : 0LL);
+    }
+    printf("Wire time comes on top: WS2812 needs 30 us per LED per refresh\n");
+    return 0;
+}
+
+esp_err_t led_dither_register_console(void)
+{
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "dither",
+            .help = "Show LED dithering refresh rate, refresh time and missed refreshes",
+            .hint = NULL,
+            .func = &cmd_dither,
+        },
+        {
+            .command = "ditherbench",
+            .help = "Time the dithering pass for 16..512 LEDs (default 2000 refreshes)",
+            .hint = "[refreshes]",
+            .func = &cmd_ditherbench,
+        },
+    };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        esp_err_t err = esp_console_cmd_register(&commands[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,85 @@
+#ifndef LED_DITHER_H
+#define LED_DITHER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Temporal Dithering Engine
+ * -------------------------
+ * At panel brightness (the tower light runs at 64 of 255) an 8-bit
+ * strip has only a few dozen levels left, and a slow fade visibly
+ * steps from one to the next.
+ *
+ * This stage sits between a 16-bit frame and the 8-bit strip:
+ *  - FRAME: the producer (e.g. led_anim's push callback) writes the
+ *    whole frame, 16 bits per component
+ *  - ERROR ACCUMULATORS: every component keeps the fraction its 8-bit
+ *    output was short by (fixed point), added to the next refresh, so
+ *    the average over a few refreshes is the 16-bit level
+ *  - REFRESH LOOP: own task at a fixed high rate (menuconfig →
+ *    "LED Dithering", default 200 fps), paced by esp_timer since the
+ *    100 Hz RTOS tick cannot go that fast
+ *  - IDLE: a frame with no fractions left looks the same every
+ *    refresh; it is pushed once and the loop stops until the next
+ *    write - a steady strip costs no wakeups
+ *
+ * The per-component step is the led_strip driver's own (see
+ * led_strip_dither.h), so a frame looks the same dithered here or on a
+ * temporal_dither strip. No GPIO and no strip handle in here: the
+ * owner of the strip supplies the push callback, which gets 8-bit
+ * R, G, B per LED.
+ *
+ * Console: "dither" shows rate and refresh time, "ditherbench" times
+ * the dithering pass itself (also on the Linux target: host numbers).
+ */
+
+/*
+ * @brief Receives every dithered frame (dithering task)
+ *
+ * rgb holds leds * 3 bytes (R, G, B per LED). Write them to the strip
+ * and refresh once.
+ */
+typedef void (*led_dither_push_t)(const uint8_t *rgb, uint16_t leds, void *ctx);
+
+// Result of one benchmark row (led_dither_bench)
+typedef struct {
+    uint32_t leds;
+    uint32_t refreshes;
+    int64_t total_us;           // Time spent inside the dithering passes only
+    uint32_t max_refresh_us;
+} led_dither_bench_result_t;
+
+/*
+ * @brief Create the dithering task for a strip of 'leds' LEDs
+ *
+ * @return ESP_ERR_INVALID_ARG if leds exceeds CONFIG_LED_DITHER_MAX_LEDS,
+ *         ESP_ERR_INVALID_STATE if already started
+ */
+esp_err_t led_dither_start(uint16_t leds, led_dither_push_t push, void *ctx);
+
+/*
+ * @brief Replace the frame (any task)
+ *
+ * @param rgb   leds * 3 components (R, G, B per LED), 0..65535
+ * @param leds  must match led_dither_start()
+ */
+esp_err_t led_dither_write(const uint16_t *rgb, uint16_t leds);
+
+/*
+ * @brief Time the dithering pass for a number of LEDs
+ *
+ * Runs the same pass as the refresh loop over a private frame with
+ * random levels (no push, no strip). Refreshes are back to back: the
+ * result is CPU cost only, the strip wire time comes on top.
+ */
+esp_err_t led_dither_bench(uint32_t leds, uint32_t refreshes, led_dither_bench_result_t *result);
+
+// Print refresh rate, refresh time statistics and state
+void led_dither_print(void);
+
+// Add the "dither" and "ditherbench" commands
+esp_err_t led_dither_register_console(void);
+
+#endif
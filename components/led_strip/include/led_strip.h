@@ -0,0 +1,249 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_rmt.h"
+#include "led_strip_spi.h"
+#include "led_strip_virtual.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set RGB for a specific pixel
+ *
+ * @note On strips with a white component, the white part is taken out of the color according to `rgbw_mode`
+ *       in `led_strip_config_t`, or written as 0 if white extraction is not enabled
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ *
+ * @return
+ *      - ESP_OK: Set RGB for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for a specific pixel failed because of invalid parameters
+ *      - ESP_FAIL: Set RGB for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+
+/**
+ * @brief Set RGBW for a specific pixel
+ *
+ * @note Only call this function if your led strip does have the white component (e.g. SK6812-RGBW)
+ * @note Also see `led_strip_set_pixel` if you only want to specify the RGB part of the color and bypass the white component
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ * @param white: separate white component
+ *
+ * @return
+ *      - ESP_OK: Set RGBW color for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGBW color for a specific pixel failed because of an invalid argument
+ *      - ESP_FAIL: Set RGBW color for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
+
+/**
+ * @brief Set RGB for a specific pixel, with 16-bit color components
+ *
+ * @note On 16-bit strips the value is sent as is. On 8-bit strips it is dithered over successive refreshes if
+ *       `temporal_dither` is set in `led_strip_config_t`, or rounded to 8 bits otherwise
+ * @note White extraction (`rgbw_mode`) applies as for `led_strip_set_pixel`
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color (0 - 65535)
+ * @param green: green part of color (0 - 65535)
+ * @param blue: blue part of color (0 - 65535)
+ *
+ * @return
+ *      - ESP_OK: Set RGB for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for a specific pixel failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: The backend has no 16-bit pixel path
+ *      - ESP_FAIL: Set RGB for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_16(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+
+/**
+ * @brief Set RGBW for a specific pixel, with 16-bit color components
+ *
+ * @note Only call this function if your led strip does have the white component
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param red: red part of color (0 - 65535)
+ * @param green: green part of color (0 - 65535)
+ * @param blue: blue part of color (0 - 65535)
+ * @param white: separate white component (0 - 65535)
+ *
+ * @return
+ *      - ESP_OK: Set RGBW color for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGBW color for a specific pixel failed because of an invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: The backend has no 16-bit pixel path
+ *      - ESP_FAIL: Set RGBW color for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_rgbw_16(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
+
+/**
+ * @brief Set HSV for a specific pixel
+ *
+ * @param strip: LED strip
+ * @param index: index of pixel to set
+ * @param hue: hue part of color (0 - 360)
+ * @param saturation: saturation part of color (0 - 255, rescaled from 0 - 1. e.g. saturation = 0.5, rescaled to 127)
+ * @param value: value part of color (0 - 255, rescaled from 0 - 1. e.g. value = 0.5, rescaled to 127)
+ *
+ * @return
+ *      - ESP_OK: Set HSV color for a specific pixel successfully
+ *      - ESP_ERR_INVALID_ARG: Set HSV color for a specific pixel failed because of an invalid argument
+ *      - ESP_FAIL: Set HSV color for a specific pixel failed because other error occurred
+ */
+esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value);
+
+/**
+ * @brief Refresh memory colors to LEDs
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ *
+ * @note:
+ *      After updating the LED colors in the memory, a following invocation of this API is needed to flush colors to strip.
+ */
+esp_err_t led_strip_refresh(led_strip_handle_t strip);
+
+/**
+ * @brief Start sending memory colors to LEDs and return without waiting for the transfer
+ *
+ * @note Refreshing several strips this way lets their transfers run at the same time. Do not change pixels of
+ *       the strip until `led_strip_refresh_wait_done` has returned, the transfer reads them from memory.
+ *       Backends that can only refresh synchronously refresh here, `led_strip_refresh_wait_done` then returns at once.
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Transfer started successfully
+ *      - ESP_ERR_INVALID_STATE: The previous transfer has not been waited for
+ *      - ESP_FAIL: Transfer failed to start because some other error occurred
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+
+/**
+ * @brief Wait for the transfer started by `led_strip_refresh_async` to finish
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Transfer finished
+ *      - ESP_ERR_INVALID_STATE: No transfer was started
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip);
+
+/**
+ * @brief Clear LED strip (turn off all LEDs)
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Clear LEDs successfully
+ *      - ESP_FAIL: Clear LEDs failed because some other error occurred
+ */
+esp_err_t led_strip_clear(led_strip_handle_t strip);
+
+/**
+ * @brief Free LED strip resources
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Free resources successfully
+ *      - ESP_FAIL: Free resources failed because error occurred
+ */
+esp_err_t led_strip_del(led_strip_handle_t strip);
+
+/**
+ * @brief Get direct access to the pixels of a strip, for render loops that write every pixel of every frame
+ *
+ * @note Writes to the frame skip the argument checks and the call into the backend of `led_strip_set_pixel`,
+ *       and white extraction (`rgbw_mode`). The frame stays valid until the strip is deleted. Send it with
+ *       `led_strip_commit_frame` (or `led_strip_refresh_async`), and do not write to it while a transfer started
+ *       by `led_strip_refresh_async` is running.
+ *
+ * @note 8-bit RMT strips hand out their transmit buffer (`pixels_8`), strips with `flags.temporal_dither` their
+ *       16-bit frame (`pixels_16`). The SPI backend keeps 8-bit pixels in its bit code and 16-bit strips keep them
+ *       in wire byte order, so those and virtual strips return ESP_ERR_NOT_SUPPORTED.
+ *
+ * @param strip: LED strip
+ * @param frame: returned frame layout
+ *
+ * @return
+ *      - ESP_OK: Frame returned
+ *      - ESP_ERR_INVALID_ARG: Get frame failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: The strip has no directly writable frame, use `led_strip_set_pixel`
+ */
+esp_err_t led_strip_get_frame(led_strip_handle_t strip, led_strip_frame_t *frame);
+
+/**
+ * @brief Send the pixels written to the frame of `led_strip_get_frame` to the LEDs
+ *
+ * @note Same as `led_strip_refresh`: dithered strips convert their 16-bit frame here.
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_commit_frame(led_strip_handle_t strip);
+
+/**
+ * @brief Write a pixel of an 8-bit frame, inline and without any checks
+ *
+ * @param frame: frame from `led_strip_get_frame` with `component_width` `LED_STRIP_COMPONENT_WIDTH_8`
+ * @param index: index of pixel to set, below `num_pixels`
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ */
+static inline void led_strip_frame_set_pixel(const led_strip_frame_t *frame, uint32_t index, uint8_t red, uint8_t green, uint8_t blue)
+{
+    uint8_t *pixel = frame->pixels_8 + index * frame->num_components;
+    pixel[frame->r_pos] = red;
+    pixel[frame->g_pos] = green;
+    pixel[frame->b_pos] = blue;
+}
+
+/**
+ * @brief Write a pixel of a 16-bit frame, inline and without any checks
+ *
+ * @param frame: frame from `led_strip_get_frame` with `component_width` `LED_STRIP_COMPONENT_WIDTH_16`
+ * @param index: index of pixel to set, below `num_pixels`
+ * @param red: red part of color (0 - 65535)
+ * @param green: green part of color (0 - 65535)
+ * @param blue: blue part of color (0 - 65535)
+ */
+static inline void led_strip_frame_set_pixel_16(const led_strip_frame_t *frame, uint32_t index, uint16_t red, uint16_t green, uint16_t blue)
+{
+    uint16_t *pixel = frame->pixels_16 + index * frame->num_components;
+    pixel[frame->r_pos] = red;
+    pixel[frame->g_pos] = green;
+    pixel[frame->b_pos] = blue;
+}
+
+#ifdef __cplusplus
+}
+#endif
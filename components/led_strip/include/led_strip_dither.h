@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 8.8 fixed point level of a 16-bit color component, scaled so that 65535 is exactly 255.0
+ *
+ * @note A level without fraction (value a multiple of 257) shows the same 8-bit output on every refresh.
+ */
+static inline uint32_t led_strip_dither_level(uint32_t value)
+{
+    return value - (value >> 8);
+}
+
+/**
+ * @brief Next 8-bit output of a dithered component
+ *
+ * @param level 8.8 fixed point level, see `led_strip_dither_level`
+ * @param error Fraction carried over from the last refresh, updated for the next one
+ *
+ * @note Used by the driver for strips with `flags.temporal_dither`. Exposed for code that dithers its own
+ *       16-bit frames, so both see the same output: the average over 256 refreshes is the level.
+ */
+static inline uint8_t led_strip_dither_step(uint32_t level, uint8_t *error)
+{
+    uint32_t sum = level + *error;
+    *error = sum & 0xFF;
+    return sum >> 8;
+}
+
+#ifdef __cplusplus
+}
+#endif
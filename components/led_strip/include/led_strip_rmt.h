@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+#include "esp_idf_version.h"
+#include "driver/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LED Strip RMT specific configuration
+ */
+typedef struct {
+    rmt_clock_source_t clk_src; /*!< RMT clock source */
+    uint32_t resolution_hz;     /*!< RMT tick resolution, if set to zero, a default resolution (10MHz) will be applied */
+    size_t mem_block_symbols;   /*!< How many RMT symbols can one RMT channel hold at one time. Set to 0 will fallback to use the default size. */
+    /*!< Extra RMT specific driver flags */
+    struct led_strip_rmt_extra_config {
+        uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+    } flags;                    /*!< Extra driver flags */
+} led_strip_rmt_config_t;
+
+/**
+ * @brief Create LED strip based on RMT TX channel
+ *
+ * @param led_config LED strip configuration
+ * @param rmt_config RMT specific configuration
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because of out of memory
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief Upper bound of the RMT driver object, the part of the static storage in front of the transmit buffer
+ *
+ * @note Checked against the real object size when the driver is built
+ */
+#define LED_STRIP_RMT_OBJ_SIZE (32 * sizeof(void *))
+
+/**
+ * @brief Bytes of static storage `led_strip_rmt_init_static` needs for a strip
+ *
+ * @param max_leds Number of LEDs (`led_strip_config_t::max_leds`)
+ * @param num_components 3 (RGB) or 4 (RGBW)
+ * @param width Component width, `LED_STRIP_COMPONENT_WIDTH_8` or `LED_STRIP_COMPONENT_WIDTH_16`
+ * @param temporal_dither Nonzero if `flags.temporal_dither` is set
+ * @note A constant expression, usable as an array size.
+ */
+#define LED_STRIP_RMT_STATIC_SIZE(max_leds, num_components, width, temporal_dither)           \
+    (LED_STRIP_RMT_OBJ_SIZE + (max_leds) * LED_STRIP_BYTES_PER_PIXEL(num_components, width) + \
+     ((temporal_dither) ? LED_STRIP_DITHER_STORAGE_SIZE(max_leds, num_components) : 0))
+
+/**
+ * @brief Create LED strip based on RMT TX channel, in caller provided storage instead of the heap
+ *
+ * @note Nothing is allocated: creating and deleting the strip only sets up and releases the peripheral.
+ *       `led_strip_del` does not free the storage, which must stay valid until then.
+ *
+ * @param led_config LED strip configuration
+ * @param rmt_config RMT specific configuration
+ * @param storage Storage for the driver object and its buffers, declared with `LED_STRIP_STATIC_STORAGE`
+ * @param storage_size Size of `storage` in bytes, at least `LED_STRIP_RMT_STATIC_SIZE` for the strip
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument or unsuitable storage
+ *      - ESP_ERR_INVALID_SIZE: create LED strip handle failed because the storage is too small
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_rmt_init_static(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                    void *storage, size_t storage_size, led_strip_handle_t *ret_strip);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/spi_master.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LED Strip SPI specific configuration
+ */
+typedef struct {
+    spi_clock_source_t clk_src; /*!< SPI clock source */
+    spi_host_device_t spi_bus;  /*!< SPI bus ID. Which buses are available depends on the specific chip */
+    struct {
+        uint32_t with_dma: 1;   /*!< Use DMA to transmit data. With `shared_bus`, the DMA channel is chosen when the bus is initialized,
+                                     this flag then only places the pixel buffer in DMA capable memory */
+        uint32_t shared_bus: 1; /*!< Attach to a bus the application has initialized with `spi_bus_initialize` (MOSI may be -1),
+                                     which can carry more strips and other devices. The strip adds only its own device and
+                                     switches MOSI to `strip_gpio_num` for the length of its own transactions.
+                                     The bus `max_transfer_sz` must cover `max_leds` * bytes per pixel * 3 */
+    } flags;                    /*!< Extra driver flags */
+} led_strip_spi_config_t;
+
+/**
+ * @brief Create LED strip based on SPI MOSI channel
+ *
+ * @note Although only the MOSI line is used for generating the signal, the whole SPI bus can't be used for other purposes,
+ *       unless `flags.shared_bus` is set. Strips sharing a bus are sent one after the other; start them with
+ *       `led_strip_refresh_async` to keep the bus busy back to back.
+ *
+ * @param led_config LED strip configuration
+ * @param spi_config SPI specific configuration
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_NOT_SUPPORTED: create LED strip handle failed because of unsupported configuration
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because of out of memory
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief Upper bound of the SPI driver object, the part of the static storage in front of the transmit buffer
+ *
+ * @note Checked against the real object size when the driver is built
+ */
+#define LED_STRIP_SPI_OBJ_SIZE (48 * sizeof(void *))
+
+/**
+ * @brief Bytes of static storage `led_strip_spi_init_static` needs for a strip
+ *
+ * @param max_leds Number of LEDs (`led_strip_config_t::max_leds`)
+ * @param num_components 3 (RGB) or 4 (RGBW)
+ * @param width Component width, `LED_STRIP_COMPONENT_WIDTH_8` or `LED_STRIP_COMPONENT_WIDTH_16`
+ * @param temporal_dither Nonzero if `flags.temporal_dither` is set
+ * @note A constant expression, usable as an array size.
+ *       Every transmit buffer byte is sent as 3 SPI bytes, hence the factor 3.
+ */
+#define LED_STRIP_SPI_STATIC_SIZE(max_leds, num_components, width, temporal_dither)               \
+    (LED_STRIP_SPI_OBJ_SIZE + (max_leds) * LED_STRIP_BYTES_PER_PIXEL(num_components, width) * 3 + \
+     ((temporal_dither) ? LED_STRIP_DITHER_STORAGE_SIZE(max_leds, num_components) : 0))
+
+/**
+ * @brief Create LED strip based on SPI MOSI channel, in caller provided storage instead of the heap
+ *
+ * @note Nothing is allocated: creating and deleting the strip only sets up and releases the peripheral.
+ *       `led_strip_del` does not free the storage, which must stay valid until then.
+ *       With `flags.with_dma`, the storage must be DMA capable internal RAM (static data is, by default).
+ *
+ * @param led_config LED strip configuration
+ * @param spi_config SPI specific configuration
+ * @param storage Storage for the driver object and its buffers, declared with `LED_STRIP_STATIC_STORAGE`
+ * @param storage_size Size of `storage` in bytes, at least `LED_STRIP_SPI_STATIC_SIZE` for the strip
+ * @param ret_strip Returned LED strip handle
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument or unsuitable storage
+ *      - ESP_ERR_INVALID_SIZE: create LED strip handle failed because the storage is too small
+ *      - ESP_ERR_NOT_SUPPORTED: create LED strip handle failed because of unsupported configuration
+ *      - ESP_FAIL: create LED strip handle failed because some other error
+ */
+esp_err_t led_strip_spi_init_static(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config,
+                                    void *storage, size_t storage_size, led_strip_handle_t *ret_strip);
+
+#ifdef __cplusplus
+}
+#endif
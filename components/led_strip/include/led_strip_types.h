@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of LED strip handle
+ */
+typedef struct led_strip_t *led_strip_handle_t;
+
+/**
+ * @brief LED strip model
+ * @note Different led model may have different timing parameters, so we need to distinguish them.
+ */
+typedef enum {
+    LED_MODEL_WS2812, /*!< LED strip model: WS2812 */
+    LED_MODEL_SK6812, /*!< LED strip model: SK6812 */
+    LED_MODEL_WS2811, /*!< LED strip model: WS2811 */
+    LED_MODEL_INVALID /*!< Invalid LED strip model */
+} led_model_t;
+
+/**
+ * @brief Bits per color component, as sent to the LED
+ * @note Components wider than 8 bits are sent MSB first, so a 16-bit component takes two bytes on the wire.
+ */
+typedef enum {
+    LED_STRIP_COMPONENT_WIDTH_8 = 0,  /*!< 8 bits per color component (e.g. WS2812, SK6812) */
+    LED_STRIP_COMPONENT_WIDTH_16 = 1, /*!< 16 bits per color component (e.g. UCS8903, UCS8904) */
+} led_strip_component_width_t;
+
+/**
+ * @brief LED color component format
+ * @note The format is used to specify the order of color components in each pixel, also the number of color components.
+ */
+typedef union {
+    struct format_layout {
+        uint32_t r_pos: 2;          /*!< Position of the red channel in the color order: 0~3 */
+        uint32_t g_pos: 2;          /*!< Position of the green channel in the color order: 0~3 */
+        uint32_t b_pos: 2;          /*!< Position of the blue channel in the color order: 0~3 */
+        uint32_t w_pos: 2;          /*!< Position of the white channel in the color order: 0~3 */
+        uint32_t width: 2;          /*!< Bits per color component, see `led_strip_component_width_t`. If set to 0, it is 8 bits */
+        uint32_t reserved: 19;      /*!< Reserved */
+        uint32_t num_components: 3; /*!< Number of color components per pixel: 3 or 4. If set to 0, it will fallback to 3 */
+    } format;                       /*!< Format layout */
+    uint32_t format_id;             /*!< Format ID */
+} led_color_component_format_t;
+
+/// Helper macros to set the color component format
+#define LED_STRIP_COLOR_COMPONENT_FMT_GRB (led_color_component_format_t){.format = {.r_pos = 1, .g_pos = 0, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 3}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_GRBW (led_color_component_format_t){.format = {.r_pos = 1, .g_pos = 0, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 4}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_RGB (led_color_component_format_t){.format = {.r_pos = 0, .g_pos = 1, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 3}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_RGBW (led_color_component_format_t){.format = {.r_pos = 0, .g_pos = 1, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 4}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_RGB16 (led_color_component_format_t){.format = {.r_pos = 0, .g_pos = 1, .b_pos = 2, .w_pos = 3, .width = LED_STRIP_COMPONENT_WIDTH_16, .reserved = 0, .num_components = 3}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_RGBW16 (led_color_component_format_t){.format = {.r_pos = 0, .g_pos = 1, .b_pos = 2, .w_pos = 3, .width = LED_STRIP_COMPONENT_WIDTH_16, .reserved = 0, .num_components = 4}}
+
+/**
+ * @brief Automatic white extraction for RGBW strips
+ * @note Used by `led_strip_set_pixel` (and `led_strip_set_pixel_hsv`) on 4-component strips only.
+ *       `led_strip_set_pixel_rgbw` always writes the white value given by the caller.
+ */
+typedef enum {
+    LED_STRIP_RGBW_NONE,       /*!< White channel is written as 0 (default) */
+    LED_STRIP_RGBW_MIN,        /*!< White = min(R, G, B), subtracted from each color channel */
+    LED_STRIP_RGBW_COLOR_TEMP, /*!< White LED color from `white_temp_k`: white is scaled per channel so the mix keeps the requested hue */
+} led_strip_rgbw_mode_t;
+
+/**
+ * @brief LED Strip common configurations
+ *        The common configurations are not specific to any backend peripheral.
+ */
+typedef struct {
+    int strip_gpio_num;           /*!< GPIO number that used by LED strip */
+    uint32_t max_leds;            /*!< Maximum number of LEDs that can be controlled in a single strip */
+    led_model_t led_model;        /*!< Specifies the LED strip model (e.g., WS2812, SK6812) */
+    led_color_component_format_t color_component_format; /*!< Specifies the order of color components in each pixel.
+                                                              Use helper macros like `LED_STRIP_COLOR_COMPONENT_FMT_GRB` to set the format */
+    led_strip_rgbw_mode_t rgbw_mode; /*!< White extraction in `led_strip_set_pixel` for 4-component formats */
+    uint16_t white_temp_k;        /*!< Color temperature of the white LED in Kelvin (2700~6500) for `LED_STRIP_RGBW_COLOR_TEMP`.
+                                       If set to 0, the white LED is treated as neutral (same result as `LED_STRIP_RGBW_MIN`) */
+    /*!< LED strip extra driver flags */
+    struct led_strip_extra_flags {
+        uint32_t invert_out: 1; /*!< Invert output signal */
+        uint32_t temporal_dither: 1; /*!< 8-bit strips only: keep a 16-bit frame for `led_strip_set_pixel_16` and dither it
+                                          down to 8 bits on every refresh. Costs 3 extra bytes per color component */
+    } flags; /*!< Extra driver flags */
+} led_strip_config_t;
+
+/**
+ * @brief Direct access to the pixels of a strip, see `led_strip_get_frame`
+ *
+ * @note Pixel `i` starts at component `i * num_components`, its components sit at `r_pos`, `g_pos`, `b_pos`
+ *       and `w_pos` from there.
+ */
+typedef struct {
+    union {
+        uint8_t *pixels_8;    /*!< 8-bit components, `component_width` is `LED_STRIP_COMPONENT_WIDTH_8` */
+        uint16_t *pixels_16;  /*!< 16-bit components in CPU byte order, `component_width` is `LED_STRIP_COMPONENT_WIDTH_16` */
+    };
+    uint32_t num_pixels;      /*!< Number of pixels in the frame */
+    uint8_t num_components;   /*!< Number of color components per pixel: 3 or 4 */
+    uint8_t r_pos;            /*!< Position of the red component in a pixel */
+    uint8_t g_pos;            /*!< Position of the green component in a pixel */
+    uint8_t b_pos;            /*!< Position of the blue component in a pixel */
+    uint8_t w_pos;            /*!< Position of the white component in a pixel (4-component strips only) */
+    led_strip_component_width_t component_width; /*!< Width of the components in the frame */
+} led_strip_frame_t;
+
+/**
+ * @brief Bytes one LED takes in the transmit buffer, before any backend specific encoding
+ *
+ * @param num_components 3 (RGB) or 4 (RGBW)
+ * @param width Component width, `LED_STRIP_COMPONENT_WIDTH_8` or `LED_STRIP_COMPONENT_WIDTH_16`
+ */
+#define LED_STRIP_BYTES_PER_PIXEL(num_components, width) ((num_components) * ((width) == LED_STRIP_COMPONENT_WIDTH_16 ? 2 : 1))
+
+/**
+ * @brief Bytes a strip with `flags.temporal_dither` set keeps after its transmit buffer (16-bit frame and fractions)
+ *
+ * @note One spare byte keeps the 16-bit frame aligned, whatever the transmit buffer size
+ */
+#define LED_STRIP_DITHER_STORAGE_SIZE(max_leds, num_components) ((max_leds) * (num_components) * (sizeof(uint16_t) + sizeof(uint8_t)) + 1)
+
+/**
+ * @brief Declare an array of `size` bytes, 8-byte aligned for the `*_init_static` functions, e.g.
+ *        `static LED_STRIP_STATIC_STORAGE(s_strip_storage, LED_STRIP_RMT_STATIC_SIZE(12, 3, LED_STRIP_COMPONENT_WIDTH_8, 0));`
+ */
+#define LED_STRIP_STATIC_STORAGE(name, size) uint64_t name[((size) + sizeof(uint64_t) - 1) / sizeof(uint64_t)]
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One piece of a virtual strip: a range of LEDs on a physical strip
+ */
+typedef struct {
+    led_strip_handle_t strip;  /*!< Physical strip the segment is on (RMT, SPI or another virtual strip) */
+    uint32_t first;            /*!< First LED of the segment on the physical strip */
+    uint32_t count;            /*!< Number of LEDs in the segment */
+    uint32_t serpentine_width; /*!< Row length of a serpentine (zigzag) matrix, every second row runs backwards.
+                                    A shorter last row (count not a multiple) runs backwards within its own length.
+                                    Set to 0 for a straight segment */
+    /*!< Segment specific flags */
+    struct led_strip_segment_flags {
+        uint32_t reversed: 1;  /*!< The segment is addressed from its last LED to its first */
+    } flags;                   /*!< Segment flags */
+} led_strip_segment_t;
+
+/**
+ * @brief Virtual strip configuration
+ */
+typedef struct {
+    const led_strip_segment_t *segments; /*!< Segments in logical order: pixel 0 of the virtual strip is the first pixel of segments[0] */
+    uint32_t num_segments;               /*!< Number of segments, up to 255 */
+} led_strip_virtual_config_t;
+
+/**
+ * @brief Create a virtual strip that spans segments of one or more physical strips
+ *
+ * @note The pixel map is worked out once here, a pixel write is then one table lookup. Refreshing the virtual strip
+ *       starts the transfers of all physical strips before waiting for any, so they run at the same time.
+ *       The physical strips are not owned: `led_strip_del` on the virtual strip leaves them alone,
+ *       and they must outlive it.
+ *
+ * @param config Virtual strip configuration, the segments are copied into the pixel map
+ * @param ret_strip Returned LED strip handle, used with the same API as a physical strip
+ * @return
+ *      - ESP_OK: create LED strip handle successfully
+ *      - ESP_ERR_INVALID_ARG: create LED strip handle failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: create LED strip handle failed because of out of memory
+ */
+esp_err_t led_strip_new_virtual(const led_strip_virtual_config_t *config, led_strip_handle_t *ret_strip);
+
+/**
+ * @brief Write a range of pixels of a virtual strip
+ *
+ * @note The range is split into runs of consecutive LEDs on one physical strip, written without a map lookup per pixel.
+ *
+ * @param strip Virtual strip
+ * @param start First pixel to write
+ * @param rgb `count` pixels, R, G, B per pixel (0~255)
+ * @param count Number of pixels
+ * @return
+ *      - ESP_OK: Write pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Write pixels failed because of invalid argument, not a virtual strip or a range past its end
+ *      - ESP_FAIL: Write pixels failed because some other error occurred
+ */
+esp_err_t led_strip_virtual_write(led_strip_handle_t strip, uint32_t start, const uint8_t *rgb, uint32_t count);
+
+/**
+ * @brief Same as `led_strip_virtual_write`, with 16-bit color components (0~65535)
+ *
+ * @return
+ *      - ESP_ERR_NOT_SUPPORTED: A physical strip of the range does not support 16-bit pixels
+ *      - Others: see `led_strip_virtual_write`
+ */
+esp_err_t led_strip_virtual_write_16(led_strip_handle_t strip, uint32_t start, const uint16_t *rgb, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+#include "led_strip_dither.h"
+#include "led_strip_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Where the pixel ops of a backend write to, chosen once when the device is created
+ *
+ * @note The backends pass this as a constant to always-inline helpers, so every layout is compiled
+ *       into its own set of pixel ops and the 8-bit path carries no width checks.
+ */
+typedef enum {
+    LED_STRIP_STORE_8,      /*!< 8-bit components, straight into the transmit buffer */
+    LED_STRIP_STORE_16,     /*!< 16-bit components, MSB first, straight into the transmit buffer */
+    LED_STRIP_STORE_DITHER, /*!< 16-bit frame, dithered into the 8-bit transmit buffer on every refresh */
+} led_strip_store_t;
+
+/**
+ * @brief Temporal dithering state of an 8-bit strip
+ *
+ * @note Both arrays use the pixel layout of the transmit buffer: pixel after pixel, components in wire order.
+ */
+typedef struct {
+    uint16_t *frame; /*!< 16-bit color components, NULL if dithering is off */
+    uint8_t *error;  /*!< Fraction carried over to the next refresh, per component (Q8) */
+    uint32_t num;    /*!< Number of color components in the frame */
+} led_strip_dither_t;
+
+/**
+ * @brief Point the dithering state at the storage that follows the transmit buffer
+ *
+ * @param[out] dither Dithering state
+ * @param[in] storage First byte after the transmit buffer, `LED_STRIP_DITHER_STORAGE_SIZE` bytes, zeroed
+ * @param[in] num_components Number of color components in the frame (LEDs * components per LED)
+ */
+static inline void led_strip_dither_attach(led_strip_dither_t *dither, uint8_t *storage, uint32_t num_components)
+{
+    dither->frame = (uint16_t *)(((uintptr_t)storage + 1) & ~(uintptr_t)1);
+    dither->error = (uint8_t *)(dither->frame + num_components);
+    dither->num = num_components;
+}
+
+/**
+ * @brief Round a 16-bit color component to 8 bits (65535 -> 255)
+ */
+static inline uint8_t led_strip_component_to_8(uint32_t value)
+{
+    return ((value + 128) * 255) >> 16;
+}
+
+/**
+ * @brief Next 8-bit output of a dithered 16-bit component
+ */
+static inline uint8_t led_strip_dither_component(uint32_t value, uint8_t *error)
+{
+    return led_strip_dither_step(led_strip_dither_level(value), error);
+}
+
+/**
+ * @brief Dither the 16-bit frame into an 8-bit transmit buffer
+ */
+static inline void led_strip_dither_to_8(led_strip_dither_t *dither, uint8_t *out)
+{
+    for (uint32_t i = 0; i < dither->num; i++) {
+        out[i] = led_strip_dither_component(dither->frame[i], &dither->error[i]);
+    }
+}
+
+/**
+ * @brief Zero the 16-bit frame and the carried-over fractions
+ */
+static inline void led_strip_dither_clear(led_strip_dither_t *dither)
+{
+    for (uint32_t i = 0; i < dither->num; i++) {
+        dither->frame[i] = 0;
+        dither->error[i] = 0;
+    }
+}
+
+/**
+ * @brief Define the 16-bit pixel ops `<prefix>_set_pixel_16_<name>` and `<prefix>_set_pixel_rgbw_16_<name>`
+ *
+ * @note `put` is the backend's always-inline helper:
+ *       put(strip, index, red, green, blue, white, with_white, store), with 16-bit components
+ */
+#define LED_STRIP_DEFINE_PIXEL_OPS_16(prefix, name, put, store)                                                         \
+static esp_err_t prefix##_set_pixel_16_##name(led_strip_t *strip, uint32_t index,                                       \
+                                              uint32_t red, uint32_t green, uint32_t blue)                              \
+{                                                                                                                       \
+    return put(strip, index, red & 0xFFFF, green & 0xFFFF, blue & 0xFFFF, 0, false, store);                             \
+}                                                                                                                       \
+static esp_err_t prefix##_set_pixel_rgbw_16_##name(led_strip_t *strip, uint32_t index,                                  \
+                                                   uint32_t red, uint32_t green, uint32_t blue, uint32_t white)         \
+{                                                                                                                       \
+    return put(strip, index, red & 0xFFFF, green & 0xFFFF, blue & 0xFFFF, white & 0xFFFF, true, store);                 \
+}
+
+/**
+ * @brief Define the 8-bit pixel ops `<prefix>_set_pixel_<name>` and `<prefix>_set_pixel_rgbw_<name>` for a
+ *        store that holds 16-bit components: 8-bit values are widened (255 -> 65535)
+ */
+#define LED_STRIP_DEFINE_PIXEL_OPS_8(prefix, name, put, store)                                                          \
+static esp_err_t prefix##_set_pixel_##name(led_strip_t *strip, uint32_t index,                                          \
+                                           uint32_t red, uint32_t green, uint32_t blue)                                 \
+{                                                                                                                       \
+    return put(strip, index, (red & 0xFF) * 257, (green & 0xFF) * 257, (blue & 0xFF) * 257, 0, false, store);           \
+}                                                                                                                       \
+static esp_err_t prefix##_set_pixel_rgbw_##name(led_strip_t *strip, uint32_t index,                                     \
+                                                uint32_t red, uint32_t green, uint32_t blue, uint32_t white)            \
+{                                                                                                                       \
+    return put(strip, index, (red & 0xFF) * 257, (green & 0xFF) * 257, (blue & 0xFF) * 257, (white & 0xFF) * 257,       \
+               true, store);                                                                                            \
+}
+
+/**
+ * @brief Fill the layout of a frame in pixel buffer order, the caller sets the pointer and the width
+ */
+static inline void led_strip_frame_describe(led_strip_frame_t *frame, led_color_component_format_t fmt, uint32_t num_pixels)
+{
+    frame->num_pixels = num_pixels;
+    frame->num_components = fmt.format.num_components;
+    frame->r_pos = fmt.format.r_pos;
+    frame->g_pos = fmt.format.g_pos;
+    frame->b_pos = fmt.format.b_pos;
+    frame->w_pos = fmt.format.w_pos;
+}
+
+/**
+ * @brief Whether a format is a 3-component strip with the given component order
+ *
+ * @note Used once at device creation to pick a fixed-order pixel op, see `LED_STRIP_DEFINE_PIXEL_OP_FIXED`
+ */
+static inline bool led_strip_is_rgb_order(led_color_component_format_t fmt, uint32_t r_pos, uint32_t g_pos, uint32_t b_pos)
+{
+    return fmt.format.num_components == 3 && fmt.format.r_pos == r_pos && fmt.format.g_pos == g_pos && fmt.format.b_pos == b_pos;
+}
+
+/**
+ * @brief Define the 8-bit pixel op `<prefix>_set_pixel_<name>` for a 3-component 8-bit strip whose component
+ *        order is fixed at compile time
+ *
+ * @note `put` is the backend's always-inline helper: put(strip, index, red, green, blue, r_pos, g_pos, b_pos).
+ *       The positions are constants, so the op stores at fixed offsets: no format fields are loaded and there is
+ *       no 3- or 4-component branch.
+ */
+#define LED_STRIP_DEFINE_PIXEL_OP_FIXED(prefix, name, put, r_pos, g_pos, b_pos)                                         \
+static esp_err_t prefix##_set_pixel_##name(led_strip_t *strip, uint32_t index,                                          \
+                                           uint32_t red, uint32_t green, uint32_t blue)                                 \
+{                                                                                                                       \
+    return put(strip, index, red & 0xFF, green & 0xFF, blue & 0xFF, r_pos, g_pos, b_pos);                               \
+}
+
+#ifdef __cplusplus
+}
+#endif
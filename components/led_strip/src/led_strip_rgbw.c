@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "esp_check.h"
+#include "led_strip_rgbw.h"
+
+#define LED_STRIP_RGBW_TEMP_MIN_K  2700
+#define LED_STRIP_RGBW_TEMP_MAX_K  6500
+#define LED_STRIP_RGBW_TEMP_STEP_K 500
+
+static const char *TAG = "led_strip_rgbw";
+
+// Color of a white LED at full drive: 2700K (warm white), then every 500K from 3000K to 6500K (cool white)
+static const uint8_t s_white_points[][3] = {
+    {255, 169, 87},  // 2700K
+    {255, 180, 107}, // 3000K
+    {255, 196, 137}, // 3500K
+    {255, 209, 163}, // 4000K
+    {255, 219, 186}, // 4500K
+    {255, 228, 206}, // 5000K
+    {255, 236, 224}, // 5500K
+    {255, 243, 239}, // 6000K
+    {255, 249, 253}, // 6500K
+};
+
+static void led_strip_rgbw_white_point(uint16_t temp_k, uint8_t white[3])
+{
+    if (temp_k == 0) {
+        white[0] = white[1] = white[2] = 255;
+        return;
+    }
+    if (temp_k < LED_STRIP_RGBW_TEMP_MIN_K) {
+        temp_k = LED_STRIP_RGBW_TEMP_MIN_K;
+    } else if (temp_k > LED_STRIP_RGBW_TEMP_MAX_K) {
+        temp_k = LED_STRIP_RGBW_TEMP_MAX_K;
+    }
+    // table index and the weight of the next entry, the first interval is 300K wide
+    uint32_t index = 0;
+    uint32_t lo_k = LED_STRIP_RGBW_TEMP_MIN_K;
+    uint32_t span_k = 3000 - LED_STRIP_RGBW_TEMP_MIN_K;
+    if (temp_k >= 3000) {
+        index = 1 + (temp_k - 3000) / LED_STRIP_RGBW_TEMP_STEP_K;
+        lo_k = 3000 + (index - 1) * LED_STRIP_RGBW_TEMP_STEP_K;
+        span_k = LED_STRIP_RGBW_TEMP_STEP_K;
+    }
+    size_t last = sizeof(s_white_points) / sizeof(s_white_points[0]) - 1;
+    if (index >= last) {
+        for (int i = 0; i < 3; i++) {
+            white[i] = s_white_points[last][i];
+        }
+        return;
+    }
+    uint32_t frac = temp_k - lo_k;
+    for (int i = 0; i < 3; i++) {
+        uint32_t lo = s_white_points[index][i];
+        uint32_t hi = s_white_points[index + 1][i];
+        white[i] = (lo * (span_k - frac) + hi * frac + span_k / 2) / span_k;
+    }
+}
+
+esp_err_t led_strip_rgbw_init(led_strip_rgbw_t *rgbw, led_strip_rgbw_mode_t mode, uint16_t white_temp_k)
+{
+    ESP_RETURN_ON_FALSE(rgbw, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(mode <= LED_STRIP_RGBW_COLOR_TEMP, ESP_ERR_INVALID_ARG, TAG, "invalid rgbw mode: %d", mode);
+
+    rgbw->mode = mode;
+    led_strip_rgbw_white_point(mode == LED_STRIP_RGBW_COLOR_TEMP ? white_temp_k : 0, rgbw->white);
+    for (int i = 0; i < 3; i++) {
+        // the white point table has no zero component, so the division is always defined
+        rgbw->white_inv[i] = (255u << 16) / rgbw->white[i];
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_strip_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief White extraction context, kept in each backend object
+ *
+ * @note For `LED_STRIP_RGBW_COLOR_TEMP`, `white` is what the white LED emits at full drive, expressed
+ *       in the strip's own RGB (largest channel = 255), and `white_inv` holds (255 << 16) / white[c],
+ *       so that the per-pixel path uses only multiplications and shifts.
+ */
+typedef struct {
+    led_strip_rgbw_mode_t mode; /*!< Extraction mode */
+    uint8_t white[3];           /*!< White LED color: R, G, B */
+    uint32_t white_inv[3];      /*!< Q16 reciprocal of each white component, scaled by 255 */
+} led_strip_rgbw_t;
+
+/**
+ * @brief Set up the white extraction context from the strip configuration
+ *
+ * @param[out] rgbw White extraction context
+ * @param[in] mode Extraction mode
+ * @param[in] white_temp_k White LED color temperature, 0 for neutral white
+ * @return
+ *      - ESP_ERR_INVALID_ARG for an unknown mode
+ *      - ESP_OK on success
+ */
+esp_err_t led_strip_rgbw_init(led_strip_rgbw_t *rgbw, led_strip_rgbw_mode_t mode, uint16_t white_temp_k);
+
+/**
+ * @brief Split an 8-bit RGB color into R, G, B and white
+ *
+ * @note Called by the backends' set_pixel for every pixel, so it is inline and free of divisions.
+ *       The color channels are updated in place and never wrap below zero.
+ *
+ * @param[in] rgbw White extraction context (mode must not be `LED_STRIP_RGBW_NONE`)
+ * @param[in,out] rgb Color channels: R, G, B (0~255)
+ * @return White channel value (0~255)
+ */
+static inline uint8_t led_strip_rgbw_extract(const led_strip_rgbw_t *rgbw, uint8_t rgb[3])
+{
+    uint32_t white;
+    if (rgbw->mode == LED_STRIP_RGBW_MIN) {
+        white = rgb[0] < rgb[1] ? rgb[0] : rgb[1];
+        white = rgb[2] < white ? rgb[2] : white;
+        rgb[0] -= white;
+        rgb[1] -= white;
+        rgb[2] -= white;
+        return white;
+    }
+
+    // the largest white drive that no channel goes negative with: min(c * 255 / white_c)
+    white = 255;
+    for (int i = 0; i < 3; i++) {
+        uint32_t limit = (rgb[i] * rgbw->white_inv[i]) >> 16;
+        if (limit < white) {
+            white = limit;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        // white * white_c / 255, rounded (x * 257 >> 16 is x / 255 to within 1 for x up to 255 * 255)
+        uint32_t used = (white * rgbw->white[i] * 257 + 0x8000) >> 16;
+        rgb[i] = used < rgb[i] ? rgb[i] - used : 0;
+    }
+    return white;
+}
+
+/**
+ * @brief Same as `led_strip_rgbw_extract`, for 16-bit color components (0~65535)
+ */
+static inline uint16_t led_strip_rgbw_extract_16(const led_strip_rgbw_t *rgbw, uint16_t rgb[3])
+{
+    uint32_t white;
+    if (rgbw->mode == LED_STRIP_RGBW_MIN) {
+        white = rgb[0] < rgb[1] ? rgb[0] : rgb[1];
+        white = rgb[2] < white ? rgb[2] : white;
+        rgb[0] -= white;
+        rgb[1] -= white;
+        rgb[2] -= white;
+        return white;
+    }
+
+    white = 65535;
+    for (int i = 0; i < 3; i++) {
+        uint32_t limit = ((uint64_t)rgb[i] * rgbw->white_inv[i]) >> 16;
+        if (limit < white) {
+            white = limit;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        // 65535 * 255 * 257 + 0x8000 still fits in 32 bits
+        uint32_t used = (white * rgbw->white[i] * 257 + 0x8000) >> 16;
+        rgb[i] = used < rgb[i] ? rgb[i] - used : 0;
+    }
+    return white;
+}
+
+#ifdef __cplusplus
+}
+#endif
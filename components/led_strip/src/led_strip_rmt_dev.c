@@ -0,0 +1,388 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_assert.h"
+#include "driver/rmt_tx.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_pixel.h"
+#include "led_strip_rgbw.h"
+#include "led_strip_rmt_encoder.h"
+
+#define LED_STRIP_RMT_DEFAULT_RESOLUTION 10000000 // 10MHz resolution
+#define LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE 4
+// the memory size of each RMT channel, in words (4 bytes)
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 64
+#else
+#define LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS 48
+#endif
+
+static const char *TAG = "led_strip_rmt";
+
+typedef struct {
+    led_strip_t base;
+    rmt_channel_handle_t rmt_chan;
+    rmt_encoder_handle_t strip_encoder;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    bool static_storage;
+    bool transmitting;
+    led_color_component_format_t component_fmt;
+    led_strip_rgbw_t rgbw;
+    led_strip_dither_t dither;
+    uint8_t pixel_buf[];
+} led_strip_rmt_obj;
+
+ESP_STATIC_ASSERT(sizeof(led_strip_rmt_obj) <= LED_STRIP_RMT_OBJ_SIZE, "LED_STRIP_RMT_OBJ_SIZE is too small for the driver object");
+
+static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint32_t start = index * rmt_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = rmt_strip->pixel_buf;
+
+    if (component_fmt.format.num_components > 3) {
+        uint8_t rgb[3] = {red & 0xFF, green & 0xFF, blue & 0xFF};
+        uint8_t white = 0;
+        if (rmt_strip->rgbw.mode != LED_STRIP_RGBW_NONE) {
+            white = led_strip_rgbw_extract(&rmt_strip->rgbw, rgb);
+        }
+        pixel_buf[start + component_fmt.format.r_pos] = rgb[0];
+        pixel_buf[start + component_fmt.format.g_pos] = rgb[1];
+        pixel_buf[start + component_fmt.format.b_pos] = rgb[2];
+        pixel_buf[start + component_fmt.format.w_pos] = white;
+    } else {
+        pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+        pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+        pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+
+    uint32_t start = index * rmt_strip->bytes_per_pixel;
+    uint8_t *pixel_buf = rmt_strip->pixel_buf;
+
+    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
+    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
+    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    pixel_buf[start + component_fmt.format.w_pos] = white & 0xFF;
+
+    return ESP_OK;
+}
+
+// 3-component 8-bit strip with the component order fixed at compile time, positions are constants in every caller
+__attribute__((always_inline))
+static inline esp_err_t led_strip_rmt_put_fixed(led_strip_t *strip, uint32_t index, uint8_t red, uint8_t green, uint8_t blue,
+                                                const uint32_t r_pos, const uint32_t g_pos, const uint32_t b_pos)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint8_t *pixel = &rmt_strip->pixel_buf[index * 3];
+    pixel[r_pos] = red;
+    pixel[g_pos] = green;
+    pixel[b_pos] = blue;
+    return ESP_OK;
+}
+
+// WS2812 and most other 3-component strips
+LED_STRIP_DEFINE_PIXEL_OP_FIXED(led_strip_rmt, grb, led_strip_rmt_put_fixed, 1, 0, 2)
+LED_STRIP_DEFINE_PIXEL_OP_FIXED(led_strip_rmt, rgb, led_strip_rmt_put_fixed, 0, 1, 2)
+
+// Store a pixel given with 16-bit components, `store` is a constant in every caller (see led_strip_store_t)
+__attribute__((always_inline))
+static inline esp_err_t led_strip_rmt_put_16(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white,
+                                             bool with_white, const led_strip_store_t store)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    uint32_t num_components = component_fmt.format.num_components;
+    ESP_RETURN_ON_FALSE(index < rmt_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!with_white || num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+
+    uint16_t value[4] = {red, green, blue, white};
+    if (!with_white && num_components > 3 && rmt_strip->rgbw.mode != LED_STRIP_RGBW_NONE) {
+        value[3] = led_strip_rgbw_extract_16(&rmt_strip->rgbw, value);
+    }
+    const uint8_t pos[4] = {component_fmt.format.r_pos, component_fmt.format.g_pos, component_fmt.format.b_pos, component_fmt.format.w_pos};
+    uint8_t *pixel = &rmt_strip->pixel_buf[index * rmt_strip->bytes_per_pixel];
+    for (uint32_t i = 0; i < num_components; i++) {
+        switch (store) {
+        case LED_STRIP_STORE_8:
+            pixel[pos[i]] = led_strip_component_to_8(value[i]);
+            break;
+        case LED_STRIP_STORE_16:
+            pixel[2 * pos[i]] = value[i] >> 8;
+            pixel[2 * pos[i] + 1] = value[i] & 0xFF;
+            break;
+        case LED_STRIP_STORE_DITHER:
+            rmt_strip->dither.frame[index * num_components + pos[i]] = value[i];
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+// 8-bit strip: the 8-bit ops above, 16-bit values rounded
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_rmt, b8, led_strip_rmt_put_16, LED_STRIP_STORE_8)
+// 16-bit strip
+LED_STRIP_DEFINE_PIXEL_OPS_8(led_strip_rmt, b16, led_strip_rmt_put_16, LED_STRIP_STORE_16)
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_rmt, b16, led_strip_rmt_put_16, LED_STRIP_STORE_16)
+// 8-bit strip with temporal dithering
+LED_STRIP_DEFINE_PIXEL_OPS_8(led_strip_rmt, dither, led_strip_rmt_put_16, LED_STRIP_STORE_DITHER)
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_rmt, dither, led_strip_rmt_put_16, LED_STRIP_STORE_DITHER)
+
+static esp_err_t led_strip_rmt_get_frame(led_strip_t *strip, led_strip_frame_t *frame)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    if (rmt_strip->dither.frame) {
+        led_strip_frame_describe(frame, rmt_strip->component_fmt, rmt_strip->strip_len);
+        frame->pixels_16 = rmt_strip->dither.frame;
+        frame->component_width = LED_STRIP_COMPONENT_WIDTH_16;
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(rmt_strip->component_fmt.format.width == LED_STRIP_COMPONENT_WIDTH_8, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "16-bit pixels are kept in wire byte order");
+    led_strip_frame_describe(frame, rmt_strip->component_fmt, rmt_strip->strip_len);
+    frame->pixels_8 = rmt_strip->pixel_buf;
+    frame->component_width = LED_STRIP_COMPONENT_WIDTH_8;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh_async(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(!rmt_strip->transmitting, ESP_ERR_INVALID_STATE, TAG, "previous refresh not done");
+    rmt_transmit_config_t tx_conf = {
+        .loop_count = 0,
+    };
+
+    if (rmt_strip->dither.frame) {
+        led_strip_dither_to_8(&rmt_strip->dither, rmt_strip->pixel_buf);
+    }
+
+    ESP_RETURN_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), TAG, "enable RMT channel failed");
+    ESP_GOTO_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
+                                   rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), err, TAG, "transmit pixels by RMT failed");
+    rmt_strip->transmitting = true;
+    return ESP_OK;
+err:
+    rmt_disable(rmt_strip->rmt_chan);
+    return ret;
+}
+
+static esp_err_t led_strip_rmt_refresh_wait_done(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(rmt_strip->transmitting, ESP_ERR_INVALID_STATE, TAG, "no refresh in progress");
+    rmt_strip->transmitting = false;
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "start refresh failed");
+    return led_strip_rmt_refresh_wait_done(strip);
+}
+
+static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    // Write zero to turn off all leds
+    memset(rmt_strip->pixel_buf, 0, rmt_strip->strip_len * rmt_strip->bytes_per_pixel);
+    if (rmt_strip->dither.frame) {
+        led_strip_dither_clear(&rmt_strip->dither);
+    }
+    return led_strip_rmt_refresh(strip);
+}
+
+static esp_err_t led_strip_rmt_del(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    if (rmt_strip->transmitting) {
+        ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_wait_done(strip), TAG, "finish refresh failed");
+    }
+    ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
+    if (!rmt_strip->static_storage) {
+        free(rmt_strip);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Validate the color component format and work out the object size, transmit buffer and dithering state included
+ */
+static esp_err_t led_strip_rmt_get_layout(const led_strip_config_t *led_config, led_color_component_format_t *ret_fmt, size_t *ret_size)
+{
+    led_color_component_format_t component_fmt = led_config->color_component_format;
+    // If R/G/B order is not specified, set default GRB order as fallback
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    // check the validation of the color component format
+    uint8_t mask = 0;
+    if (component_fmt.format.num_components == 3) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x07, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else if (component_fmt.format.num_components == 4) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos) | BIT(component_fmt.format.w_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x0F, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
+    }
+    ESP_RETURN_ON_FALSE(component_fmt.format.width <= LED_STRIP_COMPONENT_WIDTH_16, ESP_ERR_INVALID_ARG, TAG, "invalid component width");
+    bool wide = component_fmt.format.width == LED_STRIP_COMPONENT_WIDTH_16;
+    ESP_RETURN_ON_FALSE(!(wide && led_config->flags.temporal_dither), ESP_ERR_INVALID_ARG, TAG, "temporal dithering is for 8-bit strips only");
+
+    size_t size = sizeof(led_strip_rmt_obj) + led_config->max_leds * LED_STRIP_BYTES_PER_PIXEL(component_fmt.format.num_components, component_fmt.format.width);
+    if (led_config->flags.temporal_dither) {
+        size += LED_STRIP_DITHER_STORAGE_SIZE(led_config->max_leds, component_fmt.format.num_components);
+    }
+    *ret_fmt = component_fmt;
+    *ret_size = size;
+    return ESP_OK;
+}
+
+/**
+ * @brief Set up a zeroed object: white extraction, RMT channel, encoder and pixel ops
+ *
+ * @note On failure, whatever was created is released again, the object memory is left to the caller
+ */
+static esp_err_t led_strip_rmt_setup(led_strip_rmt_obj *rmt_strip, const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                     led_color_component_format_t component_fmt)
+{
+    esp_err_t ret = ESP_OK;
+    bool wide = component_fmt.format.width == LED_STRIP_COMPONENT_WIDTH_16;
+    uint8_t bytes_per_pixel = LED_STRIP_BYTES_PER_PIXEL(component_fmt.format.num_components, component_fmt.format.width);
+    uint32_t num_components = led_config->max_leds * component_fmt.format.num_components;
+    ESP_GOTO_ON_ERROR(led_strip_rgbw_init(&rmt_strip->rgbw, led_config->rgbw_mode, led_config->white_temp_k), err, TAG, "invalid white extraction config");
+    uint32_t resolution = rmt_config->resolution_hz ? rmt_config->resolution_hz : LED_STRIP_RMT_DEFAULT_RESOLUTION;
+
+    // for backward compatibility, if the user does not set the clk_src, use the default value
+    rmt_clock_source_t clk_src = RMT_CLK_SRC_DEFAULT;
+    if (rmt_config->clk_src) {
+        clk_src = rmt_config->clk_src;
+    }
+    size_t mem_block_symbols = LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
+    // override the default value if the user sets it
+    if (rmt_config->mem_block_symbols) {
+        mem_block_symbols = rmt_config->mem_block_symbols;
+    }
+    rmt_tx_channel_config_t rmt_chan_config = {
+        .clk_src = clk_src,
+        .gpio_num = led_config->strip_gpio_num,
+        .mem_block_symbols = mem_block_symbols,
+        .resolution_hz = resolution,
+        .trans_queue_depth = LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE,
+        .flags.with_dma = rmt_config->flags.with_dma,
+        .flags.invert_out = led_config->flags.invert_out,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&rmt_chan_config, &rmt_strip->rmt_chan), err, TAG, "create RMT TX channel failed");
+
+    led_strip_encoder_config_t strip_encoder_conf = {
+        .resolution = resolution,
+        .led_model = led_config->led_model
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
+
+    rmt_strip->component_fmt = component_fmt;
+    rmt_strip->bytes_per_pixel = bytes_per_pixel;
+    rmt_strip->strip_len = led_config->max_leds;
+    if (wide) {
+        rmt_strip->base.set_pixel = led_strip_rmt_set_pixel_b16;
+        rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw_b16;
+        rmt_strip->base.set_pixel_16 = led_strip_rmt_set_pixel_16_b16;
+        rmt_strip->base.set_pixel_rgbw_16 = led_strip_rmt_set_pixel_rgbw_16_b16;
+    } else if (led_config->flags.temporal_dither) {
+        led_strip_dither_attach(&rmt_strip->dither, rmt_strip->pixel_buf + led_config->max_leds * bytes_per_pixel, num_components);
+        rmt_strip->base.set_pixel = led_strip_rmt_set_pixel_dither;
+        rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw_dither;
+        rmt_strip->base.set_pixel_16 = led_strip_rmt_set_pixel_16_dither;
+        rmt_strip->base.set_pixel_rgbw_16 = led_strip_rmt_set_pixel_rgbw_16_dither;
+    } else {
+        // GRB and RGB get a pixel op with the component order compiled in, any other format looks it up per pixel
+        if (led_strip_is_rgb_order(component_fmt, 1, 0, 2)) {
+            rmt_strip->base.set_pixel = led_strip_rmt_set_pixel_grb;
+        } else if (led_strip_is_rgb_order(component_fmt, 0, 1, 2)) {
+            rmt_strip->base.set_pixel = led_strip_rmt_set_pixel_rgb;
+        } else {
+            rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
+        }
+        rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+        rmt_strip->base.set_pixel_16 = led_strip_rmt_set_pixel_16_b8;
+        rmt_strip->base.set_pixel_rgbw_16 = led_strip_rmt_set_pixel_rgbw_16_b8;
+    }
+    rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
+    rmt_strip->base.refresh_wait_done = led_strip_rmt_refresh_wait_done;
+    rmt_strip->base.get_frame = led_strip_rmt_get_frame;
+    rmt_strip->base.clear = led_strip_rmt_clear;
+    rmt_strip->base.del = led_strip_rmt_del;
+    return ESP_OK;
+err:
+    if (rmt_strip->rmt_chan) {
+        rmt_del_channel(rmt_strip->rmt_chan);
+    }
+    if (rmt_strip->strip_encoder) {
+        rmt_del_encoder(rmt_strip->strip_encoder);
+    }
+    return ret;
+}
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && rmt_config && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_color_component_format_t component_fmt;
+    size_t size = 0;
+    ESP_RETURN_ON_ERROR(led_strip_rmt_get_layout(led_config, &component_fmt, &size), TAG, "invalid strip config");
+    led_strip_rmt_obj *rmt_strip = calloc(1, size);
+    ESP_RETURN_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, TAG, "no mem for rmt strip");
+    esp_err_t ret = led_strip_rmt_setup(rmt_strip, led_config, rmt_config, component_fmt);
+    if (ret != ESP_OK) {
+        free(rmt_strip);
+        return ret;
+    }
+    *ret_strip = &rmt_strip->base;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rmt_init_static(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                    void *storage, size_t storage_size, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && rmt_config && storage && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(((uintptr_t)storage & (__alignof__(led_strip_rmt_obj) - 1)) == 0, ESP_ERR_INVALID_ARG, TAG, "storage not aligned");
+    led_color_component_format_t component_fmt;
+    size_t size = 0;
+    ESP_RETURN_ON_ERROR(led_strip_rmt_get_layout(led_config, &component_fmt, &size), TAG, "invalid strip config");
+    ESP_RETURN_ON_FALSE(storage_size >= size, ESP_ERR_INVALID_SIZE, TAG, "storage too small: %u < %u bytes", (unsigned)storage_size, (unsigned)size);
+    memset(storage, 0, size);
+    led_strip_rmt_obj *rmt_strip = storage;
+    rmt_strip->static_storage = true;
+    ESP_RETURN_ON_ERROR(led_strip_rmt_setup(rmt_strip, led_config, rmt_config, component_fmt), TAG, "setup rmt strip failed");
+    *ret_strip = &rmt_strip->base;
+    return ESP_OK;
+}
@@ -0,0 +1,498 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_assert.h"
+#include "esp_rom_sys.h"
+#include "esp_attr.h"
+#include "driver/gpio.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "led_strip_sim.h"
+#else
+#include "esp_memory_utils.h"
+#include "esp_rom_gpio.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/spi_periph.h"
+#endif
+#include "led_strip.h"
+#include "led_strip_interface.h"
+#include "led_strip_pixel.h"
+#include "led_strip_rgbw.h"
+#include "esp_heap_caps.h"
+
+#define LED_STRIP_SPI_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz resolution
+#define LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE 4
+
+#define SPI_BYTES_PER_COLOR_BYTE 3
+#define SPI_BITS_PER_COLOR_BYTE (SPI_BYTES_PER_COLOR_BYTE * 8)
+
+static const char *TAG = "led_strip_spi";
+
+typedef struct {
+    led_strip_t base;
+    spi_host_device_t spi_host;
+    spi_device_handle_t spi_device;
+    uint32_t strip_len;
+    uint8_t bytes_per_pixel;
+    bool static_storage;
+    bool transmitting;
+    bool bus_owner;
+    bool invert_out;
+    int gpio_num;
+    uint32_t mosi_signal;
+    led_color_component_format_t component_fmt;
+    led_strip_rgbw_t rgbw;
+    led_strip_dither_t dither;
+    spi_transaction_t tx_trans;
+    uint8_t pixel_buf[];
+} led_strip_spi_obj;
+
+ESP_STATIC_ASSERT(sizeof(led_strip_spi_obj) <= LED_STRIP_SPI_OBJ_SIZE, "LED_STRIP_SPI_OBJ_SIZE is too small for the driver object");
+
+// please make sure to zero-initialize the buf before calling this function
+static void __led_strip_spi_bit(uint8_t data, uint8_t *buf)
+{
+    // Each color of 1 bit is represented by 3 bits of SPI, low_level:100 ,high_level:110
+    // So a color byte occupies 3 bytes of SPI.
+    *(buf + 2) |= data & BIT(0) ? BIT(2) | BIT(1) : BIT(2);
+    *(buf + 2) |= data & BIT(1) ? BIT(5) | BIT(4) : BIT(5);
+    *(buf + 2) |= data & BIT(2) ? BIT(7) : 0x00;
+    *(buf + 1) |= BIT(0);
+    *(buf + 1) |= data & BIT(3) ? BIT(3) | BIT(2) : BIT(3);
+    *(buf + 1) |= data & BIT(4) ? BIT(6) | BIT(5) : BIT(6);
+    *(buf + 0) |= data & BIT(5) ? BIT(1) | BIT(0) : BIT(1);
+    *(buf + 0) |= data & BIT(6) ? BIT(4) | BIT(3) : BIT(4);
+    *(buf + 0) |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
+}
+
+static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    // 3 pixels take 72bits(9bytes)
+    uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    uint8_t *pixel_buf = spi_strip->pixel_buf;
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+
+    if (component_fmt.format.num_components > 3) {
+        uint8_t rgb[3] = {red & 0xFF, green & 0xFF, blue & 0xFF};
+        uint8_t white = 0;
+        if (spi_strip->rgbw.mode != LED_STRIP_RGBW_NONE) {
+            white = led_strip_rgbw_extract(&spi_strip->rgbw, rgb);
+        }
+        __led_strip_spi_bit(rgb[0], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
+        __led_strip_spi_bit(rgb[1], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
+        __led_strip_spi_bit(rgb[2], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
+        __led_strip_spi_bit(white, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+    } else {
+        __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
+        __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
+        __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+
+    // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes)
+    uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    uint8_t *pixel_buf = spi_strip->pixel_buf;
+    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+
+    __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
+    __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
+    __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
+    __led_strip_spi_bit(white, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+
+    return ESP_OK;
+}
+
+// 3-component 8-bit strip with the component order fixed at compile time, positions are constants in every caller
+__attribute__((always_inline))
+static inline esp_err_t led_strip_spi_put_fixed(led_strip_t *strip, uint32_t index, uint8_t red, uint8_t green, uint8_t blue,
+                                                const uint32_t r_pos, const uint32_t g_pos, const uint32_t b_pos)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint8_t *pixel = &spi_strip->pixel_buf[index * 3 * SPI_BYTES_PER_COLOR_BYTE];
+    memset(pixel, 0, 3 * SPI_BYTES_PER_COLOR_BYTE);
+    __led_strip_spi_bit(red, &pixel[SPI_BYTES_PER_COLOR_BYTE * r_pos]);
+    __led_strip_spi_bit(green, &pixel[SPI_BYTES_PER_COLOR_BYTE * g_pos]);
+    __led_strip_spi_bit(blue, &pixel[SPI_BYTES_PER_COLOR_BYTE * b_pos]);
+    return ESP_OK;
+}
+
+// WS2812 and most other 3-component strips
+LED_STRIP_DEFINE_PIXEL_OP_FIXED(led_strip_spi, grb, led_strip_spi_put_fixed, 1, 0, 2)
+LED_STRIP_DEFINE_PIXEL_OP_FIXED(led_strip_spi, rgb, led_strip_spi_put_fixed, 0, 1, 2)
+
+// Store a pixel given with 16-bit components, `store` is a constant in every caller (see led_strip_store_t)
+__attribute__((always_inline))
+static inline esp_err_t led_strip_spi_put_16(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white,
+                                             bool with_white, const led_strip_store_t store)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    uint32_t num_components = component_fmt.format.num_components;
+    ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_FALSE(!with_white || num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+
+    uint16_t value[4] = {red, green, blue, white};
+    if (!with_white && num_components > 3 && spi_strip->rgbw.mode != LED_STRIP_RGBW_NONE) {
+        value[3] = led_strip_rgbw_extract_16(&spi_strip->rgbw, value);
+    }
+    const uint8_t pos[4] = {component_fmt.format.r_pos, component_fmt.format.g_pos, component_fmt.format.b_pos, component_fmt.format.w_pos};
+    uint8_t *pixel = &spi_strip->pixel_buf[index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE];
+    if (store != LED_STRIP_STORE_DITHER) {
+        memset(pixel, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    }
+    for (uint32_t i = 0; i < num_components; i++) {
+        switch (store) {
+        case LED_STRIP_STORE_8:
+            __led_strip_spi_bit(led_strip_component_to_8(value[i]), &pixel[SPI_BYTES_PER_COLOR_BYTE * pos[i]]);
+            break;
+        case LED_STRIP_STORE_16:
+            __led_strip_spi_bit(value[i] >> 8, &pixel[SPI_BYTES_PER_COLOR_BYTE * 2 * pos[i]]);
+            __led_strip_spi_bit(value[i] & 0xFF, &pixel[SPI_BYTES_PER_COLOR_BYTE * (2 * pos[i] + 1)]);
+            break;
+        case LED_STRIP_STORE_DITHER:
+            spi_strip->dither.frame[index * num_components + pos[i]] = value[i];
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+// 8-bit strip: the 8-bit ops above, 16-bit values rounded
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_spi, b8, led_strip_spi_put_16, LED_STRIP_STORE_8)
+// 16-bit strip
+LED_STRIP_DEFINE_PIXEL_OPS_8(led_strip_spi, b16, led_strip_spi_put_16, LED_STRIP_STORE_16)
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_spi, b16, led_strip_spi_put_16, LED_STRIP_STORE_16)
+// 8-bit strip with temporal dithering
+LED_STRIP_DEFINE_PIXEL_OPS_8(led_strip_spi, dither, led_strip_spi_put_16, LED_STRIP_STORE_DITHER)
+LED_STRIP_DEFINE_PIXEL_OPS_16(led_strip_spi, dither, led_strip_spi_put_16, LED_STRIP_STORE_DITHER)
+
+// Dither the 16-bit frame straight into the SPI bit pattern
+static void led_strip_spi_dither(led_strip_spi_obj *spi_strip)
+{
+    led_strip_dither_t *dither = &spi_strip->dither;
+    uint8_t *buf = spi_strip->pixel_buf;
+    memset(buf, 0, dither->num * SPI_BYTES_PER_COLOR_BYTE);
+    for (uint32_t i = 0; i < dither->num; i++) {
+        __led_strip_spi_bit(led_strip_dither_component(dither->frame[i], &dither->error[i]), buf);
+        buf += SPI_BYTES_PER_COLOR_BYTE;
+    }
+}
+
+// shared bus: MOSI drives the strip GPIO during the strip's own transactions only (SPI ISR context, no flash access)
+static void IRAM_ATTR led_strip_spi_pre_transfer(spi_transaction_t *trans)
+{
+    led_strip_spi_obj *spi_strip = trans->user;
+    esp_rom_gpio_connect_out_signal(spi_strip->gpio_num, spi_strip->mosi_signal, spi_strip->invert_out, false);
+}
+
+static void IRAM_ATTR led_strip_spi_post_transfer(spi_transaction_t *trans)
+{
+    led_strip_spi_obj *spi_strip = trans->user;
+    // back to a plain GPIO at the idle level (low, high if inverted) while other devices use the bus
+    esp_rom_gpio_connect_out_signal(spi_strip->gpio_num, SIG_GPIO_OUT_IDX, spi_strip->invert_out, false);
+}
+
+// Only the 16-bit frame of a dithered strip can be written directly, the transmit buffer holds the SPI bit code
+static esp_err_t led_strip_spi_get_frame(led_strip_t *strip, led_strip_frame_t *frame)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(spi_strip->dither.frame, ESP_ERR_NOT_SUPPORTED, TAG, "pixels are kept in SPI bit code");
+    led_strip_frame_describe(frame, spi_strip->component_fmt, spi_strip->strip_len);
+    frame->pixels_16 = spi_strip->dither.frame;
+    frame->component_width = LED_STRIP_COMPONENT_WIDTH_16;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh_async(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(!spi_strip->transmitting, ESP_ERR_INVALID_STATE, TAG, "previous refresh not done");
+
+    if (spi_strip->dither.frame) {
+        led_strip_spi_dither(spi_strip);
+    }
+
+    // the transaction stays queued after this returns, so it lives in the object
+    spi_transaction_t *tx_conf = &spi_strip->tx_trans;
+    memset(tx_conf, 0, sizeof(*tx_conf));
+    tx_conf->length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
+    tx_conf->tx_buffer = spi_strip->pixel_buf;
+    tx_conf->rx_buffer = NULL;
+    tx_conf->user = spi_strip;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, tx_conf, portMAX_DELAY), TAG, "transmit pixels by SPI failed");
+    spi_strip->transmitting = true;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh_wait_done(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(spi_strip->transmitting, ESP_ERR_INVALID_STATE, TAG, "no refresh in progress");
+    spi_transaction_t *done_trans = NULL;
+    ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done_trans, portMAX_DELAY), TAG, "wait SPI transaction failed");
+    spi_strip->transmitting = false;
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_spi_refresh_async(strip), TAG, "start refresh failed");
+    return led_strip_spi_refresh_wait_done(strip);
+}
+
+static esp_err_t led_strip_spi_clear(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    //Write zero to turn off all leds
+    memset(spi_strip->pixel_buf, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    if (spi_strip->dither.frame) {
+        led_strip_dither_clear(&spi_strip->dither);
+    }
+    uint8_t *buf = spi_strip->pixel_buf;
+    for (int index = 0; index < spi_strip->strip_len * spi_strip->bytes_per_pixel; index++) {
+        __led_strip_spi_bit(0, buf);
+        buf += SPI_BYTES_PER_COLOR_BYTE;
+    }
+
+    return led_strip_spi_refresh(strip);
+}
+
+static esp_err_t led_strip_spi_del(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+
+    if (spi_strip->transmitting) {
+        ESP_RETURN_ON_ERROR(led_strip_spi_refresh_wait_done(strip), TAG, "finish refresh failed");
+    }
+    ESP_RETURN_ON_ERROR(spi_bus_remove_device(spi_strip->spi_device), TAG, "delete spi device failed");
+    if (spi_strip->bus_owner) {
+        ESP_RETURN_ON_ERROR(spi_bus_free(spi_strip->spi_host), TAG, "free spi bus failed");
+    }
+
+    if (!spi_strip->static_storage) {
+        free(spi_strip);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Validate the color component format and work out the object size, SPI transmit buffer and dithering state included
+ */
+static esp_err_t led_strip_spi_get_layout(const led_strip_config_t *led_config, led_color_component_format_t *ret_fmt, size_t *ret_size)
+{
+    led_color_component_format_t component_fmt = led_config->color_component_format;
+    // If R/G/B order is not specified, set default GRB order as fallback
+    if (component_fmt.format_id == 0) {
+        component_fmt = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
+    }
+    // check the validation of the color component format
+    uint8_t mask = 0;
+    if (component_fmt.format.num_components == 3) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x07, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else if (component_fmt.format.num_components == 4) {
+        mask = BIT(component_fmt.format.r_pos) | BIT(component_fmt.format.g_pos) | BIT(component_fmt.format.b_pos) | BIT(component_fmt.format.w_pos);
+        // Check for invalid values
+        ESP_RETURN_ON_FALSE(mask == 0x0F, ESP_ERR_INVALID_ARG, TAG, "invalid order argument");
+    } else {
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid number of color components: %d", component_fmt.format.num_components);
+    }
+    ESP_RETURN_ON_FALSE(component_fmt.format.width <= LED_STRIP_COMPONENT_WIDTH_16, ESP_ERR_INVALID_ARG, TAG, "invalid component width");
+    bool wide = component_fmt.format.width == LED_STRIP_COMPONENT_WIDTH_16;
+    ESP_RETURN_ON_FALSE(!(wide && led_config->flags.temporal_dither), ESP_ERR_INVALID_ARG, TAG, "temporal dithering is for 8-bit strips only");
+
+    size_t size = sizeof(led_strip_spi_obj) +
+                  led_config->max_leds * LED_STRIP_BYTES_PER_PIXEL(component_fmt.format.num_components, component_fmt.format.width) * SPI_BYTES_PER_COLOR_BYTE;
+    if (led_config->flags.temporal_dither) {
+        size += LED_STRIP_DITHER_STORAGE_SIZE(led_config->max_leds, component_fmt.format.num_components);
+    }
+    *ret_fmt = component_fmt;
+    *ret_size = size;
+    return ESP_OK;
+}
+
+/**
+ * @brief Set up a zeroed object: white extraction, SPI bus and device, pixel ops
+ *
+ * @note On failure, whatever was created is released again, the object memory is left to the caller
+ */
+static esp_err_t led_strip_spi_setup(led_strip_spi_obj *spi_strip, const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config,
+                                     led_color_component_format_t component_fmt)
+{
+    esp_err_t ret = ESP_OK;
+    bool wide = component_fmt.format.width == LED_STRIP_COMPONENT_WIDTH_16;
+    uint8_t bytes_per_pixel = LED_STRIP_BYTES_PER_PIXEL(component_fmt.format.num_components, component_fmt.format.width);
+    uint32_t num_components = led_config->max_leds * component_fmt.format.num_components;
+    ESP_GOTO_ON_ERROR(led_strip_rgbw_init(&spi_strip->rgbw, led_config->rgbw_mode, led_config->white_temp_k), err, TAG, "invalid white extraction config");
+
+    spi_strip->spi_host = spi_config->spi_bus;
+    // for backward compatibility, if the user does not set the clk_src, use the default value
+    spi_clock_source_t clk_src = SPI_CLK_SRC_DEFAULT;
+    if (spi_config->clk_src) {
+        clk_src = spi_config->clk_src;
+    }
+
+    if (spi_config->flags.shared_bus) {
+        // the application owns the bus: park the strip GPIO at idle level, the transfer callbacks route MOSI to it
+        spi_strip->gpio_num = led_config->strip_gpio_num;
+        spi_strip->invert_out = led_config->flags.invert_out;
+        spi_strip->mosi_signal = spi_periph_signal[spi_strip->spi_host].spid_out;
+        ESP_GOTO_ON_ERROR(gpio_set_level(spi_strip->gpio_num, 0), err, TAG, "set strip GPIO level failed");
+        ESP_GOTO_ON_ERROR(gpio_set_direction(spi_strip->gpio_num, GPIO_MODE_OUTPUT), err, TAG, "set strip GPIO direction failed");
+        esp_rom_gpio_connect_out_signal(spi_strip->gpio_num, SIG_GPIO_OUT_IDX, spi_strip->invert_out, false);
+    } else {
+        spi_bus_config_t spi_bus_cfg = {
+            .mosi_io_num = led_config->strip_gpio_num,
+            //Only use MOSI to generate the signal, set -1 when other pins are not used.
+            .miso_io_num = -1,
+            .sclk_io_num = -1,
+            .quadwp_io_num = -1,
+            .quadhd_io_num = -1,
+            .max_transfer_sz = led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE,
+        };
+        ESP_GOTO_ON_ERROR(spi_bus_initialize(spi_strip->spi_host, &spi_bus_cfg, spi_config->flags.with_dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED), err, TAG, "create SPI bus failed");
+        spi_strip->bus_owner = true;
+
+        if (led_config->flags.invert_out == true) {
+            esp_rom_gpio_connect_out_signal(led_config->strip_gpio_num, spi_periph_signal[spi_strip->spi_host].spid_out, true, false);
+        }
+    }
+
+    spi_device_interface_config_t spi_dev_cfg = {
+        .clock_source = clk_src,
+        .command_bits = 0,
+        .address_bits = 0,
+        .dummy_bits = 0,
+        .clock_speed_hz = LED_STRIP_SPI_DEFAULT_RESOLUTION,
+        .mode = 0,
+        //set -1 when CS is not used
+        .spics_io_num = -1,
+        .queue_size = LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE,
+        .pre_cb = spi_config->flags.shared_bus ? led_strip_spi_pre_transfer : NULL,
+        .post_cb = spi_config->flags.shared_bus ? led_strip_spi_post_transfer : NULL,
+    };
+
+    ESP_GOTO_ON_ERROR(spi_bus_add_device(spi_strip->spi_host, &spi_dev_cfg, &spi_strip->spi_device), err, TAG, "Failed to add spi device");
+    //ensure the reset time is enough
+    esp_rom_delay_us(10);
+    int clock_resolution_khz = 0;
+    spi_device_get_actual_freq(spi_strip->spi_device, &clock_resolution_khz);
+    // TODO: ideally we should decide the SPI_BYTES_PER_COLOR_BYTE by the real clock resolution
+    // But now, let's fixed the resolution, the downside is, we don't support a clock source whose frequency is not multiple of LED_STRIP_SPI_DEFAULT_RESOLUTION
+    // clock_resolution between 2.2MHz to 2.8MHz is supported
+    ESP_GOTO_ON_FALSE((clock_resolution_khz < LED_STRIP_SPI_DEFAULT_RESOLUTION / 1000 + 300) && (clock_resolution_khz > LED_STRIP_SPI_DEFAULT_RESOLUTION / 1000 - 300), ESP_ERR_NOT_SUPPORTED, err,
+                      TAG, "unsupported clock resolution:%dKHz", clock_resolution_khz);
+
+    if (led_config->led_model != LED_MODEL_WS2812) {
+        ESP_LOGW(TAG, "Only support WS2812. The timing requirements for other models may not be met");
+    }
+
+    spi_strip->component_fmt = component_fmt;
+    spi_strip->bytes_per_pixel = bytes_per_pixel;
+    spi_strip->strip_len = led_config->max_leds;
+    if (wide) {
+        spi_strip->base.set_pixel = led_strip_spi_set_pixel_b16;
+        spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw_b16;
+        spi_strip->base.set_pixel_16 = led_strip_spi_set_pixel_16_b16;
+        spi_strip->base.set_pixel_rgbw_16 = led_strip_spi_set_pixel_rgbw_16_b16;
+    } else if (led_config->flags.temporal_dither) {
+        led_strip_dither_attach(&spi_strip->dither, spi_strip->pixel_buf + led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, num_components);
+        spi_strip->base.set_pixel = led_strip_spi_set_pixel_dither;
+        spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw_dither;
+        spi_strip->base.set_pixel_16 = led_strip_spi_set_pixel_16_dither;
+        spi_strip->base.set_pixel_rgbw_16 = led_strip_spi_set_pixel_rgbw_16_dither;
+    } else {
+        // GRB and RGB get a pixel op with the component order compiled in, any other format looks it up per pixel
+        if (led_strip_is_rgb_order(component_fmt, 1, 0, 2)) {
+            spi_strip->base.set_pixel = led_strip_spi_set_pixel_grb;
+        } else if (led_strip_is_rgb_order(component_fmt, 0, 1, 2)) {
+            spi_strip->base.set_pixel = led_strip_spi_set_pixel_rgb;
+        } else {
+            spi_strip->base.set_pixel = led_strip_spi_set_pixel;
+        }
+        spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw;
+        spi_strip->base.set_pixel_16 = led_strip_spi_set_pixel_16_b8;
+        spi_strip->base.set_pixel_rgbw_16 = led_strip_spi_set_pixel_rgbw_16_b8;
+    }
+    spi_strip->base.refresh = led_strip_spi_refresh;
+    spi_strip->base.refresh_async = led_strip_spi_refresh_async;
+    spi_strip->base.refresh_wait_done = led_strip_spi_refresh_wait_done;
+    spi_strip->base.get_frame = led_strip_spi_get_frame;
+    spi_strip->base.clear = led_strip_spi_clear;
+    spi_strip->base.del = led_strip_spi_del;
+
+    return ESP_OK;
+err:
+    if (spi_strip->spi_device) {
+        spi_bus_remove_device(spi_strip->spi_device);
+    }
+    if (spi_strip->bus_owner) {
+        spi_bus_free(spi_strip->spi_host);
+        spi_strip->bus_owner = false;
+    }
+    return ret;
+}
+
+esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && spi_config && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_color_component_format_t component_fmt;
+    size_t size = 0;
+    ESP_RETURN_ON_ERROR(led_strip_spi_get_layout(led_config, &component_fmt, &size), TAG, "invalid strip config");
+    uint32_t mem_caps = MALLOC_CAP_DEFAULT;
+    if (spi_config->flags.with_dma) {
+        // DMA buffer must be placed in internal SRAM
+        mem_caps |= MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+    }
+    led_strip_spi_obj *spi_strip = heap_caps_calloc(1, size, mem_caps);
+    ESP_RETURN_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, TAG, "no mem for spi strip");
+    esp_err_t ret = led_strip_spi_setup(spi_strip, led_config, spi_config, component_fmt);
+    if (ret != ESP_OK) {
+        free(spi_strip);
+        return ret;
+    }
+    *ret_strip = &spi_strip->base;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_spi_init_static(const led_strip_config_t *led_config, const led_strip_spi_config_t *spi_config,
+                                    void *storage, size_t storage_size, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(led_config && spi_config && storage && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(((uintptr_t)storage & (__alignof__(led_strip_spi_obj) - 1)) == 0, ESP_ERR_INVALID_ARG, TAG, "storage not aligned");
+    // same rule as the heap allocation: the DMA reads the transmit buffer straight from the storage
+    ESP_RETURN_ON_FALSE(!spi_config->flags.with_dma || esp_ptr_dma_capable(storage), ESP_ERR_INVALID_ARG, TAG, "storage not DMA capable");
+    led_color_component_format_t component_fmt;
+    size_t size = 0;
+    ESP_RETURN_ON_ERROR(led_strip_spi_get_layout(led_config, &component_fmt, &size), TAG, "invalid strip config");
+    ESP_RETURN_ON_FALSE(storage_size >= size, ESP_ERR_INVALID_SIZE, TAG, "storage too small: %u < %u bytes", (unsigned)storage_size, (unsigned)size);
+    memset(storage, 0, size);
+    led_strip_spi_obj *spi_strip = storage;
+    spi_strip->static_storage = true;
+    ESP_RETURN_ON_ERROR(led_strip_spi_setup(spi_strip, led_config, spi_config, component_fmt), TAG, "setup spi strip failed");
+    *ret_strip = &spi_strip->base;
+    return ESP_OK;
+}
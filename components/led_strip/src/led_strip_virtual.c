@@ -0,0 +1,309 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/cdefs.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "led_strip.h"
+#include "led_strip_interface.h"
+
+#define LED_STRIP_VIRTUAL_MAX_STRIPS   255
+#define LED_STRIP_VIRTUAL_INDEX_BITS   24
+#define LED_STRIP_VIRTUAL_INDEX_MASK   ((1UL << LED_STRIP_VIRTUAL_INDEX_BITS) - 1)
+
+static const char *TAG = "led_strip_virtual";
+
+/**
+ * @brief Consecutive virtual pixels that are consecutive LEDs (forwards or backwards) on one physical strip
+ */
+typedef struct {
+    uint32_t first;          /*!< First virtual pixel of the run */
+    uint32_t count;          /*!< Number of pixels */
+    uint32_t index;          /*!< LED of the first pixel on the physical strip */
+    int32_t step;            /*!< +1 or -1: direction on the physical strip */
+    uint32_t strip;          /*!< Slot in `strips` */
+} led_strip_virtual_run_t;
+
+typedef struct {
+    led_strip_t base;
+    uint32_t strip_len;
+    uint32_t num_strips;
+    uint32_t num_runs;
+    led_strip_handle_t *strips;    // every physical strip once, in order of first use
+    led_strip_virtual_run_t *runs; // sorted by first pixel
+    uint32_t *map;                 // per virtual pixel: strip slot in the top 8 bits, LED index below
+} led_strip_virtual_obj;
+
+static inline led_strip_handle_t led_strip_virtual_lookup(led_strip_virtual_obj *virt, uint32_t index, uint32_t *ret_index)
+{
+    uint32_t entry = virt->map[index];
+    *ret_index = entry & LED_STRIP_VIRTUAL_INDEX_MASK;
+    return virt->strips[entry >> LED_STRIP_VIRTUAL_INDEX_BITS];
+}
+
+static esp_err_t led_strip_virtual_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(index < virt->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t led = 0;
+    led_strip_handle_t phys = led_strip_virtual_lookup(virt, index, &led);
+    return phys->set_pixel(phys, led, red, green, blue);
+}
+
+static esp_err_t led_strip_virtual_set_pixel_rgbw(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(index < virt->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t led = 0;
+    led_strip_handle_t phys = led_strip_virtual_lookup(virt, index, &led);
+    return phys->set_pixel_rgbw(phys, led, red, green, blue, white);
+}
+
+static esp_err_t led_strip_virtual_set_pixel_16(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(index < virt->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t led = 0;
+    led_strip_handle_t phys = led_strip_virtual_lookup(virt, index, &led);
+    return led_strip_set_pixel_16(phys, led, red, green, blue);
+}
+
+static esp_err_t led_strip_virtual_set_pixel_rgbw_16(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(index < virt->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    uint32_t led = 0;
+    led_strip_handle_t phys = led_strip_virtual_lookup(virt, index, &led);
+    return led_strip_set_pixel_rgbw_16(phys, led, red, green, blue, white);
+}
+
+static esp_err_t led_strip_virtual_refresh_async(led_strip_t *strip)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    esp_err_t ret = ESP_OK;
+    for (uint32_t i = 0; i < virt->num_strips; i++) {
+        ret = led_strip_refresh_async(virt->strips[i]);
+        if (ret != ESP_OK) {
+            // don't leave the strips started so far in flight
+            for (uint32_t j = 0; j < i; j++) {
+                led_strip_refresh_wait_done(virt->strips[j]);
+            }
+            ESP_LOGE(TAG, "start refresh of strip %"PRIu32" failed", i);
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_virtual_refresh_wait_done(led_strip_t *strip)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    esp_err_t ret = ESP_OK;
+    // wait for every strip even after a failure, the first error is reported
+    for (uint32_t i = 0; i < virt->num_strips; i++) {
+        esp_err_t err = led_strip_refresh_wait_done(virt->strips[i]);
+        if (err != ESP_OK && ret == ESP_OK) {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+static esp_err_t led_strip_virtual_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_virtual_refresh_async(strip), TAG, "start refresh failed");
+    return led_strip_virtual_refresh_wait_done(strip);
+}
+
+static esp_err_t led_strip_virtual_clear(led_strip_t *strip)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    // only the mapped LEDs: other LEDs of the physical strips may belong to someone else
+    for (uint32_t i = 0; i < virt->strip_len; i++) {
+        ESP_RETURN_ON_ERROR(led_strip_virtual_set_pixel(strip, i, 0, 0, 0), TAG, "clear pixel %"PRIu32" failed", i);
+    }
+    return led_strip_virtual_refresh(strip);
+}
+
+static esp_err_t led_strip_virtual_del(led_strip_t *strip)
+{
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    free(virt);
+    return ESP_OK;
+}
+
+/**
+ * @brief Run that holds virtual pixel `index`
+ */
+static const led_strip_virtual_run_t *led_strip_virtual_find_run(const led_strip_virtual_obj *virt, uint32_t index)
+{
+    // last run starting at or before the pixel
+    uint32_t lo = 0;
+    uint32_t hi = virt->num_runs;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (virt->runs[mid].first <= index) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return &virt->runs[lo];
+}
+
+esp_err_t led_strip_virtual_write(led_strip_handle_t strip, uint32_t start, const uint8_t *rgb, uint32_t count)
+{
+    ESP_RETURN_ON_FALSE(strip && rgb && strip->del == led_strip_virtual_del, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(start <= virt->strip_len && count <= virt->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    const led_strip_virtual_run_t *run = led_strip_virtual_find_run(virt, start);
+    uint32_t skip = start - run->first;
+    while (count) {
+        led_strip_handle_t phys = virt->strips[run->strip];
+        uint32_t led = run->index + run->step * (int32_t)skip;
+        uint32_t n = run->count - skip < count ? run->count - skip : count;
+        for (uint32_t i = 0; i < n; i++, led += run->step, rgb += 3) {
+            ESP_RETURN_ON_ERROR(phys->set_pixel(phys, led, rgb[0], rgb[1], rgb[2]), TAG, "write pixel failed");
+        }
+        count -= n;
+        run++;
+        skip = 0;
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_virtual_write_16(led_strip_handle_t strip, uint32_t start, const uint16_t *rgb, uint32_t count)
+{
+    ESP_RETURN_ON_FALSE(strip && rgb && strip->del == led_strip_virtual_del, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    led_strip_virtual_obj *virt = __containerof(strip, led_strip_virtual_obj, base);
+    ESP_RETURN_ON_FALSE(start <= virt->strip_len && count <= virt->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "range out of maximum number of LEDs");
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    const led_strip_virtual_run_t *run = led_strip_virtual_find_run(virt, start);
+    uint32_t skip = start - run->first;
+    while (count) {
+        led_strip_handle_t phys = virt->strips[run->strip];
+        ESP_RETURN_ON_FALSE(phys->set_pixel_16, ESP_ERR_NOT_SUPPORTED, TAG, "16-bit pixels not supported");
+        uint32_t led = run->index + run->step * (int32_t)skip;
+        uint32_t n = run->count - skip < count ? run->count - skip : count;
+        for (uint32_t i = 0; i < n; i++, led += run->step, rgb += 3) {
+            ESP_RETURN_ON_ERROR(phys->set_pixel_16(phys, led, rgb[0], rgb[1], rgb[2]), TAG, "write pixel failed");
+        }
+        count -= n;
+        run++;
+        skip = 0;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief LED on the physical strip of pixel `pos` of a segment
+ */
+static uint32_t led_strip_virtual_segment_led(const led_strip_segment_t *seg, uint32_t pos)
+{
+    if (seg->flags.reversed) {
+        pos = seg->count - 1 - pos;
+    }
+    if (seg->serpentine_width) {
+        uint32_t row = pos / seg->serpentine_width;
+        uint32_t col = pos % seg->serpentine_width;
+        if (row & 1) {
+            // a last row cut short by count is reversed within its own length
+            uint32_t row_len = seg->count - row * seg->serpentine_width;
+            if (row_len > seg->serpentine_width) {
+                row_len = seg->serpentine_width;
+            }
+            col = row_len - 1 - col;
+        }
+        pos = row * seg->serpentine_width + col;
+    }
+    return seg->first + pos;
+}
+
+esp_err_t led_strip_new_virtual(const led_strip_virtual_config_t *config, led_strip_handle_t *ret_strip)
+{
+    ESP_RETURN_ON_FALSE(config && config->segments && ret_strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->num_segments > 0 && config->num_segments <= LED_STRIP_VIRTUAL_MAX_STRIPS, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid number of segments: %"PRIu32, config->num_segments);
+
+    // sizes: runs are counted for the worst case (no run continues into the next segment)
+    uint32_t strip_len = 0;
+    uint32_t max_runs = 0;
+    for (uint32_t i = 0; i < config->num_segments; i++) {
+        const led_strip_segment_t *seg = &config->segments[i];
+        ESP_RETURN_ON_FALSE(seg->strip && seg->count > 0, ESP_ERR_INVALID_ARG, TAG, "invalid segment %"PRIu32, i);
+        ESP_RETURN_ON_FALSE(seg->first + seg->count - 1 <= LED_STRIP_VIRTUAL_INDEX_MASK && seg->first < seg->first + seg->count,
+                            ESP_ERR_INVALID_ARG, TAG, "segment %"PRIu32" out of range", i);
+        strip_len += seg->count;
+        max_runs += seg->serpentine_width ? (seg->count + seg->serpentine_width - 1) / seg->serpentine_width : 1;
+    }
+
+    // one block: object, strips, runs, map (in order of alignment)
+    led_strip_virtual_obj *virt = calloc(1, sizeof(led_strip_virtual_obj) + config->num_segments * sizeof(led_strip_handle_t) +
+                                         max_runs * sizeof(led_strip_virtual_run_t) + strip_len * sizeof(uint32_t));
+    ESP_RETURN_ON_FALSE(virt, ESP_ERR_NO_MEM, TAG, "no mem for virtual strip");
+    virt->strips = (led_strip_handle_t *)(virt + 1);
+    virt->runs = (led_strip_virtual_run_t *)(virt->strips + config->num_segments);
+    virt->map = (uint32_t *)(virt->runs + max_runs);
+    virt->strip_len = strip_len;
+
+    uint32_t pixel = 0;
+    led_strip_virtual_run_t *run = NULL;
+    for (uint32_t i = 0; i < config->num_segments; i++) {
+        const led_strip_segment_t *seg = &config->segments[i];
+        uint32_t slot = 0;
+        while (slot < virt->num_strips && virt->strips[slot] != seg->strip) {
+            slot++;
+        }
+        if (slot == virt->num_strips) {
+            virt->strips[virt->num_strips++] = seg->strip;
+        }
+        for (uint32_t pos = 0; pos < seg->count; pos++, pixel++) {
+            uint32_t led = led_strip_virtual_segment_led(seg, pos);
+            virt->map[pixel] = (slot << LED_STRIP_VIRTUAL_INDEX_BITS) | led;
+            // continue the run if this LED is next in its direction (a second LED sets the direction)
+            if (run && run->strip == slot) {
+                uint32_t last = run->index + run->step * (int32_t)(run->count - 1);
+                if (run->count == 1 && (led == last + 1 || led == last - 1)) {
+                    run->step = led == last + 1 ? 1 : -1;
+                    run->count++;
+                    continue;
+                }
+                if (run->count > 1 && led == last + run->step) {
+                    run->count++;
+                    continue;
+                }
+            }
+            run = &virt->runs[virt->num_runs++];
+            run->first = pixel;
+            run->count = 1;
+            run->index = led;
+            run->step = 1;
+            run->strip = slot;
+        }
+    }
+
+    virt->base.set_pixel = led_strip_virtual_set_pixel;
+    virt->base.set_pixel_rgbw = led_strip_virtual_set_pixel_rgbw;
+    virt->base.set_pixel_16 = led_strip_virtual_set_pixel_16;
+    virt->base.set_pixel_rgbw_16 = led_strip_virtual_set_pixel_rgbw_16;
+    virt->base.refresh = led_strip_virtual_refresh;
+    virt->base.refresh_async = led_strip_virtual_refresh_async;
+    virt->base.refresh_wait_done = led_strip_virtual_refresh_wait_done;
+    virt->base.clear = led_strip_virtual_clear;
+    virt->base.del = led_strip_virtual_del;
+    ESP_LOGD(TAG, "%"PRIu32" pixels on %"PRIu32" strips, %"PRIu32" runs", strip_len, virt->num_strips, virt->num_runs);
+
+    *ret_strip = &virt->base;
+    return ESP_OK;
+}
@@ -0,0 +1,49 @@
+#ifndef LED_STRIP_SIM_DRIVER_RMT_TX_H
+#define LED_STRIP_SIM_DRIVER_RMT_TX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "driver/rmt_types.h"
+#include "driver/rmt_encoder.h"
+
+/*
+ * driver/rmt_tx.h for the Linux host build
+ * ----------------------------------------
+ * A transmission runs the encoder at once and records what the strip
+ * GPIO would carry (led_strip_sim.h). Enable / disable / delete follow
+ * the driver's state rules, so misuse fails like on the chip.
+ */
+
+typedef struct {
+    gpio_num_t gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+    int intr_priority;
+    struct {
+        uint32_t invert_out: 1;
+        uint32_t with_dma: 1;
+        uint32_t io_loop_back: 1;
+        uint32_t io_od_mode: 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level: 1;
+        uint32_t queue_nonblocking: 1;
+    } flags;
+} rmt_transmit_config_t;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms);
+
+#endif
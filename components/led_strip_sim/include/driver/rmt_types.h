@@ -0,0 +1,32 @@
+#ifndef LED_STRIP_SIM_DRIVER_RMT_TYPES_H
+#define LED_STRIP_SIM_DRIVER_RMT_TYPES_H
+
+#include <stdint.h>
+
+/*
+ * driver/rmt_types.h for the Linux host build
+ * -------------------------------------------
+ * Same names and layout as the ESP-IDF driver, only what the led_strip
+ * RMT backend uses. Backed by led_strip_sim.c.
+ */
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+
+typedef enum {
+    RMT_CLK_SRC_APB = 1,
+    RMT_CLK_SRC_DEFAULT = RMT_CLK_SRC_APB,
+} rmt_clock_source_t;
+
+// One RMT symbol: two levels with their durations in resolution ticks
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef LED_STRIP_SIM_DRIVER_SPI_MASTER_H
+#define LED_STRIP_SIM_DRIVER_SPI_MASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * driver/spi_master.h for the Linux host build
+ * --------------------------------------------
+ * Same names and signatures as the ESP-IDF driver, only what the
+ * led_strip SPI backend uses. Buses and devices keep the driver's
+ * state rules; a queued transaction is sent at once (pre / post
+ * callbacks included) and waits in the device's result queue.
+ */
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+    SPI_HOST_MAX,
+} spi_host_device_t;
+
+typedef enum {
+    SPI_CLK_SRC_APB = 1,
+    SPI_CLK_SRC_DEFAULT = SPI_CLK_SRC_APB,
+} spi_clock_source_t;
+
+typedef enum {
+    SPI_DMA_DISABLED = 0,
+    SPI_DMA_CH_AUTO = 3,
+} spi_dma_chan_t;
+
+typedef struct spi_device_t *spi_device_handle_t;
+typedef struct spi_transaction_t spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;        // 0: 4092 bytes, like the driver
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    spi_clock_source_t clock_source;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;              // Bits
+    size_t rxlength;
+    void *user;
+    const void *tx_buffer;
+    void *rx_buffer;
+};
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host_id);
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, uint32_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, uint32_t ticks_to_wait);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc);
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz);
+
+#endif
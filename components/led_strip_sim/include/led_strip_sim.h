@@ -0,0 +1,86 @@
+#ifndef LED_STRIP_SIM_H
+#define LED_STRIP_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/rmt_tx.h"
+#include "driver/spi_master.h"
+
+/*
+ * Simulated LED Strip Peripherals (Linux host build)
+ * --------------------------------------------------
+ * The ESP-IDF Linux target has no RMT and no SPI master. This component
+ * fakes both drivers behind their own headers, so the led_strip RMT and
+ * SPI backends build and run unchanged on a PC:
+ *  - RMT: led_strip's encoder runs as on the chip; the bytes and copy
+ *    encoders add up bytes and bit / reset durations instead of symbols
+ *  - SPI: transactions run their pre / post callbacks, MOSI follows the
+ *    simulated GPIO matrix, the 3-bit WS2812 code is decoded back to bytes
+ *  - LINE RECORD: per GPIO, the last transfer as the LEDs receive it
+ *    (bytes in wire order), its start time and its wire time
+ *
+ * Transfers complete at once: refresh cost on the host is CPU only, the
+ * recorded wire time tells how long the chip would be busy.
+ *
+ * Console: "strips" lists every line that has carried a transfer.
+ */
+
+// Bytes kept per line (512 RGB LEDs); longer transfers are cut, len still tells the full size
+#define LED_STRIP_SIM_LINE_BYTES  1536
+
+typedef enum {
+    LED_STRIP_SIM_RMT,
+    LED_STRIP_SIM_SPI,
+} led_strip_sim_backend_t;
+
+// Last transfer on one GPIO (led_strip_sim_get)
+typedef struct {
+    led_strip_sim_backend_t backend;
+    uint32_t transfers;         // Since start or led_strip_sim_reset()
+    int64_t last_us;            // esp_timer time the last transfer started
+    uint32_t wire_us;           // Time the last transfer takes on the wire (bits, RMT reset code included)
+    size_t len;                 // Bytes the LEDs received in the last transfer
+    bool inverted;              // Output inverted (led_strip flags.invert_out)
+} led_strip_sim_line_t;
+
+/*
+ * @brief Last transfer on a GPIO
+ *
+ * @param data       receives up to data_size bytes of it (NULL: none)
+ * @return ESP_ERR_NOT_FOUND if the GPIO has not carried a transfer
+ */
+esp_err_t led_strip_sim_get(int gpio_num, led_strip_sim_line_t *line, uint8_t *data, size_t data_size);
+
+// Forget all recorded lines (channels, buses and devices stay)
+void led_strip_sim_reset(void);
+
+// Print every recorded line: backend, transfers, wire time, first bytes
+void led_strip_sim_print(void);
+
+// Add the "strips" command
+esp_err_t led_strip_sim_register_console(void);
+
+/*
+ * STAND-INS for chip-only helpers of the SPI backend (esp_rom_gpio.h,
+ * soc/spi_periph.h, soc/gpio_sig_map.h, esp_memory_utils.h)
+ */
+#define SIG_GPIO_OUT_IDX  256
+
+typedef struct {
+    uint32_t spid_out;          // MOSI output signal of the host
+} spi_signal_conn_t;
+
+extern const spi_signal_conn_t spi_periph_signal[SPI_HOST_MAX];
+
+// Connect a peripheral output signal (or SIG_GPIO_OUT_IDX) to a pin of the simulated GPIO matrix
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv);
+
+// All host memory can be "DMA" memory
+static inline bool esp_ptr_dma_capable(const void *p)
+{
+    return p != NULL;
+}
+
+#endif
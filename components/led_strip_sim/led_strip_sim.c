@@ -0,0 +1,550 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "led_strip_sim.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#define SIM_MAX_LINES          8
+#define SIM_PRINT_BYTES        12     // First bytes shown by "strips"
+#define SIM_SPI_QUEUE_MAX      8
+#define SIM_SPI_DEFAULT_MAX_SZ 4092   // Driver default for max_transfer_sz = 0
+#define SIM_SPI_SIGNAL_BASE    100    // Simulated MOSI signal numbers (not a chip's)
+
+const spi_signal_conn_t spi_periph_signal[SPI_HOST_MAX] = {
+    [SPI1_HOST] = { .spid_out = SIM_SPI_SIGNAL_BASE + SPI1_HOST },
+    [SPI2_HOST] = { .spid_out = SIM_SPI_SIGNAL_BASE + SPI2_HOST },
+    [SPI3_HOST] = { .spid_out = SIM_SPI_SIGNAL_BASE + SPI3_HOST },
+};
+
+/*
+ * ONE LINE: the last transfer a GPIO carried
+ */
+typedef struct {
+    int gpio_num;               // -1 = free
+    led_strip_sim_line_t info;
+    uint8_t data[LED_STRIP_SIM_LINE_BYTES];
+} sim_line_t;
+
+/*
+ * RMT CHANNEL:
+ *  - enabled / busy follow the driver (transmit needs enable, delete needs disable)
+ *  - bytes / ticks: filled by the encoders during one transmission
+ */
+struct rmt_channel_t {
+    gpio_num_t gpio_num;
+    uint32_t resolution_hz;
+    bool inverted;
+    bool enabled;
+    bool busy;
+    size_t len;
+    uint64_t ticks;
+    uint8_t bytes[LED_STRIP_SIM_LINE_BYTES];
+};
+
+typedef struct {
+    rmt_encoder_t base;
+    uint32_t bit_ticks[2];      // Wire time of a 0 and of a 1
+} sim_bytes_encoder_t;
+
+/*
+ * SPI BUS / DEVICE:
+ *  - A bus knows its MOSI pin (or -1) and how many devices it carries
+ *  - A device keeps its callbacks and the results not fetched yet
+ */
+typedef struct {
+    bool initialized;
+    int mosi_io_num;
+    size_t max_transfer_sz;
+    uint32_t devices;
+} sim_spi_bus_t;
+
+struct spi_device_t {
+    spi_host_device_t host;
+    spi_device_interface_config_t config;
+    spi_transaction_t *done[SIM_SPI_QUEUE_MAX];
+    uint32_t done_first;
+    uint32_t done_count;
+};
+
+static sim_line_t lines[SIM_MAX_LINES] = {
+    [0 ... SIM_MAX_LINES - 1] = { .gpio_num = -1 },
+};
+static sim_spi_bus_t spi_buses[SPI_HOST_MAX];
+static uint32_t pin_signal[GPIO_NUM_MAX];       // Simulated GPIO matrix, 0 = never connected
+static bool pin_inverted[GPIO_NUM_MAX];
+static portMUX_TYPE sim_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * Store one transfer on a GPIO's line. A new GPIO takes a free line;
+ * with all lines in use the transfer is counted nowhere (host only).
+ */
+static void record_line(int gpio_num, led_strip_sim_backend_t backend, const uint8_t *data, size_t len,
+                        uint32_t wire_us, int64_t start_us, bool inverted)
+{
+    taskENTER_CRITICAL(&sim_lock);
+    sim_line_t *line = NULL;
+    for (int i = 0; i < SIM_MAX_LINES && line == NULL; i++) {
+        if (lines[i].gpio_num == gpio_num) {
+            line = &lines[i];
+        }
+    }
+    for (int i = 0; i < SIM_MAX_LINES && line == NULL; i++) {
+        if (lines[i].gpio_num < 0) {
+            line = &lines[i];
+            line->gpio_num = gpio_num;
+            line->info = (led_strip_sim_line_t){ 0 };
+        }
+    }
+    if (line != NULL) {
+        line->info.backend = backend;
+        line->info.transfers++;
+        line->info.last_us = start_us;
+        line->info.wire_us = wire_us;
+        line->info.len = len;
+        line->info.inverted = inverted;
+        memcpy(line->data, data, len < sizeof(line->data) ? len : sizeof(line->data));
+    }
+    taskEXIT_CRITICAL(&sim_lock);
+}
+
+esp_err_t led_strip_sim_get(int gpio_num, led_strip_sim_line_t *line, uint8_t *data, size_t data_size)
+{
+    if (line == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&sim_lock);
+    for (int i = 0; i < SIM_MAX_LINES; i++) {
+        if (lines[i].gpio_num == gpio_num) {
+            *line = lines[i].info;
+            if (data != NULL) {
+                size_t kept = line->len < sizeof(lines[i].data) ? line->len : sizeof(lines[i].data);
+                memcpy(data, lines[i].data, kept < data_size ? kept : data_size);
+            }
+            err = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&sim_lock);
+    return err;
+}
+
+void led_strip_sim_reset(void)
+{
+    taskENTER_CRITICAL(&sim_lock);
+    for (int i = 0; i < SIM_MAX_LINES; i++) {
+        lines[i].gpio_num = -1;
+    }
+    taskEXIT_CRITICAL(&sim_lock);
+}
+
+/*
+ * RMT ENCODERS:
+ *  - bytes: each byte as 8 bits of bit0 / bit1 timing, the byte itself
+ *    goes to the channel's record
+ *  - copy: symbols as they are (led_strip's reset code), time only
+ * Both complete in one call: the simulated channel memory never fills.
+ */
+static size_t sim_bytes_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                               size_t data_size, rmt_encode_state_t *ret_state)
+{
+    sim_bytes_encoder_t *bytes_encoder = (sim_bytes_encoder_t *)encoder;
+    const uint8_t *data = primary_data;
+    for (size_t i = 0; i < data_size; i++) {
+        uint32_t ones = __builtin_popcount(data[i]);
+        channel->ticks += ones * bytes_encoder->bit_ticks[1] + (8 - ones) * bytes_encoder->bit_ticks[0];
+        if (channel->len < sizeof(channel->bytes)) {
+            channel->bytes[channel->len] = data[i];
+        }
+        channel->len++;
+    }
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return data_size * 8;
+}
+
+static size_t sim_copy_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                              size_t data_size, rmt_encode_state_t *ret_state)
+{
+    const rmt_symbol_word_t *symbols = primary_data;
+    size_t count = data_size / sizeof(rmt_symbol_word_t);
+    for (size_t i = 0; i < count; i++) {
+        channel->ticks += symbols[i].duration0 + symbols[i].duration1;
+    }
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return count;
+}
+
+static esp_err_t sim_encoder_reset(rmt_encoder_t *encoder)
+{
+    return ESP_OK;
+}
+
+static esp_err_t sim_encoder_del(rmt_encoder_t *encoder)
+{
+    free(encoder);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    if (config == NULL || ret_encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_bytes_encoder_t *bytes_encoder = calloc(1, sizeof(sim_bytes_encoder_t));
+    if (bytes_encoder == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bytes_encoder->base.encode = sim_bytes_encode;
+    bytes_encoder->base.reset = sim_encoder_reset;
+    bytes_encoder->base.del = sim_encoder_del;
+    bytes_encoder->bit_ticks[0] = config->bit0.duration0 + config->bit0.duration1;
+    bytes_encoder->bit_ticks[1] = config->bit1.duration0 + config->bit1.duration1;
+    *ret_encoder = &bytes_encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    if (config == NULL || ret_encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_encoder_t *copy_encoder = calloc(1, sizeof(rmt_encoder_t));
+    if (copy_encoder == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    copy_encoder->encode = sim_copy_encode;
+    copy_encoder->reset = sim_encoder_reset;
+    copy_encoder->del = sim_encoder_del;
+    *ret_encoder = copy_encoder;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+    if (encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+    if (encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return encoder->reset(encoder);
+}
+
+/*
+ * RMT TX CHANNEL
+ */
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    if (config == NULL || ret_chan == NULL || !GPIO_IS_VALID_OUTPUT_GPIO(config->gpio_num) ||
+        config->resolution_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_channel_handle_t channel = calloc(1, sizeof(struct rmt_channel_t));
+    if (channel == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    channel->gpio_num = config->gpio_num;
+    channel->resolution_hz = config->resolution_hz;
+    channel->inverted = config->flags.invert_out;
+    *ret_chan = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = false;
+    channel->busy = false;
+    return ESP_OK;
+}
+
+/*
+ * TRANSMIT: run the encoder to completion like the RMT ISR would, then
+ * record the bytes and the wire time (bits + reset code) on the GPIO.
+ */
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config)
+{
+    if (tx_channel == NULL || encoder == NULL || payload == NULL || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!tx_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t start_us = esp_timer_get_time();
+    tx_channel->len = 0;
+    tx_channel->ticks = 0;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    do {
+        encoder->encode(encoder, tx_channel, payload, payload_bytes, &state);
+    } while (!(state & RMT_ENCODING_COMPLETE));
+
+    uint32_t wire_us = tx_channel->ticks * 1000000 / tx_channel->resolution_hz;
+    record_line(tx_channel->gpio_num, LED_STRIP_SIM_RMT, tx_channel->bytes, tx_channel->len, wire_us,
+                start_us, tx_channel->inverted);
+    tx_channel->busy = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms)
+{
+    if (tx_channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    tx_channel->busy = false;
+    return ESP_OK;
+}
+
+/*
+ * GPIO MATRIX: which output signal drives a pin, and inverted or not
+ */
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv)
+{
+    if (gpio_num < GPIO_NUM_MAX) {
+        taskENTER_CRITICAL(&sim_lock);
+        pin_signal[gpio_num] = signal_idx;
+        pin_inverted[gpio_num] = out_inv;
+        taskEXIT_CRITICAL(&sim_lock);
+    }
+}
+
+/*
+ * SPI BUS / DEVICES
+ */
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX || bus_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_spi_bus_t *bus = &spi_buses[host_id];
+    if (bus->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *bus = (sim_spi_bus_t){
+        .initialized = true,
+        .mosi_io_num = bus_config->mosi_io_num,
+        .max_transfer_sz = bus_config->max_transfer_sz > 0 ? bus_config->max_transfer_sz : SIM_SPI_DEFAULT_MAX_SZ,
+    };
+    if (bus->mosi_io_num >= 0) {
+        esp_rom_gpio_connect_out_signal(bus->mosi_io_num, spi_periph_signal[host_id].spid_out, false, false);
+    }
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_spi_bus_t *bus = &spi_buses[host_id];
+    if (!bus->initialized || bus->devices > 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (bus->mosi_io_num >= 0) {
+        esp_rom_gpio_connect_out_signal(bus->mosi_io_num, SIG_GPIO_OUT_IDX, false, false);
+    }
+    bus->initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle)
+{
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX || dev_config == NULL || handle == NULL ||
+        dev_config->clock_speed_hz <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!spi_buses[host_id].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    spi_device_handle_t dev = calloc(1, sizeof(struct spi_device_t));
+    if (dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->host = host_id;
+    dev->config = *dev_config;
+    spi_buses[host_id].devices++;
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count > 0) {
+        return ESP_ERR_INVALID_STATE;   // Results not fetched, like the driver
+    }
+    spi_buses[handle->host].devices--;
+    free(handle);
+    return ESP_OK;
+}
+
+// WS2812 over SPI: every data bit is 3 SPI bits (100 = 0, 110 = 1), the middle one is the data
+static uint8_t decode_ws2812_byte(const uint8_t *spi)
+{
+    uint32_t word = (spi[0] << 16) | (spi[1] << 8) | spi[2];
+    uint8_t data = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        data |= ((word >> (bit * 3 + 1)) & 1) << bit;
+    }
+    return data;
+}
+
+/*
+ * QUEUE = SEND: pre callback, record on every pin the MOSI signal of the
+ * host drives at that moment, post callback, result into the queue.
+ */
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, uint32_t ticks_to_wait)
+{
+    if (handle == NULL || trans_desc == NULL || (trans_desc->length > 0 && trans_desc->tx_buffer == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t bytes = (trans_desc->length + 7) / 8;
+    if (bytes > spi_buses[handle->host].max_transfer_sz) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count >= SIM_SPI_QUEUE_MAX ||
+        (handle->config.queue_size > 0 && handle->done_count >= (uint32_t)handle->config.queue_size)) {
+        return ESP_ERR_TIMEOUT;         // Queue full: would block forever on the host
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    if (handle->config.pre_cb) {
+        handle->config.pre_cb(trans_desc);
+    }
+    static uint8_t decoded[LED_STRIP_SIM_LINE_BYTES];
+    size_t len = bytes / 3;
+    const uint8_t *tx = trans_desc->tx_buffer;
+    for (size_t i = 0; i < len && i < sizeof(decoded); i++) {
+        decoded[i] = decode_ws2812_byte(tx + i * 3);
+    }
+    uint32_t wire_us = (uint64_t)trans_desc->length * 1000000 / handle->config.clock_speed_hz;
+    uint32_t signal = spi_periph_signal[handle->host].spid_out;
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (pin_signal[pin] == signal) {
+            record_line(pin, LED_STRIP_SIM_SPI, decoded, len, wire_us, start_us, pin_inverted[pin]);
+        }
+    }
+    if (handle->config.post_cb) {
+        handle->config.post_cb(trans_desc);
+    }
+
+    handle->done[(handle->done_first + handle->done_count) % SIM_SPI_QUEUE_MAX] = trans_desc;
+    handle->done_count++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, uint32_t ticks_to_wait)
+{
+    if (handle == NULL || trans_desc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count == 0) {
+        return ESP_ERR_TIMEOUT;         // Nothing queued: would block forever on the host
+    }
+    *trans_desc = handle->done[handle->done_first];
+    handle->done_first = (handle->done_first + 1) % SIM_SPI_QUEUE_MAX;
+    handle->done_count--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    esp_err_t err = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (err != ESP_OK) {
+        return err;
+    }
+    spi_transaction_t *done = NULL;
+    return spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+}
+
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz)
+{
+    if (handle == NULL || freq_khz == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *freq_khz = handle->config.clock_speed_hz / 1000;
+    return ESP_OK;
+}
+
+void led_strip_sim_print(void)
+{
+    int shown = 0;
+    printf("GPIO  backend  transfers  bytes  wire us  first bytes\n");
+    for (int gpio = 0; gpio < GPIO_NUM_MAX; gpio++) {
+        led_strip_sim_line_t line;
+        uint8_t data[SIM_PRINT_BYTES];
+        if (led_strip_sim_get(gpio, &line, data, sizeof(data)) != ESP_OK) {
+            continue;
+        }
+        printf("%4d  %-7s  %9lu  %5u  %7lu ", gpio, line.backend == LED_STRIP_SIM_RMT ? "RMT" : "SPI",
+               (unsigned long)line.transfers, (unsigned)line.len, (unsigned long)line.wire_us);
+        for (size_t i = 0; i < line.len && i < sizeof(data); i++) {
+            printf(" %02x", data[i]);
+        }
+        printf("%s%s\n", line.len > sizeof(data) ? " ..." : "", line.inverted ? " (inverted)" : "");
+        shown++;
+    }
+    if (shown == 0) {
+        printf("No strip transfer yet\n");
+    }
+}
+
+static int cmd_strips(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        led_strip_sim_reset();
+        return 0;
+    }
+    led_strip_sim_print();
+    return 0;
+}
+
+esp_err_t led_strip_sim_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "strips",
+        .help = "Last transfer of every simulated LED strip line (host build), 'reset' forgets them",
+        .hint = "[reset]",
+        .func = &cmd_strips,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -1,145 +1,334 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "long_press_power.h"
+#include "fast_boot.h"
+#include "panel_pm.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "task_monitor.h"
+#include "loop_timing.h"
+#include "power_logic.h"
+#include "event_log.h"
 #include "esp_log.h"
 
 #define TAG "POWER_SYSTEM"
 
-#define DEBOUNCE_DELAY    50     // 50ms debounce for button
-#define LONG_PRESS_TIME 3000     // 3000ms (3 seconds) long-press threshold
+// Debounce, long-press threshold and hold blink: long_press_power_config_t
+
+#define SAMPLE_PERIOD_MS    50   // Button sampling while a press is timed
+
+#define POWER_TASK_STACK    3072
+#define POWER_TASK_PRIORITY 5
+#define POWER_STOP_TIMEOUT_MS 3000   // Longest boot sequence is 2 s
 
 // For logging readable state names
 static const char* state_names[] = {
     "OFF", "BOOTING", "ON", "SHUTTING DOWN"
 };
 
-void long_press_power_run(void)
+/*
+ * RETAINED POWER STATE:
+ *  - Only the stable states (OFF / ON) are stored
+ *  - A reset in the middle of BOOTING or SHUTTING DOWN comes back as OFF
+ *    (safe side: operator must long-press again)
+ */
+static FAST_BOOT_SLOT_ATTR fast_boot_slot_t retained_power[CONFIG_LONG_PRESS_POWER_MAX_INSTANCES];
+
+/*
+ * RUNTIME STATE PER INSTANCE:
+ *  - Static so the console can read / drive it
+ *  - sample_timing stays listed for "jitter" after a stop (loop_timing)
+ */
+typedef struct {
+    long_press_power_config_t config;  // Copy used by the running loop
+    TaskHandle_t task;
+    input_bus_sub_t sub;               // Button events
+    panel_output_t led;                // Power LED, power priority
+    loop_timing_t sample_timing;
+    volatile bool active;
+    volatile bool stop_requested;
+    long_press_power_status_t status;
+} long_press_power_instance_t;
+
+static long_press_power_instance_t instances[CONFIG_LONG_PRESS_POWER_MAX_INSTANCES];
+
+static bool config_valid(const long_press_power_config_t *config)
+{
+    return config && config->instance < CONFIG_LONG_PRESS_POWER_MAX_INSTANCES &&
+           GPIO_IS_VALID_GPIO(config->button_pin) &&
+           GPIO_IS_VALID_OUTPUT_GPIO(config->led_pin);
+}
+
+static system_state_t load_retained_state(fast_boot_slot_t *slot)
+{
+    uint32_t value;
+    if (fast_boot_slot_load(slot, &value) && value == SYSTEM_ON) {
+        return SYSTEM_ON;
+    }
+    return SYSTEM_OFF;
+}
+
+void long_press_power_fast_restore(const long_press_power_config_t *config)
+{
+    uint32_t value;
+    if (!config_valid(config) || !fast_boot_slot_load(&retained_power[config->instance], &value)) {
+        return;
+    }
+
+    panel_output_restore(config->led_pin, load_retained_state(&retained_power[config->instance]) == SYSTEM_ON);
+}
+
+static void long_press_power_task(void *arg)
+{
+    long_press_power_run((const long_press_power_config_t *)arg);
+    vTaskDelete(NULL);  // Stopped
+}
+
+esp_err_t long_press_power_start(const long_press_power_config_t *config)
+{
+    if (!config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    long_press_power_instance_t *self = &instances[config->instance];
+    if (self->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    self->config = *config;
+    self->stop_requested = false;
+    self->active = true;
+    if (xTaskCreate(long_press_power_task, "power", POWER_TASK_STACK,
+                    &self->config, POWER_TASK_PRIORITY, &self->task) != pdPASS) {
+        self->active = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t long_press_power_stop(uint8_t instance)
+{
+    if (instance >= CONFIG_LONG_PRESS_POWER_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    long_press_power_instance_t *self = &instances[instance];
+    if (!self->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    self->stop_requested = true;
+    xTaskNotifyGive(self->task);
+
+    // A boot / shutdown sequence in progress is finished first
+    for (int waited_ms = 0; self->active; waited_ms += 10) {
+        if (waited_ms >= POWER_STOP_TIMEOUT_MS) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
+
+esp_err_t long_press_power_press(uint8_t instance, bool pressed)
+{
+    if (instance >= CONFIG_LONG_PRESS_POWER_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!instances[instance].status.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return input_bus_inject(instances[instance].config.button_pin, pressed);
+}
+
+esp_err_t long_press_power_get_status(uint8_t instance, long_press_power_status_t *status)
+{
+    if (instance >= CONFIG_LONG_PRESS_POWER_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *status = instances[instance].status;
+    return ESP_OK;
+}
+
+void long_press_power_run(const long_press_power_config_t *config)
 {
+    if (!config_valid(config)) {
+        ESP_LOGE(TAG, "Invalid power controller config");
+        return;
+    }
+    long_press_power_instance_t *self = &instances[config->instance];
+    if (config != &self->config) {
+        self->config = *config;  // Called directly, not through long_press_power_start()
+        self->stop_requested = false;
+    }
+    config = &self->config;
+    self->task = xTaskGetCurrentTaskHandle();
+    self->active = true;
+    long_press_power_status_t *status = &self->status;
+    const gpio_num_t button_pin = config->button_pin;
+    const gpio_num_t led_pin = config->led_pin;
+    const uint32_t long_press_ms = config->long_press_ms;
+    fast_boot_slot_t *retained = &retained_power[config->instance];
+
     /*
-     * BUTTON AS INPUT WITH PULL-UP:
-     *  - Normal (not pressed) → reads HIGH (1)
-     *  - Pressed (to GND)     → reads LOW  (0)
+     * LED THROUGH THE OUTPUT MANAGER (power priority):
+     *  - Used to show power/system state to operator
+     *  - Kept as is after a warm reset: fast-restore already drives it
      */
-    gpio_reset_pin(POWER_BUTTON_PIN);
-    gpio_set_direction(POWER_BUTTON_PIN, GPIO_MODE_INPUT);
-    gpio_set_pull_mode(POWER_BUTTON_PIN, GPIO_PULLUP_ONLY);
-    
+    if (panel_output_open(&self->led, led_pin, PANEL_OUTPUT_PRIO_POWER, "power") != ESP_OK) {
+        ESP_LOGE(TAG, "Power LED GPIO %d not available", led_pin);
+        self->active = false;
+        return;
+    }
+
     /*
-     * LED AS OUTPUT:
-     *  - Used to show power/system state to operator
+     * BUTTON AS INPUT WITH PULL-UP (configured + debounced by the input bus):
+     *  - Normal (not pressed) → reads HIGH (1)
+     *  - Pressed (to GND)     → reads LOW  (0)
      */
-    gpio_reset_pin(POWER_LED_PIN);
-    gpio_set_direction(POWER_LED_PIN, GPIO_MODE_OUTPUT);
+    if (input_bus_subscribe(&self->sub, button_pin, config->debounce_ms, "power") != ESP_OK) {
+        ESP_LOGE(TAG, "Power button GPIO %d not available", button_pin);
+        panel_output_close(&self->led);
+        self->active = false;
+        return;
+    }
     
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "Industrial Long-Press Power Controller");
+    ESP_LOGI(TAG, "Industrial Long-Press Power Controller (instance %d)", config->instance);
     ESP_LOGI(TAG, "Button: GPIO %d  |  Power LED: GPIO %d",
-             POWER_BUTTON_PIN, POWER_LED_PIN);
-    ESP_LOGI(TAG, "Hold button for 3 seconds to POWER ON/OFF safely");
+             button_pin, led_pin);
+    ESP_LOGI(TAG, "Hold button for %lu ms to POWER ON/OFF safely", (unsigned long)long_press_ms);
     ESP_LOGI(TAG, "Short presses are ignored (safety feature).");
     ESP_LOGI(TAG, "========================================");
+
+    fast_boot_mark("power loop ready");
+    fast_boot_report();
     
     /*
      * VARIABLES:
-     *  - state            → current power state
-     *  - press_start_time → when user started pressing (ms)
-     *  - button_active    → are we currently timing a press?
-     *  - last_level       → previous button logic level (for edge detection)
+     *  - state  → current power state
+     *  - logic  → long-press timing (power_logic.h, no GPIO inside,
+     *             debounce 0: the bus already did it)
+     *  - input  → next button edge; held back for one iteration if a
+     *             long press fell due before it
+     *  - status → boot cycles / short presses for the console
      */
-    system_state_t state = SYSTEM_OFF;
-    uint32_t press_start_time = 0;
-    bool button_active = false;
-    int last_level = 1;  // starts HIGH due to pull-up
-    int boot_cycles = 0;
+    system_state_t state = load_retained_state(retained);
+    power_logic_t logic;
+    power_logic_init(&logic, 0, long_press_ms);
+    input_event_t input;
+    bool have_input = false;
+    *status = (long_press_power_status_t){ .state = state };
+
+    /*
+     * POWER MANAGEMENT:
+     *  - Idle (no press being timed) → block until a button event
+     *  - Press being timed / boot / shutdown → NO light sleep, 50 ms steps
+     *  - Long press handled, button still held → block until released
+     */
+    panel_pm_lock_t pm_lock;
+    panel_pm_lock_init(&pm_lock, "power_press");
+    panel_pm_wake_counter_t wakes = PANEL_PM_WAKE_COUNTER("long_press_power");
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "power");
+
+    /*
+     * FIXED CADENCE WHILE TIMING A PRESS:
+     *  - xTaskDelayUntil keeps 50 ms between wake-ups, not 50 ms + work
+     *  - Period jitter / missed deadlines: console command "jitter"
+     */
+    loop_timing_t *sample_timing = &self->sample_timing;
+    loop_timing_init(sample_timing, "power_sample", SAMPLE_PERIOD_MS);
+
+    status->running = true;
     
-    while(1) {
-        int level = gpio_get_level(POWER_BUTTON_PIN);
+    while(!self->stop_requested) {
+        panel_pm_wake_count(&wakes);
+        task_monitor_loop_begin(&loop_stats);
+
         uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        if(!have_input) {
+            have_input = input_bus_receive(&self->sub, &input) && input.type != INPUT_EVENT_GLITCH;
+        }
+
+        /*
+         * ONE DECISION PER ITERATION, in time order:
+         *  1. Long press due before the next edge (or before now)
+         *  2. Otherwise the edge itself, timed from the raw edge
+         *     as the operator felt it
+         */
+        power_event_t event = power_logic_feed(&logic, logic.debounce.stable_pressed,
+                                               have_input ? input.edge_ms : now_ms);
+        if(event == POWER_EVENT_NONE && have_input) {
+            event = power_logic_feed(&logic, input.type == INPUT_EVENT_PRESS, input.edge_ms);
+            have_input = false;
+        }
         
         /*
-         * FALLING EDGE DETECTION (button just pressed):
-         *  last_level = 1 (released) → level = 0 (pressed)
+         * PRESS CONFIRMED (debounced):
+         *  - Start timing, no light sleep until the press is decided
+         *  - Feedback: blink LED slowly while the user holds the button
          */
-        if(last_level == 1 && level == 0) {
-            vTaskDelay(DEBOUNCE_DELAY / portTICK_PERIOD_MS);  // Debounce
-            level = gpio_get_level(POWER_BUTTON_PIN);
-            
-            if(level == 0) {  // Confirmed press
-                press_start_time = now_ms;
-                button_active = true;
-                ESP_LOGI(TAG, "Button pressed - hold for 3 seconds to toggle power");
-            }
+        if(event == POWER_EVENT_PRESS) {
+            loop_timing_restart(sample_timing);
+            panel_pm_lock_hold(&pm_lock, true);
+            panel_output_blink(&self->led, config->hold_blink_ms);
+            ESP_LOGI(TAG, "Button pressed - hold for %lu ms to toggle power", (unsigned long)long_press_ms);
         }
         
         /*
-         * WHILE BUTTON IS HELD:
-         *  - Measure press duration
-         *  - Provide visual feedback using LED while counting
+         * LONG-PRESS REACHED:
+         *  - Held for at least long_press_ms (default 3000ms)
+         *  - Perform BOOT or SHUTDOWN depending on current state
+         *  - The rest of the hold is ignored (no re-trigger until release)
          */
-        if(button_active && level == 0) {
-            uint32_t press_duration = now_ms - press_start_time;
-            
-            // Feedback: blink LED slowly while user holds button
-            if(press_duration % 500 < 250) {
-                gpio_set_level(POWER_LED_PIN, 1);  // ON half the time
-            } else {
-                gpio_set_level(POWER_LED_PIN, 0);  // OFF half the time
-            }
-            
-            /*
-             * LONG-PRESS REACHED:
-             *  - If held for at least LONG_PRESS_TIME (3000ms)
-             *  - Perform BOOT or SHUTDOWN depending on current state
-             */
-            if(press_duration >= LONG_PRESS_TIME) {
-                button_active = false;  // Don't re-trigger until next press
+        if(event == POWER_EVENT_LONG_PRESS) {
+            if(state == SYSTEM_OFF) {
+                // BOOT SEQUENCE
+                state = SYSTEM_BOOTING;
+                status->state = state;
+                status->boot_cycles++;
+                ESP_LOGI(TAG, "========================================");
+                ESP_LOGI(TAG, "LONG PRESS DETECTED - Starting BOOT sequence #%lu", (unsigned long)status->boot_cycles);
+                ESP_LOGI(TAG, "========================================");
                 
-                if(state == SYSTEM_OFF) {
-                    // BOOT SEQUENCE
-                    state = SYSTEM_BOOTING;
-                    boot_cycles++;
-                    ESP_LOGI(TAG, "========================================");
-                    ESP_LOGI(TAG, "LONG PRESS DETECTED - Starting BOOT sequence #%d", boot_cycles);
-                    ESP_LOGI(TAG, "========================================");
-                    
-                    // Fake boot progress for training
-                    for(int progress = 0; progress <= 100; progress += 25) {
-                        ESP_LOGI(TAG, "Boot progress: %d%%", progress);
-                        gpio_set_level(POWER_LED_PIN, 1);
-                        vTaskDelay(250 / portTICK_PERIOD_MS);
-                        gpio_set_level(POWER_LED_PIN, 0);
-                        vTaskDelay(150 / portTICK_PERIOD_MS);
-                    }
-                    
-                    state = SYSTEM_ON;
-                    ESP_LOGI(TAG, "System state: %s", state_names[state]);
-                    ESP_LOGI(TAG, "Controller is now ONLINE and ready.");
-                }
-                else if(state == SYSTEM_ON) {
-                    // SHUTDOWN SEQUENCE
-                    state = SYSTEM_SHUTTING_DOWN;
-                    ESP_LOGW(TAG, "========================================");
-                    ESP_LOGW(TAG, "LONG PRESS DETECTED - Starting SHUTDOWN sequence");
-                    ESP_LOGW(TAG, "========================================");
-                    
-                    // Fake shutdown progress for training
-                    for(int progress = 100; progress >= 0; progress -= 25) {
-                        ESP_LOGW(TAG, "Shutdown progress: %d%%", progress);
-                        gpio_set_level(POWER_LED_PIN, 1);
-                        vTaskDelay(150 / portTICK_PERIOD_MS);
-                        gpio_set_level(POWER_LED_PIN, 0);
-                        vTaskDelay(100 / portTICK_PERIOD_MS);
-                    }
-                    
-                    state = SYSTEM_OFF;
-                    ESP_LOGI(TAG, "System state: %s", state_names[state]);
-                    ESP_LOGI(TAG, "Controller is now safely powered OFF.");
+                // Fake boot progress for training (fixed cadence, logging does not stretch it)
+                TickType_t step_wake = xTaskGetTickCount();
+                for(int progress = 0; progress <= 100; progress += 25) {
+                    ESP_LOGI(TAG, "Boot progress: %d%%", progress);
+                    panel_output_set(&self->led, true);
+                    xTaskDelayUntil(&step_wake, pdMS_TO_TICKS(250));
+                    panel_output_set(&self->led, false);
+                    xTaskDelayUntil(&step_wake, pdMS_TO_TICKS(150));
                 }
                 
-                // Wait until user releases button to avoid re-trigger
-                while(gpio_get_level(POWER_BUTTON_PIN) == 0) {
-                    vTaskDelay(50 / portTICK_PERIOD_MS);
+                state = SYSTEM_ON;
+                status->state = state;
+                fast_boot_slot_store(retained, state);
+                event_log_add("power", "ON", status->boot_cycles);
+                ESP_LOGI(TAG, "System state: %s", state_names[state]);
+                ESP_LOGI(TAG, "Controller is now ONLINE and ready.");
+            }
+            else if(state == SYSTEM_ON) {
+                // SHUTDOWN SEQUENCE
+                state = SYSTEM_SHUTTING_DOWN;
+                status->state = state;
+                ESP_LOGW(TAG, "========================================");
+                ESP_LOGW(TAG, "LONG PRESS DETECTED - Starting SHUTDOWN sequence");
+                ESP_LOGW(TAG, "========================================");
+                
+                // Fake shutdown progress for training
+                TickType_t step_wake = xTaskGetTickCount();
+                for(int progress = 100; progress >= 0; progress -= 25) {
+                    ESP_LOGW(TAG, "Shutdown progress: %d%%", progress);
+                    panel_output_set(&self->led, true);
+                    xTaskDelayUntil(&step_wake, pdMS_TO_TICKS(150));
+                    panel_output_set(&self->led, false);
+                    xTaskDelayUntil(&step_wake, pdMS_TO_TICKS(100));
                 }
+                
+                state = SYSTEM_OFF;
+                status->state = state;
+                fast_boot_slot_store(retained, state);
+                event_log_add("power", "OFF", status->boot_cycles);
+                ESP_LOGI(TAG, "System state: %s", state_names[state]);
+                ESP_LOGI(TAG, "Controller is now safely powered OFF.");
             }
         }
         
@@ -148,30 +337,51 @@ void long_press_power_run(void)
          *  - Short press (<3s) is intentionally ignored
          *  - This prevents accidental on/off events
          */
-        if(button_active && last_level == 0 && level == 1) {
-            uint32_t press_duration = now_ms - press_start_time;
-            if(press_duration < LONG_PRESS_TIME) {
-                ESP_LOGI(TAG,
-                         "Short press ignored (held %d ms, need %d ms for power action)",
-                         press_duration, LONG_PRESS_TIME);
-            }
-            button_active = false;
+        if(event == POWER_EVENT_SHORT_PRESS) {
+            ESP_LOGI(TAG,
+                     "Short press ignored (held %lu ms, need %lu ms for power action)",
+                     (unsigned long)logic.held_ms, (unsigned long)long_press_ms);
+            status->short_presses++;
         }
         
         /*
-         * LED INDICATION OF FINAL STATE:
+         * LED INDICATION:
+         *  - Press being timed → feedback blink (posted at PRESS)
          *  - SYSTEM_ON  → LED solid ON
          *  - SYSTEM_OFF → LED OFF
          *  (BOOTING/SHUTTING_DOWN blinks are handled in their sequences)
+         * Posting the same level again costs nothing.
          */
-        if(state == SYSTEM_ON) {
-            gpio_set_level(POWER_LED_PIN, 1);
-        } else if(state == SYSTEM_OFF && !button_active) {
-            gpio_set_level(POWER_LED_PIN, 0);
+        if(!logic.timing) {
+            panel_output_set(&self->led, state == SYSTEM_ON);
         }
         
-        last_level = level;
-        vTaskDelay(50 / portTICK_PERIOD_MS);  // Small delay per loop
+        task_monitor_loop_end(&loop_stats);
+        if(have_input) {
+            continue;  // Edge held back behind a long press: decide it right away
+        }
+        if(logic.timing) {
+            loop_timing_wait(sample_timing);  // Timing a press: check every 50ms
+        } else {
+            // Idle or waiting for the release after a long press
+            panel_pm_lock_hold(&pm_lock, false);
+            uint32_t wait_ms = power_logic_ms_to_deadline(&logic, now_ms);
+            input_bus_wait(&self->sub, wait_ms == DEBOUNCE_NO_DEADLINE ? PANEL_PM_WAIT_FOREVER : wait_ms);
+        }
     }
+
+    /*
+     * STOPPED (console "stop power"):
+     *  - Release light-sleep lock, input bus subscription, LED pin
+     *  - The retained power state is kept for the next start
+     */
+    panel_pm_lock_deinit(&pm_lock);
+    input_bus_unsubscribe(&self->sub);
+    panel_output_close(&self->led);
+    task_monitor_loop_unregister(&loop_stats);
+    event_log_add("power", "stopped", config->instance);
+    ESP_LOGW(TAG, "Power controller STOPPED (instance %d)", config->instance);
+    status->running = false;
+    self->active = false;
 }
  
\ No newline at end of file
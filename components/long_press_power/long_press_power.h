@@ -1,7 +1,10 @@
 #ifndef LONG_PRESS_POWER_H
 #define LONG_PRESS_POWER_H
 
+#include <stdbool.h>
 #include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -10,7 +13,7 @@
  * -------------------------------------
  * One push button used to safely power ON/OFF a controller or machine:
  *  - Short press  → ignored (safety: avoid accidental power change)
- *  - Long press   → 3 seconds hold required
+ *  - Long press   → 3 seconds hold required (long_press_ms)
  *      * If system OFF  → start BOOT sequence
  *      * If system ON   → start SHUTDOWN sequence
  * 
@@ -21,9 +24,6 @@
  *  - SHUTDOWN   → blinking countdown
  */
 
-#define POWER_BUTTON_PIN  GPIO_NUM_33   // Front-panel power button
-#define POWER_LED_PIN     GPIO_NUM_26    // Power status indicator LED
-
 // System states for trainees to understand lifecycle
 typedef enum {
     SYSTEM_OFF = 0,           // Controller fully powered down
@@ -32,7 +32,52 @@ typedef enum {
     SYSTEM_SHUTTING_DOWN = 3  // Graceful shutdown in progress
 } system_state_t;
 
-// Start the long-press power controller (blocking loop)
-void long_press_power_run(void);
+/*
+ * Per-instance pins and timing (defaults from menuconfig → "Long-Press Power").
+ * instance selects the retained-state slot: 0 .. CONFIG_LONG_PRESS_POWER_MAX_INSTANCES-1
+ */
+typedef struct {
+    gpio_num_t button_pin;     // Front-panel power button
+    gpio_num_t led_pin;        // Power status indicator LED
+    uint32_t debounce_ms;      // Contact bounce filter
+    uint32_t long_press_ms;    // Hold time for power ON / OFF
+    uint32_t hold_blink_ms;    // Feedback blink while the button is held
+    uint8_t instance;
+} long_press_power_config_t;
+
+#define LONG_PRESS_POWER_CONFIG_DEFAULT() {                     \
+    .button_pin = CONFIG_LONG_PRESS_POWER_BUTTON_GPIO,          \
+    .led_pin = CONFIG_LONG_PRESS_POWER_LED_GPIO,                \
+    .debounce_ms = CONFIG_LONG_PRESS_POWER_DEBOUNCE_MS,         \
+    .long_press_ms = CONFIG_LONG_PRESS_POWER_LONG_PRESS_MS,     \
+    .hold_blink_ms = CONFIG_LONG_PRESS_POWER_HOLD_BLINK_MS,     \
+    .instance = 0,                                              \
+}
+
+// Runtime status (console "status" command)
+typedef struct {
+    bool running;
+    system_state_t state;
+    uint32_t boot_cycles;      // Boot sequences since start
+    uint32_t short_presses;    // Presses released before long_press_ms
+} long_press_power_status_t;
+
+// Re-apply the retained power LED state first thing in app_main()
+void long_press_power_fast_restore(const long_press_power_config_t *config);
+
+// Run the long-press power controller in the calling task (blocks until long_press_power_stop())
+void long_press_power_run(const long_press_power_config_t *config);
+
+// Run the long-press power controller in its own FreeRTOS task (config is copied)
+esp_err_t long_press_power_start(const long_press_power_config_t *config);
+
+// Stop a running instance and release its pins (waits for a running boot / shutdown sequence)
+esp_err_t long_press_power_stop(uint8_t instance);
+
+// Virtual button press / release, overrides the physical input while pressed
+esp_err_t long_press_power_press(uint8_t instance, bool pressed);
+
+// Copy the runtime status of an instance
+esp_err_t long_press_power_get_status(uint8_t instance, long_press_power_status_t *status);
 
 #endif
@@ -0,0 +1,50 @@
+#include "power_logic.h"
+
+void power_logic_init(power_logic_t *logic, uint32_t debounce_ms, uint32_t long_press_ms)
+{
+    debounce_init(&logic->debounce, debounce_ms, false);
+    logic->long_press_ms = long_press_ms;
+    logic->timing = false;
+    logic->wait_release = false;
+    logic->press_start_ms = 0;
+    logic->held_ms = 0;
+}
+
+power_event_t power_logic_feed(power_logic_t *logic, bool raw_pressed, uint32_t now_ms)
+{
+    if (debounce_feed(&logic->debounce, raw_pressed, now_ms)) {
+        if (logic->debounce.stable_pressed) {
+            // Timed from the raw edge, as the operator felt the press
+            logic->timing = true;
+            logic->press_start_ms = logic->debounce.change_ms;
+            return POWER_EVENT_PRESS;
+        }
+        logic->wait_release = false;
+        if (logic->timing) {
+            logic->timing = false;
+            logic->held_ms = logic->debounce.change_ms - logic->press_start_ms;
+            return POWER_EVENT_SHORT_PRESS;
+        }
+        return POWER_EVENT_NONE;
+    }
+
+    if (logic->timing && now_ms - logic->press_start_ms >= logic->long_press_ms) {
+        logic->timing = false;
+        logic->wait_release = true;
+        return POWER_EVENT_LONG_PRESS;
+    }
+    return POWER_EVENT_NONE;
+}
+
+uint32_t power_logic_ms_to_deadline(const power_logic_t *logic, uint32_t now_ms)
+{
+    uint32_t wait_ms = debounce_ms_to_deadline(&logic->debounce, now_ms);
+    if (logic->timing) {
+        uint32_t elapsed_ms = now_ms - logic->press_start_ms;
+        uint32_t long_wait_ms = elapsed_ms >= logic->long_press_ms ? 0 : logic->long_press_ms - elapsed_ms;
+        if (long_wait_ms < wait_ms) {
+            wait_ms = long_wait_ms;
+        }
+    }
+    return wait_ms;
+}
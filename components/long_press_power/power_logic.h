@@ -0,0 +1,57 @@
+#ifndef POWER_LOGIC_H
+#define POWER_LOGIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "debounce.h"
+
+/*
+ * Long-Press Timing Logic
+ * -----------------------
+ * The decision part of the power controller, without GPIO, LED or
+ * FreeRTOS:
+ *  - Debounced press starts timing
+ *  - Held for long_press_ms → LONG_PRESS, exactly once per hold
+ *  - Released earlier        → SHORT_PRESS (ignored for safety)
+ *  - After a long press the rest of the hold is ignored until release
+ *    (no re-trigger, and no loop spinning on the pin while held)
+ * 
+ * long_press_power_run() drives it from the real button; the soak
+ * harness (panel_soak) drives it with millions of generated presses.
+ */
+
+typedef enum {
+    POWER_EVENT_NONE = 0,
+    POWER_EVENT_PRESS,        // Debounced press, timing started
+    POWER_EVENT_LONG_PRESS,   // Held long enough: toggle power
+    POWER_EVENT_SHORT_PRESS,  // Released before long_press_ms
+} power_event_t;
+
+typedef struct {
+    debounce_t debounce;
+    uint32_t long_press_ms;
+    bool timing;              // Press being timed
+    bool wait_release;        // Long press handled, hold ignored until release
+    uint32_t press_start_ms;  // Raw edge of the timed press
+    uint32_t held_ms;         // SHORT_PRESS: how long it was held
+} power_logic_t;
+
+void power_logic_init(power_logic_t *logic, uint32_t debounce_ms, uint32_t long_press_ms);
+
+/*
+ * @brief Feed the raw button level (true = pressed / LOW)
+ * 
+ * Reports at most one event per call. Call on every level change and
+ * when power_logic_ms_to_deadline() passed.
+ */
+power_event_t power_logic_feed(power_logic_t *logic, bool raw_pressed, uint32_t now_ms);
+
+/*
+ * @brief Milliseconds until the next feed is needed
+ * 
+ * @return 0 if due now, DEBOUNCE_NO_DEADLINE if only a level change can
+ *         produce the next event
+ */
+uint32_t power_logic_ms_to_deadline(const power_logic_t *logic, uint32_t now_ms);
+
+#endif
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+#include "loop_timing.h"
+#include "esp_timer.h"
+#include "esp_console.h"
+#include "esp_log.h"
+
+#define TAG "LOOP_TIMING"
+
+// Loops listed by the "jitter" command
+static loop_timing_t *loops[CONFIG_LOOP_TIMING_MAX_LOOPS];
+static int loop_count = 0;
+static portMUX_TYPE loops_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t loop_timing_init(loop_timing_t *lt, const char *name, uint32_t period_ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(period_ms);
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    lt->name = name;
+    lt->period_ticks = ticks;
+    lt->period_us = ticks * portTICK_PERIOD_MS * 1000;
+    lt->bucket_us = lt->period_us / (CONFIG_LOOP_TIMING_BUCKETS / 2);
+    if (lt->bucket_us == 0) {
+        lt->bucket_us = 1;
+    }
+    loop_timing_reset(lt);
+    loop_timing_restart(lt);
+
+    if (lt->period_us != period_ms * 1000) {
+        ESP_LOGW(TAG, "%s: %lu ms rounded to %lu ms (%lu ticks @ %d Hz)",
+                 name, (unsigned long)period_ms, (unsigned long)(lt->period_us / 1000),
+                 (unsigned long)ticks, CONFIG_FREERTOS_HZ);
+    }
+
+    // Listed once: a restarted controller re-initialises the same tracker
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&loops_lock);
+    for (int i = 0; i < loop_count; i++) {
+        if (loops[i] == lt) {
+            err = ESP_OK;
+        }
+    }
+    if (err != ESP_OK && loop_count < CONFIG_LOOP_TIMING_MAX_LOOPS) {
+        loops[loop_count++] = lt;
+        err = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&loops_lock);
+    return err;
+}
+
+void loop_timing_restart(loop_timing_t *lt)
+{
+    lt->last_wake = xTaskGetTickCount();
+    lt->last_us = esp_timer_get_time();
+}
+
+void loop_timing_reset(loop_timing_t *lt)
+{
+    lt->min_us = UINT32_MAX;
+    lt->max_us = 0;
+    lt->samples = 0;
+    lt->misses = 0;
+    memset(lt->hist, 0, sizeof(lt->hist));
+}
+
+bool loop_timing_wait(loop_timing_t *lt)
+{
+    bool on_time = xTaskDelayUntil(&lt->last_wake, lt->period_ticks) == pdTRUE;
+    int64_t now_us = esp_timer_get_time();
+
+    if (!on_time) {
+        lt->misses++;
+    }
+    uint32_t period_us = (uint32_t)(now_us - lt->last_us);
+    uint32_t bucket = period_us / lt->bucket_us;
+    if (bucket >= CONFIG_LOOP_TIMING_BUCKETS) {
+        bucket = CONFIG_LOOP_TIMING_BUCKETS;  // Overflow: > 2 x period
+    }
+    if (lt->hist[bucket] < UINT16_MAX) {
+        lt->hist[bucket]++;
+    }
+    if (period_us < lt->min_us) {
+        lt->min_us = period_us;
+    }
+    if (period_us > lt->max_us) {
+        lt->max_us = period_us;
+    }
+    lt->samples++;
+    lt->last_us = now_us;
+    return on_time;
+}
+
+uint32_t loop_timing_percentile_us(const loop_timing_t *lt, uint32_t permille)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < LOOP_TIMING_NUM_BUCKETS; i++) {
+        total += lt->hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    // Smallest bucket edge with at least permille of the samples below it
+    uint32_t needed = (uint32_t)(((uint64_t)total * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (int i = 0; i < CONFIG_LOOP_TIMING_BUCKETS; i++) {
+        seen += lt->hist[i];
+        if (seen >= needed) {
+            uint32_t edge_us = (i + 1) * lt->bucket_us;
+            return edge_us < lt->max_us ? edge_us : lt->max_us;
+        }
+    }
+    return lt->max_us;  // In the overflow bucket
+}
+
+void loop_timing_print(void)
+{
+    printf("%-14s %8s %8s %8s %8s %8s %6s\n",
+           "LOOP", "PERIOD", "MIN", "P99", "MAX", "SAMPLES", "MISSES");
+    int count = __atomic_load_n(&loop_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        const loop_timing_t *lt = loops[i];
+        printf("%-14s %8lu %8lu %8lu %8lu %8lu %6lu\n", lt->name,
+               (unsigned long)lt->period_us,
+               (unsigned long)(lt->samples ? lt->min_us : 0),
+               (unsigned long)loop_timing_percentile_us(lt, 990),
+               (unsigned long)lt->max_us,
+               (unsigned long)lt->samples,
+               (unsigned long)lt->misses);
+    }
+    printf("(all times in us, tick = %d ms)\n", (int)portTICK_PERIOD_MS);
+}
+
+esp_err_t loop_timing_print_histogram(const char *name)
+{
+    int count = __atomic_load_n(&loop_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        const loop_timing_t *lt = loops[i];
+        if (strcmp(lt->name, name) != 0) {
+            continue;
+        }
+        printf("%s: period %lu us, bucket %lu us\n", lt->name,
+               (unsigned long)lt->period_us, (unsigned long)lt->bucket_us);
+        for (int b = 0; b < LOOP_TIMING_NUM_BUCKETS; b++) {
+            if (lt->hist[b] == 0) {
+                continue;  // Only the occupied buckets
+            }
+            if (b == CONFIG_LOOP_TIMING_BUCKETS) {
+                printf("  >= %7lu us: %u\n", (unsigned long)(b * lt->bucket_us), lt->hist[b]);
+            } else {
+                printf("  %7lu..%-7lu us: %u\n", (unsigned long)(b * lt->bucket_us),
+                       (unsigned long)((b + 1) * lt->bucket_us), lt->hist[b]);
+            }
+        }
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static int cmd_jitter(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "hist") == 0) {
+        if (loop_timing_print_histogram(argv[2]) != ESP_OK) {
+            printf("No loop named '%s'\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        int count = __atomic_load_n(&loop_count, __ATOMIC_ACQUIRE);
+        for (int i = 0; i < count; i++) {
+            loop_timing_reset(loops[i]);
+        }
+        printf("Loop timing statistics cleared\n");
+        return 0;
+    }
+    loop_timing_print();
+    return 0;
+}
+
+esp_err_t loop_timing_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "jitter",
+        .help = "Period min/p99/max and deadline misses of periodic loops. "
+                "'jitter hist <loop>' = histogram, 'jitter reset' clears all",
+        .hint = "[reset | hist <loop>]",
+        .func = &cmd_jitter,
+    };
+    return esp_console_cmd_register(&cmd);
+}
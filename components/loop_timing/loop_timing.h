@@ -0,0 +1,84 @@
+#ifndef LOOP_TIMING_H
+#define LOOP_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/*
+ * Periodic Loop Timing
+ * --------------------
+ * vTaskDelay(50 ms) waits 50 ms AFTER the work of the iteration, so the
+ * real period is 50 ms + work + preemption - and it drifts.
+ * xTaskDelayUntil() waits until a fixed wake time instead:
+ *
+ *   vTaskDelay:      |work|--50--|work|--50--|      period = 50 + work
+ *   xTaskDelayUntil: |work|--45--|work|--45--|      period = 50
+ *
+ * This helper wraps xTaskDelayUntil() and measures every period:
+ *  - min / max / p99 (histogram, no sorting, no heap)
+ *  - deadline misses: the loop was still busy when the next period
+ *    should already have started
+ *
+ * The period is rounded to whole ticks (CONFIG_FREERTOS_HZ); the
+ * rounding is logged at init so it is never a surprise.
+ */
+
+#define LOOP_TIMING_NUM_BUCKETS  (CONFIG_LOOP_TIMING_BUCKETS + 1)  // + overflow
+
+typedef struct {
+    const char *name;
+    TickType_t period_ticks;
+    uint32_t period_us;          // Nominal period after tick rounding
+    uint32_t bucket_us;          // Histogram bucket width
+    TickType_t last_wake;        // xTaskDelayUntil reference
+    int64_t last_us;             // Previous wake-up (or phase start)
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t samples;
+    uint32_t misses;
+    uint16_t hist[LOOP_TIMING_NUM_BUCKETS];
+} loop_timing_t;
+
+/*
+ * @brief Prepare a periodic loop tracker and list it for "jitter"
+ *
+ * The tracker stays listed forever: use static storage.
+ * @param period_ms  rounded to whole ticks (minimum 1 tick)
+ */
+esp_err_t loop_timing_init(loop_timing_t *lt, const char *name, uint32_t period_ms);
+
+/*
+ * @brief Start a new periodic phase now
+ *
+ * Call when the loop switches from "wait for event" to periodic
+ * sampling. The gap since the last phase is not counted as a period.
+ */
+void loop_timing_restart(loop_timing_t *lt);
+
+/*
+ * @brief Sleep until the next period starts and record the period
+ *
+ * @return false if the deadline was already missed (no delay happened)
+ */
+bool loop_timing_wait(loop_timing_t *lt);
+
+// Period percentile from the histogram (upper bucket edge), e.g. 990 = p99
+uint32_t loop_timing_percentile_us(const loop_timing_t *lt, uint32_t permille);
+
+// Clear statistics (keeps the period)
+void loop_timing_reset(loop_timing_t *lt);
+
+// Print one line per registered loop
+void loop_timing_print(void);
+
+// Print the period histogram of one loop (ESP_ERR_NOT_FOUND if no such name)
+esp_err_t loop_timing_print_histogram(const char *name);
+
+// Add the "jitter" command (print, "jitter reset" clears all)
+esp_err_t loop_timing_register_console(void);
+
+#endif
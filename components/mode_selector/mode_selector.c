@@ -1,85 +1,308 @@
 #include <stdio.h>
 #include "mode_selector.h"
+#include "fast_boot.h"
+#include "gesture.h"
+#include "panel_pm.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "task_monitor.h"
+#include "event_log.h"
 #include "esp_log.h"
 
 #define TAG "MODE_SELECTOR"
 
-#define DEBOUNCE_DELAY 50  // 50ms debounce
+// Debounce, click window and long-press time: mode_selector_config_t
+
+#define MODE_SELECTOR_TASK_STACK    3072
+#define MODE_SELECTOR_TASK_PRIORITY 5
+#define MODE_SELECTOR_STOP_TIMEOUT_MS 1000
 
 // Mode names for logging
 static const char* mode_names[] = {"MANUAL", "AUTO", "MAINTENANCE"};
 
-void mode_selector_run(void)
+// Last selected mode per instance, kept in RTC memory across soft resets
+static FAST_BOOT_SLOT_ATTR fast_boot_slot_t retained_mode[CONFIG_MODE_SELECTOR_MAX_INSTANCES];
+
+// Runtime state per instance (static: read / driven by the console)
+typedef struct {
+    mode_selector_config_t config;  // Copy used by the running loop
+    TaskHandle_t task;
+    input_bus_sub_t sub;            // Button events
+    panel_output_t led;             // Status LED, lowest priority
+    volatile bool active;
+    volatile bool stop_requested;
+    mode_selector_status_t status;
+} mode_selector_instance_t;
+
+static mode_selector_instance_t instances[CONFIG_MODE_SELECTOR_MAX_INSTANCES];
+
+static bool config_valid(const mode_selector_config_t *config)
+{
+    return config && config->instance < CONFIG_MODE_SELECTOR_MAX_INSTANCES &&
+           GPIO_IS_VALID_GPIO(config->button_pin) &&
+           GPIO_IS_VALID_OUTPUT_GPIO(config->status_led_pin);
+}
+
+// Returns the retained mode, or MANUAL after a cold start
+static operation_mode_t load_retained_mode(fast_boot_slot_t *slot)
+{
+    uint32_t value;
+    if (fast_boot_slot_load(slot, &value) && value <= MODE_MAINTENANCE) {
+        return (operation_mode_t)value;
+    }
+    return MODE_MANUAL;
+}
+
+void mode_selector_fast_restore(const mode_selector_config_t *config)
+{
+    uint32_t value;
+    if (!config_valid(config) || !fast_boot_slot_load(&retained_mode[config->instance], &value)) {
+        return;
+    }
+
+    // Start the blink cycle with LED ON so the operator sees life at once
+    panel_output_restore(config->status_led_pin, true);
+}
+
+static void mode_selector_task(void *arg)
+{
+    mode_selector_run((const mode_selector_config_t *)arg);
+    vTaskDelete(NULL);  // Stopped
+}
+
+esp_err_t mode_selector_start(const mode_selector_config_t *config)
 {
-    // Configure button as input with pull-up
-    gpio_reset_pin(MODE_BUTTON_PIN);
-    gpio_set_direction(MODE_BUTTON_PIN, GPIO_MODE_INPUT);
-    gpio_set_pull_mode(MODE_BUTTON_PIN, GPIO_PULLUP_ONLY);
+    if (!config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mode_selector_instance_t *self = &instances[config->instance];
+    if (self->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    self->config = *config;
+    self->stop_requested = false;
+    self->active = true;
+    if (xTaskCreate(mode_selector_task, "mode_selector", MODE_SELECTOR_TASK_STACK,
+                    &self->config, MODE_SELECTOR_TASK_PRIORITY, &self->task) != pdPASS) {
+        self->active = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mode_selector_stop(uint8_t instance)
+{
+    if (instance >= CONFIG_MODE_SELECTOR_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mode_selector_instance_t *self = &instances[instance];
+    if (!self->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    self->stop_requested = true;
+    xTaskNotifyGive(self->task);
+    for (int waited_ms = 0; self->active; waited_ms += 10) {
+        if (waited_ms >= MODE_SELECTOR_STOP_TIMEOUT_MS) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
 
-    // Configure status LED as output
-    gpio_reset_pin(MODE_STATUS_LED);
-    gpio_set_direction(MODE_STATUS_LED, GPIO_MODE_OUTPUT);
+esp_err_t mode_selector_press(uint8_t instance, bool pressed)
+{
+    if (instance >= CONFIG_MODE_SELECTOR_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!instances[instance].status.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return input_bus_inject(instances[instance].config.button_pin, pressed);
+}
+
+esp_err_t mode_selector_get_status(uint8_t instance, mode_selector_status_t *status)
+{
+    if (instance >= CONFIG_MODE_SELECTOR_MAX_INSTANCES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *status = instances[instance].status;
+    return ESP_OK;
+}
+
+// Half blink period per mode: slow / medium / fast
+static uint32_t blink_half_period(operation_mode_t mode)
+{
+    switch (mode) {
+        case MODE_MANUAL:      return 1000;
+        case MODE_AUTO:        return 500;
+        case MODE_MAINTENANCE: return 200;
+        default:               return 1000;
+    }
+}
+
+/*
+ * GESTURE → MODE:
+ *  - 1 click   → MANUAL
+ *  - 2 clicks  → AUTO
+ *  - 3+ clicks → MAINTENANCE
+ *  - Long press → only log the current mode (no change)
+ * Returns true if the mode changed.
+ */
+static bool apply_gesture(const gesture_event_t *event, operation_mode_t *mode, fast_boot_slot_t *retained)
+{
+    operation_mode_t requested;
+
+    switch (event->type) {
+        case GESTURE_CLICK:
+            if (event->clicks == 1) {
+                requested = MODE_MANUAL;
+            } else if (event->clicks == 2) {
+                requested = MODE_AUTO;
+            } else {
+                requested = MODE_MAINTENANCE;
+            }
+            break;
+        case GESTURE_LONG_PRESS:
+            ESP_LOGI(TAG, "Current mode: %s", mode_names[*mode]);
+            return false;
+        default:
+            return false;
+    }
+
+    ESP_LOGI(TAG, "%d click(s) detected", event->clicks);
+    if (requested == *mode) {
+        ESP_LOGI(TAG, "Already in mode: %s", mode_names[*mode]);
+        return false;
+    }
+
+    *mode = requested;
+    fast_boot_slot_store(retained, *mode);
+    event_log_add("mode_selector", mode_names[*mode], event->clicks);
+    ESP_LOGI(TAG, "Mode changed to: %s", mode_names[*mode]);
+    return true;
+}
+
+void mode_selector_run(const mode_selector_config_t *config)
+{
+    if (!config_valid(config)) {
+        ESP_LOGE(TAG, "Invalid mode selector config");
+        return;
+    }
+    mode_selector_instance_t *self = &instances[config->instance];
+    if (config != &self->config) {
+        self->config = *config;  // Called directly, not through mode_selector_start()
+        self->stop_requested = false;
+    }
+    config = &self->config;
+    self->task = xTaskGetCurrentTaskHandle();
+    self->active = true;
+    const gpio_num_t button_pin = config->button_pin;
+    const gpio_num_t status_led_pin = config->status_led_pin;
+    fast_boot_slot_t *retained = &retained_mode[config->instance];
+
+    /*
+     * Status LED through the output manager (status priority):
+     * an alarm or power pattern on the same pin shows over it.
+     */
+    if (panel_output_open(&self->led, status_led_pin, PANEL_OUTPUT_PRIO_STATUS, "mode_selector") != ESP_OK) {
+        ESP_LOGE(TAG, "Status LED GPIO %d not available", status_led_pin);
+        self->active = false;
+        return;
+    }
+
+    // Button (input with pull-up) is configured and debounced by the input bus
+    if (input_bus_subscribe(&self->sub, button_pin, config->debounce_ms, "mode_selector") != ESP_OK) {
+        ESP_LOGE(TAG, "Mode button GPIO %d not available", button_pin);
+        panel_output_close(&self->led);
+        self->active = false;
+        return;
+    }
 
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "Industrial Machine Mode Selector Ready");
+    ESP_LOGI(TAG, "Industrial Machine Mode Selector Ready (instance %d)", config->instance);
     ESP_LOGI(TAG, "Button: GPIO %d  |  LED: GPIO %d",
-             MODE_BUTTON_PIN, MODE_STATUS_LED);
-    ESP_LOGI(TAG, "Each valid press = switch to NEXT mode:");
-    ESP_LOGI(TAG, "  MANUAL  → AUTO → MAINTENANCE → MANUAL ...");
+             button_pin, status_led_pin);
+    ESP_LOGI(TAG, "Click the button to SELECT a mode directly:");
+    ESP_LOGI(TAG, "  1 click  → MANUAL");
+    ESP_LOGI(TAG, "  2 clicks → AUTO");
+    ESP_LOGI(TAG, "  3 clicks → MAINTENANCE");
+    ESP_LOGI(TAG, "Long press = report current mode");
     ESP_LOGI(TAG, "========================================");
 
-    operation_mode_t current_mode = MODE_MANUAL;
-    int last_state = 1;  // HIGH initially (pull-up)
-
-    while (1) {
-        int current_state = gpio_get_level(MODE_BUTTON_PIN);
-
-        // Detect falling edge (released -> pressed) with debounce
-        if (last_state == 1 && current_state == 0) {
-            vTaskDelay(DEBOUNCE_DELAY / portTICK_PERIOD_MS);
-            current_state = gpio_get_level(MODE_BUTTON_PIN);
-
-            if (current_state == 0) {
-                // ONE confirmed press → move to next mode
-                if (current_mode == MODE_MANUAL) {
-                    current_mode = MODE_AUTO;
-                } else if (current_mode == MODE_AUTO) {
-                    current_mode = MODE_MAINTENANCE;
-                } else {
-                    current_mode = MODE_MANUAL;
-                }
-
-                ESP_LOGI(TAG, "Mode changed to: %s", mode_names[current_mode]);
-
-                // Small feedback blink on change
-                gpio_set_level(MODE_STATUS_LED, 1);
-                vTaskDelay(100 / portTICK_PERIOD_MS);
-                gpio_set_level(MODE_STATUS_LED, 0);
-            }
-        }
+    fast_boot_mark("mode loop ready");
+    fast_boot_report();
+
+    operation_mode_t current_mode = load_retained_mode(retained);
+
+    ESP_LOGI(TAG, "Starting in mode: %s", mode_names[current_mode]);
 
-        // Show mode with blink rate (runs continuously)
-        int blink_delay;
-        switch (current_mode) {
-            case MODE_MANUAL:      // slow
-                blink_delay = 1000;
-                break;
-            case MODE_AUTO:        // medium
-                blink_delay = 500;
-                break;
-            case MODE_MAINTENANCE: // fast
-                blink_delay = 200;
-                break;
-            default:
-                blink_delay = 1000;
-                break;
+    /*
+     * GESTURE RECOGNIZER:
+     * -------------------
+     * The loop never waits for "the next click". It only:
+     *  1. Wakes on a button event or when a deadline passed
+     *  2. Takes the debounced edge from the input bus (stable for debounce_ms)
+     *  3. Feeds clean edges + timestamps into the gesture recognizer
+     * The recognizer decides when a click sequence is complete.
+     */
+    gesture_config_t gesture_cfg = GESTURE_CONFIG_DEFAULT();
+    gesture_cfg.click_window_ms = config->click_window_ms;
+    gesture_cfg.long_press_ms = config->long_press_ms;
+    gesture_t gesture;
+    gesture_init(&gesture, &gesture_cfg);
+    gesture_event_t event;
+
+    // Button events wake this loop (the bus task wakes the chip from light sleep)
+    panel_pm_wake_counter_t wakes = PANEL_PM_WAKE_COUNTER("mode_selector");
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "mode_selector");
+
+    // Status LED: blinked by LEDC hardware or the output manager task
+    panel_output_blink(&self->led, blink_half_period(current_mode));
+    self->status = (mode_selector_status_t){ .running = true, .mode = current_mode };
+
+    while (!self->stop_requested) {
+        panel_pm_wake_count(&wakes);
+        task_monitor_loop_begin(&loop_stats);
+
+        uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        input_event_t input;
+        bool mode_changed = false;
+
+        // One debounced edge per iteration; glitches never reach the recognizer
+        if (input_bus_receive(&self->sub, &input) && input.type != INPUT_EVENT_GLITCH &&
+            gesture_feed(&gesture, input.type == INPUT_EVENT_PRESS, input.time_ms, &event)) {
+            mode_changed |= apply_gesture(&event, &current_mode, retained);
+        }
+        while (gesture_poll(&gesture, now_ms, &event)) {
+            mode_changed |= apply_gesture(&event, &current_mode, retained);
         }
 
-        gpio_set_level(MODE_STATUS_LED, 1);
-        vTaskDelay(blink_delay / portTICK_PERIOD_MS);
-        gpio_set_level(MODE_STATUS_LED, 0);
-        vTaskDelay(blink_delay / portTICK_PERIOD_MS);
+        if (mode_changed) {
+            self->status.mode = current_mode;
+            self->status.changes++;
+            // Feedback: new blink speed starts with LED ON
+            panel_output_blink(&self->led, blink_half_period(current_mode));
+        }
 
-        last_state = current_state;
+        /*
+         * SLEEP UNTIL THE NEXT THING TO DO:
+         *  - Gesture deadline (click window / long press)
+         * A button event wakes us earlier (at once if more are queued).
+         * LED toggles no longer wake this loop.
+         */
+        uint32_t wait_ms = gesture_ms_to_deadline(&gesture, now_ms);
+        task_monitor_loop_end(&loop_stats);
+        input_bus_wait(&self->sub, wait_ms == GESTURE_NO_DEADLINE ? PANEL_PM_WAIT_FOREVER : wait_ms);
     }
+
+    // Stopped: leave the input bus and output manager, release monitor entry
+    input_bus_unsubscribe(&self->sub);
+    panel_output_close(&self->led);
+    task_monitor_loop_unregister(&loop_stats);
+    event_log_add("mode_selector", "stopped", config->instance);
+    ESP_LOGW(TAG, "Mode selector STOPPED (instance %d)", config->instance);
+    self->status.running = false;
+    self->active = false;
 }
@@ -1,7 +1,10 @@
 #ifndef MODE_SELECTOR_H
 #define MODE_SELECTOR_H
 
+#include <stdbool.h>
 #include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -14,12 +17,12 @@
  *  - 3+ presses → MAINTENANCE mode
  * 
  * LED indicates current mode using different blink speeds.
+ * 
+ * Clicks are counted by the gesture recognizer (gesture.h):
+ * a sequence ends when no new press follows within the click window,
+ * then the mode is selected directly (no cycling through modes).
  */
 
-// Button and LED pins (can be shared with other modules if needed)
-#define MODE_BUTTON_PIN  GPIO_NUM_18   // Front-panel mode select push button
-#define MODE_STATUS_LED  GPIO_NUM_2    // Panel status indicator LED
-
 // Human-readable machine modes
 typedef enum {
     MODE_MANUAL = 0,        // Operator controlled
@@ -27,7 +30,51 @@ typedef enum {
     MODE_MAINTENANCE = 2    // Service/maintenance
 } operation_mode_t;
 
-// Start the mode selector application (blocking loop)
-void mode_selector_run(void);
+/*
+ * Per-instance pins and timing (defaults from menuconfig → "Mode Selector").
+ * instance selects the retained-mode slot: 0 .. CONFIG_MODE_SELECTOR_MAX_INSTANCES-1
+ */
+typedef struct {
+    gpio_num_t button_pin;     // Front-panel mode select push button
+    gpio_num_t status_led_pin; // Panel status indicator LED
+    uint32_t debounce_ms;      // Level must be stable this long
+    uint32_t click_window_ms;  // Max pause between clicks of one sequence
+    uint32_t long_press_ms;    // Hold time for "report current mode"
+    uint8_t instance;
+} mode_selector_config_t;
+
+#define MODE_SELECTOR_CONFIG_DEFAULT() {                        \
+    .button_pin = CONFIG_MODE_SELECTOR_BUTTON_GPIO,             \
+    .status_led_pin = CONFIG_MODE_SELECTOR_STATUS_LED_GPIO,     \
+    .debounce_ms = CONFIG_MODE_SELECTOR_DEBOUNCE_MS,            \
+    .click_window_ms = CONFIG_MODE_SELECTOR_CLICK_WINDOW_MS,    \
+    .long_press_ms = CONFIG_MODE_SELECTOR_LONG_PRESS_MS,        \
+    .instance = 0,                                              \
+}
+
+// Runtime status (console "status" command)
+typedef struct {
+    bool running;
+    operation_mode_t mode;
+    uint32_t changes;          // Mode changes since start
+} mode_selector_status_t;
+
+// Re-apply the retained mode indication first thing in app_main()
+void mode_selector_fast_restore(const mode_selector_config_t *config);
+
+// Run the mode selector in the calling task (blocks until mode_selector_stop())
+void mode_selector_run(const mode_selector_config_t *config);
+
+// Run the mode selector in its own FreeRTOS task (config is copied)
+esp_err_t mode_selector_start(const mode_selector_config_t *config);
+
+// Stop a running instance and release its pins (waits up to 1 s)
+esp_err_t mode_selector_stop(uint8_t instance);
+
+// Virtual button press / release, overrides the physical input while pressed
+esp_err_t mode_selector_press(uint8_t instance, bool pressed);
+
+// Copy the runtime status of an instance
+esp_err_t mode_selector_get_status(uint8_t instance, mode_selector_status_t *status);
 
 #endif
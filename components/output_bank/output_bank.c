@@ -0,0 +1,47 @@
+#include "output_bank.h"
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "gpio_sim.h"
+#else
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+#include "soc/gpio_reg.h"
+#endif
+
+void output_bank_commit(output_bank_t *bank)
+{
+    uint64_t set_mask = bank->set_mask;
+    uint64_t clear_mask = bank->clear_mask;
+    if ((set_mask | clear_mask) == 0) {
+        return;
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    gpio_sim_write_masks(set_mask, clear_mask);
+#else
+    /*
+     * W1TS / W1TC: "write 1 to set / clear". Bits written as 0 leave
+     * their pin alone, so no read-modify-write and no lock against
+     * other writers (e.g. the E-STOP latch in its interrupt).
+     */
+    if ((uint32_t)set_mask) {
+        REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)set_mask);
+    }
+    if ((uint32_t)clear_mask) {
+        REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)clear_mask);
+    }
+#if SOC_GPIO_PIN_COUNT > 32
+    // Upper pins (32 ..) live in the second output register
+    if (set_mask >> 32) {
+        REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(set_mask >> 32));
+    }
+    if (clear_mask >> 32) {
+        REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(clear_mask >> 32));
+    }
+#endif
+#endif
+
+    bank->set_mask = 0;
+    bank->clear_mask = 0;
+    bank->commits++;
+}
@@ -0,0 +1,63 @@
+#ifndef OUTPUT_BANK_H
+#define OUTPUT_BANK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+
+/*
+ * Output Bank (batched GPIO writes)
+ * ---------------------------------
+ * gpio_set_level() checks its arguments and does one HAL call per pin.
+ * A panel with many lamps updates many pins per pass, and each one
+ * changes at a slightly different moment.
+ *
+ * An output bank collects the levels of one pass and commits them
+ * together:
+ *  - output_bank_stage()  → only sets / clears a bit in RAM
+ *  - output_bank_commit() → one write to GPIO_OUT_W1TS (pins going HIGH)
+ *                           and one to GPIO_OUT_W1TC (pins going LOW),
+ *                           per 32-pin half of the GPIO matrix
+ * Pins in the same commit change within a few CPU cycles of each other,
+ * and pins not staged are not touched at all (no read-modify-write).
+ *
+ * Pins must already be configured as GPIO outputs.
+ * Linux host build: the commit goes to gpio_sim_write_masks(), which
+ * records the masks for tests.
+ *
+ * Not thread-safe: one owner (e.g. the output manager task) per bank.
+ */
+
+typedef struct {
+    uint64_t set_mask;     // Staged HIGH
+    uint64_t clear_mask;   // Staged LOW
+    uint32_t commits;      // Register writes done (statistics)
+    uint32_t staged;       // Pin levels staged since start (statistics)
+} output_bank_t;
+
+#define OUTPUT_BANK_INIT()  { .set_mask = 0, .clear_mask = 0, .commits = 0, .staged = 0 }
+
+// Stage a level; the last stage of a pin before the commit wins
+static inline void output_bank_stage(output_bank_t *bank, gpio_num_t pin, bool level)
+{
+    uint64_t bit = 1ULL << pin;
+    if (level) {
+        bank->set_mask |= bit;
+        bank->clear_mask &= ~bit;
+    } else {
+        bank->clear_mask |= bit;
+        bank->set_mask &= ~bit;
+    }
+    bank->staged++;
+}
+
+// True if nothing is waiting for a commit
+static inline bool output_bank_empty(const output_bank_t *bank)
+{
+    return (bank->set_mask | bank->clear_mask) == 0;
+}
+
+// Write all staged levels and start over (does nothing if empty)
+void output_bank_commit(output_bank_t *bank);
+
+#endif
@@ -0,0 +1,464 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "panel_console.h"
+#include "emergency.h"
+#include "mode_selector.h"
+#include "long_press_power.h"
+#include "task_monitor.h"
+#include "loop_timing.h"
+#include "event_log.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "panel_manager.h"
+#include "led_anim.h"
+#include "led_dither.h"
+#include "panel_soak.h"
+#include "tower_light.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "led_strip_sim.h"
+#endif
+#if CONFIG_PANEL_CONSOLE_UART_WAKEUP
+#include "driver/uart.h"
+#include "esp_sleep.h"
+#endif
+
+#define TAG "PANEL_CONSOLE"
+
+#define CONSOLE_PROMPT        "panel> "
+#define CONSOLE_TASK_STACK    4096
+#define CONSOLE_TASK_PRIORITY 2     // Below every controller task
+#define CONSOLE_LINE_MAX      256
+#define DEFAULT_PRESS_MS      100
+
+// Controllers the commands can address
+typedef enum {
+    CTRL_EMERGENCY,
+    CTRL_MODE,
+    CTRL_POWER,
+    CTRL_NONE,
+} ctrl_t;
+
+static const char *ctrl_names[] = { "emergency", "mode", "power" };
+
+static ctrl_t parse_ctrl(const char *name)
+{
+    for (int i = 0; i < CTRL_NONE; i++) {
+        if (strcmp(name, ctrl_names[i]) == 0) {
+            return (ctrl_t)i;
+        }
+    }
+    printf("Unknown controller '%s' (emergency | mode | power)\n", name);
+    return CTRL_NONE;
+}
+
+// Optional numeric argument, default if missing; false if not a number
+static bool parse_uint(int argc, char **argv, int index, uint32_t def, uint32_t *out)
+{
+    if (index >= argc) {
+        *out = def;
+        return true;
+    }
+    char *end;
+    unsigned long value = strtoul(argv[index], &end, 0);
+    if (*argv[index] == '\0' || *end != '\0') {
+        printf("'%s' is not a number\n", argv[index]);
+        return false;
+    }
+    *out = (uint32_t)value;
+    return true;
+}
+
+// Instance number: 0 default, range checked by the controller itself
+static bool parse_instance(int argc, char **argv, int index, uint32_t *out)
+{
+    if (!parse_uint(argc, argv, index, 0, out)) {
+        return false;
+    }
+    if (*out > UINT8_MAX) {
+        printf("Instance %lu out of range\n", (unsigned long)*out);
+        return false;
+    }
+    return true;
+}
+
+static int report(esp_err_t err, const char *action, ctrl_t ctrl, uint32_t instance)
+{
+    if (err == ESP_OK) {
+        printf("%s %s #%lu: OK\n", ctrl_names[ctrl], action, (unsigned long)instance);
+        return 0;
+    }
+    printf("%s %s #%lu failed: %s\n", ctrl_names[ctrl], action, (unsigned long)instance,
+           err == ESP_ERR_INVALID_STATE ? (strcmp(action, "start") == 0 ? "already running" : "not running")
+                                        : esp_err_to_name(err));
+    return 1;
+}
+
+/*
+ * start <ctrl> [instance] [button_gpio led_gpio]
+ *  - Defaults from menuconfig, pins only replaced when both are given
+ */
+static int cmd_start(int argc, char **argv)
+{
+    uint32_t instance, button_gpio, led_gpio;
+    if (argc < 2 || argc == 4 || argc > 5) {
+        printf("Usage: start <emergency|mode|power> [instance] [button_gpio led_gpio]\n");
+        return 1;
+    }
+    ctrl_t ctrl = parse_ctrl(argv[1]);
+    if (ctrl == CTRL_NONE || !parse_instance(argc, argv, 2, &instance) ||
+        !parse_uint(argc, argv, 3, 0, &button_gpio) || !parse_uint(argc, argv, 4, 0, &led_gpio)) {
+        return 1;
+    }
+    bool pins_given = (argc == 5);
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+
+    switch (ctrl) {
+        case CTRL_EMERGENCY: {
+            emergency_config_t config = EMERGENCY_CONFIG_DEFAULT();
+            config.instance = instance;
+            if (pins_given) {
+                config.button_pin = button_gpio;
+                config.alarm_led_pin = led_gpio;
+            }
+            err = emergency_alarm_start(&config);
+            break;
+        }
+        case CTRL_MODE: {
+            mode_selector_config_t config = MODE_SELECTOR_CONFIG_DEFAULT();
+            config.instance = instance;
+            if (pins_given) {
+                config.button_pin = button_gpio;
+                config.status_led_pin = led_gpio;
+            }
+            err = mode_selector_start(&config);
+            break;
+        }
+        case CTRL_POWER: {
+            long_press_power_config_t config = LONG_PRESS_POWER_CONFIG_DEFAULT();
+            config.instance = instance;
+            if (pins_given) {
+                config.button_pin = button_gpio;
+                config.led_pin = led_gpio;
+            }
+            err = long_press_power_start(&config);
+            break;
+        }
+        default:
+            break;
+    }
+    return report(err, "start", ctrl, instance);
+}
+
+static esp_err_t ctrl_stop(ctrl_t ctrl, uint8_t instance)
+{
+    switch (ctrl) {
+        case CTRL_EMERGENCY: return emergency_alarm_stop(instance);
+        case CTRL_MODE:      return mode_selector_stop(instance);
+        case CTRL_POWER:     return long_press_power_stop(instance);
+        default:             return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static esp_err_t ctrl_press(ctrl_t ctrl, uint8_t instance, bool pressed)
+{
+    switch (ctrl) {
+        case CTRL_EMERGENCY: return emergency_alarm_press(instance, pressed);
+        case CTRL_MODE:      return mode_selector_press(instance, pressed);
+        case CTRL_POWER:     return long_press_power_press(instance, pressed);
+        default:             return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// stop <ctrl> [instance]
+static int cmd_stop(int argc, char **argv)
+{
+    uint32_t instance;
+    if (argc < 2 || argc > 3) {
+        printf("Usage: stop <emergency|mode|power> [instance]\n");
+        return 1;
+    }
+    ctrl_t ctrl = parse_ctrl(argv[1]);
+    if (ctrl == CTRL_NONE || !parse_instance(argc, argv, 2, &instance)) {
+        return 1;
+    }
+    return report(ctrl_stop(ctrl, instance), "stop", ctrl, instance);
+}
+
+/*
+ * press <ctrl> [ms] [instance]
+ *  - Holds the virtual button for ms, then releases it
+ *  - Blocks the console meanwhile (like a finger on the button)
+ */
+static int cmd_press(int argc, char **argv)
+{
+    uint32_t hold_ms, instance;
+    if (argc < 2 || argc > 4) {
+        printf("Usage: press <emergency|mode|power> [ms] [instance]\n");
+        return 1;
+    }
+    ctrl_t ctrl = parse_ctrl(argv[1]);
+    if (ctrl == CTRL_NONE || !parse_uint(argc, argv, 2, DEFAULT_PRESS_MS, &hold_ms) ||
+        !parse_instance(argc, argv, 3, &instance)) {
+        return 1;
+    }
+
+    esp_err_t err = ctrl_press(ctrl, instance, true);
+    if (err != ESP_OK) {
+        return report(err, "press", ctrl, instance);
+    }
+    event_log_add("console", "press", hold_ms);
+    vTaskDelay(pdMS_TO_TICKS(hold_ms));
+    return report(ctrl_press(ctrl, instance, false), "press", ctrl, instance);
+}
+
+static const char *mode_name(operation_mode_t mode)
+{
+    static const char *names[] = { "MANUAL", "AUTO", "MAINTENANCE" };
+    return mode <= MODE_MAINTENANCE ? names[mode] : "?";
+}
+
+static const char *power_state_name(system_state_t state)
+{
+    static const char *names[] = { "OFF", "BOOTING", "ON", "SHUTTING DOWN" };
+    return state <= SYSTEM_SHUTTING_DOWN ? names[state] : "?";
+}
+
+// status: one line per instance that ran since boot
+static int cmd_status(int argc, char **argv)
+{
+    int shown = 0;
+
+    for (int i = 0; i < CONFIG_EMERGENCY_MAX_INSTANCES; i++) {
+        emergency_status_t st;
+        if (emergency_alarm_get_status(i, &st) != ESP_OK || (!st.running && st.alarm_count == 0)) {
+            continue;
+        }
+        printf("emergency #%d: %-7s alarm %-3s  alarms %lu  isr latches %lu  glitches %lu  busy max %lld us\n",
+               i, st.running ? "RUNNING" : "stopped", st.alarm_active ? "ON" : "off",
+               (unsigned long)st.alarm_count, (unsigned long)st.isr_latches,
+               (unsigned long)st.glitches, (long long)st.busy_max_us);
+        shown++;
+    }
+    for (int i = 0; i < CONFIG_MODE_SELECTOR_MAX_INSTANCES; i++) {
+        mode_selector_status_t st;
+        if (mode_selector_get_status(i, &st) != ESP_OK || (!st.running && st.changes == 0)) {
+            continue;
+        }
+        printf("mode      #%d: %-7s mode %-11s  changes %lu\n",
+               i, st.running ? "RUNNING" : "stopped", mode_name(st.mode), (unsigned long)st.changes);
+        shown++;
+    }
+    for (int i = 0; i < CONFIG_LONG_PRESS_POWER_MAX_INSTANCES; i++) {
+        long_press_power_status_t st;
+        if (long_press_power_get_status(i, &st) != ESP_OK ||
+            (!st.running && st.boot_cycles == 0 && st.short_presses == 0)) {
+            continue;
+        }
+        printf("power     #%d: %-7s state %-13s  boots %lu  short presses %lu\n",
+               i, st.running ? "RUNNING" : "stopped", power_state_name(st.state),
+               (unsigned long)st.boot_cycles, (unsigned long)st.short_presses);
+        shown++;
+    }
+    if (shown == 0) {
+        printf("No controller running (use 'start')\n");
+    }
+    printf("%lu events logged\n", (unsigned long)event_log_total());
+    return 0;
+}
+
+static esp_err_t register_commands(void)
+{
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "start",
+            .help = "Start a controller task. Pins default to menuconfig",
+            .hint = "<emergency|mode|power> [instance] [button_gpio led_gpio]",
+            .func = &cmd_start,
+        },
+        {
+            .command = "stop",
+            .help = "Stop a controller task and release its pins",
+            .hint = "<emergency|mode|power> [instance]",
+            .func = &cmd_stop,
+        },
+        {
+            .command = "status",
+            .help = "State and counters of every controller instance",
+            .func = &cmd_status,
+        },
+        {
+            .command = "press",
+            .help = "Hold the controller's button for ms (default 100), then release",
+            .hint = "<emergency|mode|power> [ms] [instance]",
+            .func = &cmd_press,
+        },
+    };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        esp_err_t err = esp_console_cmd_register(&commands[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    // Monitor commands live in their own components
+    esp_err_t err = task_monitor_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = loop_timing_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = panel_soak_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = input_bus_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = panel_output_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = panel_manager_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = led_anim_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = led_dither_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = tower_light_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+#if CONFIG_IDF_TARGET_LINUX
+    err = led_strip_sim_register_console();
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+    return event_log_register_console();
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+/*
+ * HOST BUILD:
+ *  - No REPL driver: read lines from stdin and run them
+ *  - Works with a pipe: ./panel.elf < commissioning_test.txt
+ */
+static void console_stdin_task(void *arg)
+{
+    char line[CONSOLE_LINE_MAX];
+
+    while (1) {
+        printf(CONSOLE_PROMPT);
+        fflush(stdout);
+        if (fgets(line, sizeof(line), stdin) == NULL) {
+            break;  // End of script
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;  // Empty line / script comment
+        }
+
+        int ret;
+        esp_err_t err = esp_console_run(line, &ret);
+        if (err == ESP_ERR_NOT_FOUND) {
+            printf("Unknown command: %s\n", line);
+        } else if (err == ESP_OK && ret != 0) {
+            printf("Command returned %d\n", ret);
+        }
+    }
+    ESP_LOGI(TAG, "stdin closed - console stopped");
+    vTaskDelete(NULL);
+}
+
+esp_err_t panel_console_start(void)
+{
+#if CONFIG_PANEL_CONSOLE_ENABLE
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    console_config.max_cmdline_length = CONSOLE_LINE_MAX;
+    esp_err_t err = esp_console_init(&console_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    esp_console_register_help_command();
+    err = register_commands();
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (xTaskCreate(console_stdin_task, "console", CONSOLE_TASK_STACK, NULL,
+                    CONSOLE_TASK_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+#else
+
+esp_err_t panel_console_start(void)
+{
+#if CONFIG_PANEL_CONSOLE_ENABLE
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = CONSOLE_PROMPT;
+    repl_config.max_cmdline_length = CONSOLE_LINE_MAX;
+    repl_config.task_stack_size = CONSOLE_TASK_STACK;
+    repl_config.task_priority = CONSOLE_TASK_PRIORITY;
+
+    // Same port as the log output (menuconfig → ESP System Settings → Channel for console output)
+    esp_err_t err;
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t hw_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_cdc(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#else
+    ESP_LOGW(TAG, "No console port configured - commands unavailable");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // "help" first: new_repl initialises the command table
+    esp_console_register_help_command();
+    err = register_commands();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+#if CONFIG_PANEL_CONSOLE_UART_WAKEUP
+    // Light sleep would otherwise swallow what the engineer types
+    uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, 3);
+    esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM);
+#endif
+
+    ESP_LOGI(TAG, "Console ready - type 'help'");
+    return esp_console_start_repl(repl);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PANEL_CONSOLE_H
+#define PANEL_CONSOLE_H
+
+#include "esp_err.h"
+
+/*
+ * Panel Commissioning Console
+ * ---------------------------
+ * Lets a service engineer work with the panel without reflashing:
+ *
+ *   start  <emergency|mode|power> [instance] [button_gpio led_gpio]
+ *   stop   <emergency|mode|power> [instance]
+ *   status                         state of every controller instance
+ *   press  <emergency|mode|power> [ms] [instance]
+ *                                  virtual button press (default 100 ms)
+ *   tasks / jitter / events        monitors of the other components
+ *   soak [operations] [seed]       randomised soak test of the button logic
+ *
+ * A virtual press goes through the same debounce and gesture logic as
+ * the real button, so "press power 3500" is a real long press.
+ */
+
+/*
+ * @brief Register all commands and start the command line
+ *
+ * Target: esp_console REPL task on the configured console port.
+ * Linux:  task reading lines from stdin (interactive or piped script).
+ * @return ESP_ERR_NOT_SUPPORTED without CONFIG_PANEL_CONSOLE_ENABLE
+ */
+esp_err_t panel_console_start(void);
+
+#endif
@@ -0,0 +1,56 @@
+#include "channel_logic.h"
+
+void channel_logic_init(channel_logic_t *ch, channel_behaviour_t behaviour, uint8_t states, uint32_t long_press_ms)
+{
+    ch->behaviour = behaviour;
+    ch->states = (behaviour == CHANNEL_CYCLE && states >= 2) ? states : 2;
+    ch->state = 0;
+    ch->pressed = false;
+    ch->timing = false;
+    ch->long_press_ms = long_press_ms;
+    ch->press_ms = 0;
+}
+
+bool channel_logic_feed(channel_logic_t *ch, bool pressed, uint32_t edge_ms)
+{
+    if (pressed == ch->pressed) {
+        return false;
+    }
+    ch->pressed = pressed;
+
+    if (!pressed) {
+        ch->timing = false;   // Released before long_press_ms: ignored
+        return false;
+    }
+    switch (ch->behaviour) {
+        case CHANNEL_TOGGLE:
+            ch->state ^= 1;
+            return true;
+        case CHANNEL_CYCLE:
+            ch->state = (ch->state + 1) % ch->states;
+            return true;
+        default:
+            ch->timing = true;
+            ch->press_ms = edge_ms;
+            return false;
+    }
+}
+
+bool channel_logic_poll(channel_logic_t *ch, uint32_t now_ms)
+{
+    if (!ch->timing || now_ms - ch->press_ms < ch->long_press_ms) {
+        return false;
+    }
+    ch->timing = false;   // Once per hold
+    ch->state ^= 1;
+    return true;
+}
+
+uint32_t channel_logic_ms_to_deadline(const channel_logic_t *ch, uint32_t now_ms)
+{
+    if (!ch->timing) {
+        return CHANNEL_LOGIC_NO_DEADLINE;
+    }
+    uint32_t elapsed_ms = now_ms - ch->press_ms;
+    return elapsed_ms >= ch->long_press_ms ? 0 : ch->long_press_ms - elapsed_ms;
+}
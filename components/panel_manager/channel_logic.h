@@ -0,0 +1,61 @@
+#ifndef CHANNEL_LOGIC_H
+#define CHANNEL_LOGIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Panel Channel Logic
+ * -------------------
+ * The decision part of one button/LED channel of the panel manager,
+ * without GPIO, lamp or FreeRTOS. Fed with DEBOUNCED edges (the input
+ * bus debounces), it keeps the channel state:
+ *  - TOGGLE:     every press switches OFF ↔ ON
+ *  - CYCLE:      every press steps 0 → 1 → ... → states-1 → 0
+ *  - LONG_PRESS: holding for long_press_ms switches OFF ↔ ON,
+ *                once per hold; short presses are ignored
+ * 
+ * 16 bytes per channel, no pointers: the manager keeps all channels
+ * in one array and walks it once per wakeup.
+ */
+
+#define CHANNEL_LOGIC_NO_DEADLINE  UINT32_MAX
+
+typedef enum {
+    CHANNEL_TOGGLE = 0,
+    CHANNEL_CYCLE,
+    CHANNEL_LONG_PRESS,
+} channel_behaviour_t;
+
+typedef struct {
+    uint8_t behaviour;        // channel_behaviour_t
+    uint8_t states;           // CYCLE: number of states (2..)
+    uint8_t state;            // 0 = OFF
+    bool pressed;             // Last debounced level
+    bool timing;              // LONG_PRESS: hold being timed
+    uint32_t long_press_ms;
+    uint32_t press_ms;        // LONG_PRESS: raw edge of the timed hold
+} channel_logic_t;
+
+void channel_logic_init(channel_logic_t *ch, channel_behaviour_t behaviour, uint8_t states, uint32_t long_press_ms);
+
+/*
+ * @brief Feed one debounced edge
+ * 
+ * A repeated level (e.g. after a dropped event) is ignored.
+ * @param edge_ms  raw edge time (long press timing starts there)
+ * @return true if the state changed
+ */
+bool channel_logic_feed(channel_logic_t *ch, bool pressed, uint32_t edge_ms);
+
+/*
+ * @brief Handle the long-press deadline
+ * 
+ * @return true if the state changed
+ */
+bool channel_logic_poll(channel_logic_t *ch, uint32_t now_ms);
+
+// Milliseconds until channel_logic_poll() has work (CHANNEL_LOGIC_NO_DEADLINE if idle)
+uint32_t channel_logic_ms_to_deadline(const channel_logic_t *ch, uint32_t now_ms);
+
+#endif
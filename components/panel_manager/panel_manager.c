@@ -0,0 +1,516 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "panel_manager.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "task_monitor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#define TAG "PANEL_MANAGER"
+
+#define PANEL_MANAGER_TASK_STACK  3072
+#define MAX_CHANNELS              CONFIG_PANEL_MANAGER_MAX_CHANNELS
+#define NAME_LEN                  12
+#define CYCLE_BLINK_MS            500       // CYCLE step 1 blinks at 500 ms, step 2 at 250 ms...
+#define DEFAULT_PRESS_MS          100
+#define BENCH_TICK_MS             10        // One FreeRTOS tick at 100 Hz
+#define BENCH_EVENT_ODDS          32        // One button event per channel every 32 passes
+#define BENCH_MAX_CHANNELS        64
+#define BENCH_DEFAULT_PASSES      10000
+#define YIELD_PERIOD_US           1000000   // Let the idle task run (task watchdog)
+
+/*
+ * ONE CHANNEL (all of them in one array):
+ *  - logic first: the part every pass reads
+ *  - sub:   this channel's button events, filled by the input bus
+ *  - led:   this channel's lamp request in the output manager
+ *  - Slot is free while used == false
+ */
+typedef struct {
+    channel_logic_t logic;
+    bool used;
+    gpio_num_t button_pin;
+    uint32_t changes;           // State changes since add
+    input_bus_sub_t sub;
+    panel_output_t led;
+    char name[NAME_LEN];
+} panel_channel_t;
+
+static panel_channel_t channels[MAX_CHANNELS];
+static SemaphoreHandle_t table_mutex = NULL;   // Channel table (add / remove / manager task)
+static TaskHandle_t manager_task = NULL;
+static uint32_t total_events = 0;              // Manager task only
+static uint32_t total_changes = 0;
+
+// Lamp pattern for the channel state
+static void show_state(panel_channel_t *ch)
+{
+    const channel_logic_t *logic = &ch->logic;
+
+    if (logic->state == 0) {
+        panel_output_set(&ch->led, false);
+    } else if (logic->behaviour == CHANNEL_CYCLE && logic->state < logic->states - 1) {
+        panel_output_blink(&ch->led, CYCLE_BLINK_MS / logic->state);
+    } else {
+        panel_output_set(&ch->led, true);
+    }
+}
+
+/*
+ * ONE PASS OVER THE CHANNEL ARRAY (manager task and bench):
+ *  - Drain each channel's event queue into its logic
+ *  - Run the long-press deadline check
+ *  - Post the lamp only when the state changed (drive_leds)
+ * Returns ms to the earliest deadline of all channels.
+ * Caller holds table_mutex (task) or owns the array (bench).
+ */
+static uint32_t manager_pass(panel_channel_t *table, uint32_t count, uint32_t now_ms, bool drive_leds,
+                             uint32_t *events, uint32_t *changes)
+{
+    uint32_t wait_ms = CHANNEL_LOGIC_NO_DEADLINE;
+
+    for (uint32_t i = 0; i < count; i++) {
+        panel_channel_t *ch = &table[i];
+        if (!ch->used) {
+            continue;
+        }
+        bool changed = false;
+        input_event_t event;
+        while (input_bus_receive(&ch->sub, &event)) {
+            (*events)++;
+            if (event.type != INPUT_EVENT_GLITCH) {
+                changed |= channel_logic_feed(&ch->logic, event.type == INPUT_EVENT_PRESS, event.edge_ms);
+            }
+        }
+        changed |= channel_logic_poll(&ch->logic, now_ms);
+
+        if (changed) {
+            ch->changes++;
+            (*changes)++;
+            if (drive_leds) {
+                show_state(ch);
+            }
+        }
+        uint32_t deadline_ms = channel_logic_ms_to_deadline(&ch->logic, now_ms);
+        if (deadline_ms < wait_ms) {
+            wait_ms = deadline_ms;
+        }
+    }
+    return wait_ms;
+}
+
+/*
+ * MANAGER TASK:
+ *  1. One pass over every channel
+ *  2. Sleep until a button event is queued, a long press is due or
+ *     the table changed (add / remove)
+ * With all buttons idle the task does not wake at all.
+ */
+static void panel_manager_task(void *arg)
+{
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "panel_manager");
+
+    while (1) {
+        task_monitor_loop_begin(&loop_stats);
+        uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+        xSemaphoreTake(table_mutex, portMAX_DELAY);
+        uint32_t wait_ms = manager_pass(channels, MAX_CHANNELS, now_ms, true, &total_events, &total_changes);
+        xSemaphoreGive(table_mutex);
+
+        task_monitor_loop_end(&loop_stats);
+        TickType_t ticks = portMAX_DELAY;
+        if (wait_ms != CHANNEL_LOGIC_NO_DEADLINE) {
+            ticks = (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;  // Round up
+        }
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+}
+
+esp_err_t panel_manager_start(void)
+{
+    if (manager_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    table_mutex = xSemaphoreCreateMutex();
+    if (table_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(panel_manager_task, "panel_manager", PANEL_MANAGER_TASK_STACK, NULL,
+                    CONFIG_PANEL_MANAGER_TASK_PRIORITY, &manager_task) != pdPASS) {
+        vSemaphoreDelete(table_mutex);
+        table_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Started: %d channels, %u bytes each", MAX_CHANNELS, (unsigned)sizeof(panel_channel_t));
+    return ESP_OK;
+}
+
+esp_err_t panel_manager_add(const panel_channel_config_t *config, uint8_t *id)
+{
+    if (manager_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config->behaviour > CHANNEL_LONG_PRESS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *name = config->name != NULL ? config->name : "channel";
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    int slot = -1;
+    for (int i = 0; i < MAX_CHANNELS && slot < 0; i++) {
+        if (!channels[i].used) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        panel_channel_t *ch = &channels[slot];
+        memset(ch, 0, sizeof(*ch));
+        snprintf(ch->name, sizeof(ch->name), "%s", name);
+        ch->button_pin = config->button_pin;
+        channel_logic_init(&ch->logic, config->behaviour, config->states, config->long_press_ms);
+
+        err = panel_output_open(&ch->led, config->led_pin, PANEL_OUTPUT_PRIO_STATUS, ch->name);
+        if (err == ESP_OK) {
+            err = input_bus_subscribe_task(&ch->sub, manager_task, config->button_pin,
+                                           CONFIG_PANEL_MANAGER_DEBOUNCE_MS, ch->name);
+            if (err != ESP_OK) {
+                panel_output_close(&ch->led);
+            }
+        }
+        if (err == ESP_OK) {
+            show_state(ch);
+            ch->used = true;
+        }
+    }
+    xSemaphoreGive(table_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Channel %s not added: %s", name, esp_err_to_name(err));
+        return err;
+    }
+    if (id != NULL) {
+        *id = (uint8_t)slot;
+    }
+    xTaskNotifyGive(manager_task);
+    return ESP_OK;
+}
+
+esp_err_t panel_manager_remove(uint8_t id)
+{
+    if (table_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (id >= MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    panel_channel_t *ch = &channels[id];
+    if (ch->used) {
+        input_bus_unsubscribe(&ch->sub);
+        panel_output_close(&ch->led);
+        ch->used = false;
+        err = ESP_OK;
+    }
+    xSemaphoreGive(table_mutex);
+    return err;
+}
+
+esp_err_t panel_manager_press(uint8_t id, bool pressed)
+{
+    if (table_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (id >= MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    bool used = channels[id].used;
+    gpio_num_t pin = channels[id].button_pin;
+    xSemaphoreGive(table_mutex);
+    return used ? input_bus_inject(pin, pressed) : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t panel_manager_get_state(uint8_t id, uint8_t *state)
+{
+    if (table_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (id >= MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    bool used = channels[id].used;
+    *state = channels[id].logic.state;
+    xSemaphoreGive(table_mutex);
+    return used ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+// xorshift32: reproducible, never 0
+static uint32_t bench_rng(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * BENCH:
+ *  - Private array (calloc, freed at the end), same struct as the task
+ *  - Behaviours mixed 1:1:1 so some long presses are always timing
+ *  - Before each pass the bench stands in for the input bus: it
+ *    queues random press / release events straight into the channel
+ *    queues (no notification, nobody else reads them)
+ *  - Only the pass itself is timed; a 1-channel pass is shorter than
+ *    the 1 us timer step, but the average over many passes holds
+ */
+esp_err_t panel_manager_bench(uint32_t count, uint32_t passes, panel_bench_result_t *result)
+{
+    if (count == 0 || passes == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    panel_channel_t *table = calloc(count, sizeof(panel_channel_t));
+    if (table == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        table[i].used = true;
+        channel_logic_init(&table[i].logic, (channel_behaviour_t)(i % 3), 3, CONFIG_PANEL_MANAGER_LONG_PRESS_MS);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->channels = count;
+    result->passes = passes;
+    uint32_t rng = 0x2545F491;
+    uint32_t now_ms = 0;
+    int64_t yield_us = esp_timer_get_time();
+
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        now_ms += BENCH_TICK_MS;
+        for (uint32_t i = 0; i < count; i++) {
+            input_bus_sub_t *sub = &table[i].sub;
+            if (bench_rng(&rng) % BENCH_EVENT_ODDS == 0 && sub->head - sub->tail < CONFIG_INPUT_BUS_QUEUE_LEN) {
+                input_event_t *event = &sub->events[sub->head % CONFIG_INPUT_BUS_QUEUE_LEN];
+                event->type = table[i].logic.pressed ? INPUT_EVENT_RELEASE : INPUT_EVENT_PRESS;
+                event->time_ms = now_ms;
+                event->edge_ms = now_ms;
+                sub->head++;
+            }
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        manager_pass(table, count, now_ms, false, &result->events, &result->changes);
+        int64_t pass_us = esp_timer_get_time() - start_us;
+
+        result->total_us += pass_us;
+        if (pass_us > result->max_pass_us) {
+            result->max_pass_us = (uint32_t)pass_us;
+        }
+        if ((pass & 0xff) == 0 && esp_timer_get_time() - yield_us > YIELD_PERIOD_US) {
+            vTaskDelay(1);
+            yield_us = esp_timer_get_time();
+        }
+    }
+    free(table);
+    return ESP_OK;
+}
+
+static const char *behaviour_name(uint8_t behaviour)
+{
+    static const char *names[] = { "toggle", "cycle", "long" };
+    return behaviour <= CHANNEL_LONG_PRESS ? names[behaviour] : "?";
+}
+
+void panel_manager_print(void)
+{
+    if (table_mutex == NULL) {
+        printf("Panel manager not started\n");
+        return;
+    }
+    int shown = 0;
+    printf(" ID  name         behaviour  button  lamp  state  changes\n");
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        const panel_channel_t *ch = &channels[i];
+        if (!ch->used) {
+            continue;
+        }
+        printf("%3d  %-11s  %-9s  %6d  %4d  %2u/%-2u  %7lu\n", i, ch->name, behaviour_name(ch->logic.behaviour),
+               ch->button_pin, ch->led.pin, ch->logic.state,
+               ch->logic.behaviour == CHANNEL_CYCLE ? ch->logic.states : 2, (unsigned long)ch->changes);
+        shown++;
+    }
+    xSemaphoreGive(table_mutex);
+    printf("%d of %d channels used, %u bytes each (%u in the pass-critical logic)\n",
+           shown, MAX_CHANNELS, (unsigned)sizeof(panel_channel_t), (unsigned)sizeof(channel_logic_t));
+    printf("%lu button events, %lu state changes since boot\n",
+           (unsigned long)total_events, (unsigned long)total_changes);
+}
+
+static int cmd_channels(int argc, char **argv)
+{
+    panel_manager_print();
+    return 0;
+}
+
+// Numeric argument; false (with a message) if not a number
+static bool parse_arg(const char *text, uint32_t *out)
+{
+    char *end;
+    unsigned long value = strtoul(text, &end, 0);
+    if (*text == '\0' || *end != '\0') {
+        printf("'%s' is not a number\n", text);
+        return false;
+    }
+    *out = (uint32_t)value;
+    return true;
+}
+
+/*
+ * channel add <toggle|cycle|long> <button_gpio> <led_gpio> [states | hold_ms]
+ * channel remove <id>
+ * channel press <id> [ms]
+ */
+static int cmd_channel(int argc, char **argv)
+{
+    uint32_t a = 0, b = 0, c = 0;
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+
+    if (argc >= 5 && argc <= 6 && strcmp(argv[1], "add") == 0) {
+        panel_channel_config_t config = PANEL_CHANNEL_CONFIG_DEFAULT();
+        if (strcmp(argv[2], "toggle") == 0) {
+            config.behaviour = CHANNEL_TOGGLE;
+        } else if (strcmp(argv[2], "cycle") == 0) {
+            config.behaviour = CHANNEL_CYCLE;
+        } else if (strcmp(argv[2], "long") == 0) {
+            config.behaviour = CHANNEL_LONG_PRESS;
+        } else {
+            printf("Unknown behaviour '%s' (toggle | cycle | long)\n", argv[2]);
+            return 1;
+        }
+        if (!parse_arg(argv[3], &a) || !parse_arg(argv[4], &b) || (argc == 6 && !parse_arg(argv[5], &c))) {
+            return 1;
+        }
+        // Behaviour and pins, e.g. "toggle18/2": tells the channels apart in "outputs" and "inputs"
+        char name[NAME_LEN];
+        snprintf(name, sizeof(name), "%s%lu/%lu", argv[2], (unsigned long)a, (unsigned long)b);
+        config.button_pin = a;
+        config.led_pin = b;
+        config.name = name;
+        if (argc == 6) {
+            if (config.behaviour == CHANNEL_CYCLE) {
+                config.states = c > UINT8_MAX ? UINT8_MAX : c;
+            } else {
+                config.long_press_ms = c;
+            }
+        }
+        uint8_t id;
+        err = panel_manager_add(&config, &id);
+        if (err == ESP_OK) {
+            printf("channel %u added\n", id);
+            return 0;
+        }
+    } else if (argc == 3 && strcmp(argv[1], "remove") == 0) {
+        if (!parse_arg(argv[2], &a)) {
+            return 1;
+        }
+        err = a > UINT8_MAX ? ESP_ERR_INVALID_ARG : panel_manager_remove(a);
+    } else if (argc >= 3 && argc <= 4 && strcmp(argv[1], "press") == 0) {
+        if (!parse_arg(argv[2], &a) || (argc == 4 && !parse_arg(argv[3], &b))) {
+            return 1;
+        }
+        uint32_t hold_ms = argc == 4 ? b : DEFAULT_PRESS_MS;
+        err = a > UINT8_MAX ? ESP_ERR_INVALID_ARG : panel_manager_press(a, true);
+        if (err == ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(hold_ms));
+            err = panel_manager_press(a, false);
+        }
+    } else {
+        printf("Usage: channel add <toggle|cycle|long> <button_gpio> <led_gpio> [states|hold_ms]\n"
+               "       channel remove <id>\n"
+               "       channel press <id> [ms]\n");
+        return 1;
+    }
+
+    if (err != ESP_OK) {
+        printf("channel %s failed: %s\n", argv[1], esp_err_to_name(err));
+        return 1;
+    }
+    printf("channel %s: OK\n", argv[1]);
+    return 0;
+}
+
+/*
+ * panelbench [passes]
+ *  - One row per channel count: 1, 2, 4 ... 64
+ *  - Cost per pass should grow linearly with the channel count
+ */
+static int cmd_panelbench(int argc, char **argv)
+{
+    uint32_t passes = BENCH_DEFAULT_PASSES;
+    if (argc > 1 && !parse_arg(argv[1], &passes)) {
+        return 1;
+    }
+
+    printf("channels  passes  events  changes  us/pass  max us  ns/channel\n");
+    for (uint32_t count = 1; count <= BENCH_MAX_CHANNELS; count *= 2) {
+        panel_bench_result_t r;
+        esp_err_t err = panel_manager_bench(count, passes, &r);
+        if (err != ESP_OK) {
+            printf("%8lu  failed: %s\n", (unsigned long)count, esp_err_to_name(err));
+            return 1;
+        }
+        int64_t ns_per_pass = r.total_us * 1000 / r.passes;
+        printf("%8lu  %6lu  %6lu  %7lu  %7lld.%02lld  %6lu  %10lld\n", (unsigned long)r.channels,
+               (unsigned long)r.passes, (unsigned long)r.events, (unsigned long)r.changes,
+               (long long)(ns_per_pass / 1000), (long long)(ns_per_pass % 1000 / 10),
+               (unsigned long)r.max_pass_us, (long long)(ns_per_pass / r.channels));
+    }
+    printf("One task stack serves them all (%d bytes); one task per button would need one each\n",
+           PANEL_MANAGER_TASK_STACK);
+    return 0;
+}
+
+esp_err_t panel_manager_register_console(void)
+{
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "channels",
+            .help = "Show the panel manager channels, their state and counters",
+            .hint = NULL,
+            .func = &cmd_channels,
+        },
+        {
+            .command = "channel",
+            .help = "Add, remove or press a panel manager channel",
+            .hint = "add <toggle|cycle|long> <button_gpio> <led_gpio> [states|hold_ms] | remove <id> | press <id> [ms]",
+            .func = &cmd_channel,
+        },
+        {
+            .command = "panelbench",
+            .help = "Time one panel manager pass for 1..64 channels (default 10000 passes)",
+            .hint = "[passes]",
+            .func = &cmd_panelbench,
+        },
+    };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        esp_err_t err = esp_console_cmd_register(&commands[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
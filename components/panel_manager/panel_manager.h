@@ -0,0 +1,102 @@
+#ifndef PANEL_MANAGER_H
+#define PANEL_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "channel_logic.h"
+#include "sdkconfig.h"
+
+/*
+ * Multi-Channel Panel Manager
+ * ---------------------------
+ * Large machines have 20-40 front-panel buttons, each with its own lamp.
+ * One blocking *_run() loop per button would mean one task and one
+ * stack (2-4 KB) per button.
+ *
+ * Here ONE task serves every channel:
+ *  - Channel = button + lamp + behaviour (TOGGLE / CYCLE / LONG_PRESS,
+ *    see channel_logic.h)
+ *  - All channels live in one static array, no heap
+ *  - The task wakes on button events (input bus) and on the earliest
+ *    long-press deadline, walks the array once and sleeps again
+ *  - Lamps are posted to the output manager at STATUS priority, so an
+ *    alarm or power lamp on the same pin still wins
+ *
+ * SIZING: every channel needs one input bus pin and one output pin:
+ * raise "Input Bus" → maximum button pins and "Panel Output Manager"
+ * → maximum output pins together with the channel count.
+ *
+ * Console: "channels", "channel add / remove / press", "panelbench".
+ */
+
+// Per-channel setup (copied by panel_manager_add)
+typedef struct {
+    gpio_num_t button_pin;      // Push button to GND, internal pull-up
+    gpio_num_t led_pin;
+    channel_behaviour_t behaviour;
+    uint8_t states;             // CYCLE: OFF, blink steps..., ON (2..)
+    uint32_t long_press_ms;     // LONG_PRESS: hold time
+    const char *name;           // Copied, up to 11 characters shown
+} panel_channel_config_t;
+
+#define PANEL_CHANNEL_CONFIG_DEFAULT() {                        \
+    .button_pin = GPIO_NUM_NC,                                  \
+    .led_pin = GPIO_NUM_NC,                                     \
+    .behaviour = CHANNEL_TOGGLE,                                \
+    .states = 3,                                                \
+    .long_press_ms = CONFIG_PANEL_MANAGER_LONG_PRESS_MS,        \
+    .name = "channel",                                          \
+}
+
+// Result of one benchmark row (panel_manager_bench)
+typedef struct {
+    uint32_t channels;
+    uint32_t passes;
+    uint32_t events;            // Button events drained from the queues
+    uint32_t changes;           // Channel state changes
+    int64_t total_us;           // Time spent inside the passes only
+    uint32_t max_pass_us;
+} panel_bench_result_t;
+
+/*
+ * @brief Create the manager task (after input_bus_start / panel_output_start)
+ */
+esp_err_t panel_manager_start(void);
+
+/*
+ * @brief Add a channel; its lamp starts OFF
+ *
+ * @param[out] id  channel number for remove / press / get_state (may be NULL)
+ * @return ESP_ERR_INVALID_STATE if the manager is not started,
+ *         ESP_ERR_NO_MEM if the channel, input or output table is full
+ */
+esp_err_t panel_manager_add(const panel_channel_config_t *config, uint8_t *id);
+
+// Remove a channel: its button and lamp are released
+esp_err_t panel_manager_remove(uint8_t id);
+
+// Virtual button press / release (seen by every subscriber of the pin)
+esp_err_t panel_manager_press(uint8_t id, bool pressed);
+
+// Current state: 0 = OFF, TOGGLE / LONG_PRESS 1 = ON, CYCLE 1..states-1
+esp_err_t panel_manager_get_state(uint8_t id, uint8_t *state);
+
+/*
+ * @brief Time the manager pass for a number of channels
+ *
+ * Runs the same pass as the manager task over a private channel array
+ * (no GPIO, no lamps): random button events are queued the way the
+ * input bus would, then the pass drains them, runs the logic and
+ * finds the next deadline. One simulated tick per pass.
+ */
+esp_err_t panel_manager_bench(uint32_t channels, uint32_t passes, panel_bench_result_t *result);
+
+// Print every channel with state and counters
+void panel_manager_print(void);
+
+// Add the "channels", "channel" and "panelbench" commands
+esp_err_t panel_manager_register_console(void);
+
+#endif
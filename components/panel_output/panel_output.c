@@ -0,0 +1,433 @@
+#include <stdio.h>
+#include <string.h>
+#include "panel_output.h"
+#include "indicator.h"
+#include "output_bank.h"
+#include "tower_light.h"
+#include "task_monitor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_console.h"
+#include "esp_log.h"
+
+#define TAG "PANEL_OUTPUT"
+
+#define PANEL_OUTPUT_TASK_STACK  3072
+
+#define MAX_PINS     CONFIG_PANEL_OUTPUT_MAX_PINS
+#define MAX_POSTERS  CONFIG_PANEL_OUTPUT_MAX_POSTERS
+
+/*
+ * ONE ENTRY PER PHYSICAL PIN:
+ *  - ind:      the only writer of the pin (LEDC or software blink)
+ *  - posters:  in open order (equal priority → first one wins)
+ *  - applied:  composite currently shown, compared before every write
+ *  - restored: fast-restore level kept until someone requests something
+ *  - isr_written: an ISR drove the pin, applied no longer tells what it shows
+ */
+typedef struct {
+    gpio_num_t pin;
+    bool used;
+    bool ind_ready;
+    bool restored;
+    bool restored_on;
+    indicator_t ind;
+    panel_output_t *posters[MAX_POSTERS];
+    uint8_t poster_count;
+    const panel_output_t *winner;   // NULL = nobody requests anything
+    uint8_t applied_mode;
+    uint32_t applied_half_ms;
+    uint32_t changes;               // Composite changes written to the pin
+    volatile bool isr_written;      // requests_lock
+    volatile bool isr_on;
+} output_pin_t;
+
+static output_pin_t pins[MAX_PINS];
+static output_bank_t bank = OUTPUT_BANK_INIT();  // Levels of one pass, committed together
+static SemaphoreHandle_t table_mutex = NULL;   // Pin table (open / close / owner task)
+static portMUX_TYPE requests_lock = portMUX_INITIALIZER_UNLOCKED;  // Poster mode + period
+static TaskHandle_t owner_task = NULL;
+static bool tower_ready = false;   // Strip tower light created
+
+static output_pin_t *find_pin(gpio_num_t pin)
+{
+    for (int i = 0; i < MAX_PINS; i++) {
+        if (pins[i].used && pins[i].pin == pin) {
+            return &pins[i];
+        }
+    }
+    return NULL;
+}
+
+static output_pin_t *alloc_pin(gpio_num_t pin)
+{
+    for (int i = 0; i < MAX_PINS; i++) {
+        if (!pins[i].used) {
+            memset(&pins[i], 0, sizeof(pins[i]));
+            pins[i].pin = pin;
+            pins[i].used = true;
+            return &pins[i];
+        }
+    }
+    return NULL;
+}
+
+void panel_output_restore(gpio_num_t pin, bool on)
+{
+    output_pin_t *p = find_pin(pin);
+    if (p == NULL) {
+        p = alloc_pin(pin);
+        if (p == NULL) {
+            return;
+        }
+    }
+
+    // Runs before any task: no lock, no logging
+    gpio_reset_pin(pin);
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+    gpio_set_level(pin, on);
+    p->restored = true;
+    p->restored_on = on;
+}
+
+/*
+ * COMPOSITE (owner task, table_mutex held):
+ *  - Highest priority with a request other than RELEASE wins
+ *  - Nobody requesting → OFF (or the fast-restore level, until the
+ *    first real request arrives)
+ *  - The pin is only touched if the result differs from what it shows
+ */
+static uint32_t update_pin(output_pin_t *p, uint32_t now_ms)
+{
+    const panel_output_t *winner = NULL;
+    uint8_t mode = PANEL_OUTPUT_OFF;
+    uint32_t half_ms = 0;
+
+    taskENTER_CRITICAL(&requests_lock);
+    for (int i = 0; i < p->poster_count; i++) {
+        const panel_output_t *out = p->posters[i];
+        if (out->mode != PANEL_OUTPUT_RELEASE && (winner == NULL || out->priority > winner->priority)) {
+            winner = out;
+        }
+    }
+    if (winner != NULL) {
+        mode = winner->mode;
+        half_ms = winner->half_period_ms;
+    }
+    bool isr_written = p->isr_written;
+    bool isr_on = p->isr_on;
+    p->isr_written = false;
+    taskEXIT_CRITICAL(&requests_lock);
+    p->winner = winner;
+
+    if (isr_written) {
+        // Pin no longer shows applied_mode (e.g. ON then RELEASE since the last pass)
+        indicator_assume(&p->ind, isr_on);
+        p->applied_mode = isr_on ? PANEL_OUTPUT_ON : PANEL_OUTPUT_OFF;
+        p->restored = false;
+    }
+
+    if (winner == NULL && p->restored) {
+        return indicator_update(&p->ind, now_ms);  // Keep showing the restored level
+    }
+    p->restored = false;
+
+    bool same = (mode == p->applied_mode) && (mode != PANEL_OUTPUT_BLINK || half_ms == p->applied_half_ms);
+    if (!same) {
+        if (mode == PANEL_OUTPUT_BLINK) {
+            indicator_blink(&p->ind, half_ms, now_ms);
+        } else {
+            indicator_set(&p->ind, mode == PANEL_OUTPUT_ON);
+        }
+        p->applied_mode = mode;
+        p->applied_half_ms = half_ms;
+        p->changes++;
+    }
+    return indicator_update(&p->ind, now_ms);
+}
+
+/*
+ * TOWER LIGHT (menuconfig → "Tower Light"):
+ *  - One strip segment per priority class, showing that class's own
+ *    request: alarm and mode sharing one GPIO lamp still get a
+ *    segment each
+ *  - Per class the first open poster with a request counts
+ *  - Only a changed request restarts the segment's animation
+ * Caller holds table_mutex.
+ */
+static void update_tower(void)
+{
+    static const uint8_t class_priority[TOWER_SEGMENT_COUNT] = {
+        [TOWER_SEGMENT_STATUS] = PANEL_OUTPUT_PRIO_STATUS,
+        [TOWER_SEGMENT_POWER] = PANEL_OUTPUT_PRIO_POWER,
+        [TOWER_SEGMENT_ALARM] = PANEL_OUTPUT_PRIO_ALARM,
+    };
+
+    for (int s = 0; s < TOWER_SEGMENT_COUNT; s++) {
+        uint8_t mode = PANEL_OUTPUT_RELEASE;
+        uint32_t half_ms = 0;
+
+        taskENTER_CRITICAL(&requests_lock);
+        for (int i = 0; i < MAX_PINS && mode == PANEL_OUTPUT_RELEASE; i++) {
+            for (int j = 0; pins[i].used && j < pins[i].poster_count; j++) {
+                const panel_output_t *out = pins[i].posters[j];
+                if (out->priority == class_priority[s] && out->mode != PANEL_OUTPUT_RELEASE) {
+                    mode = out->mode;
+                    half_ms = out->half_period_ms;
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL(&requests_lock);
+
+        tower_pattern_t pattern = mode == PANEL_OUTPUT_BLINK ? TOWER_PATTERN_BLINK :
+                                  mode == PANEL_OUTPUT_ON ? TOWER_PATTERN_ON : TOWER_PATTERN_OFF;
+        tower_light_post(s, pattern, half_ms);
+    }
+}
+
+/*
+ * OWNER TASK:
+ *  1. Composite every pin that has posters, stage changed ones
+ *  2. Commit the bank: all staged pins in one W1TS + one W1TC write
+ *  3. Tower light (if enabled): post the segment patterns
+ *  4. Sleep until a poster changes its request or a software blink
+ *     toggle is due (never with LEDC blinking / steady levels)
+ */
+static void panel_output_task(void *arg)
+{
+    task_monitor_loop_t loop_stats;
+    task_monitor_loop_register(&loop_stats, "panel_output");
+
+    while (1) {
+        task_monitor_loop_begin(&loop_stats);
+        uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        uint32_t wait_ms = INDICATOR_NO_DEADLINE;
+
+        xSemaphoreTake(table_mutex, portMAX_DELAY);
+        for (int i = 0; i < MAX_PINS; i++) {
+            if (!pins[i].used || pins[i].poster_count == 0) {
+                continue;
+            }
+            uint32_t pin_wait_ms = update_pin(&pins[i], now_ms);
+            if (pin_wait_ms < wait_ms) {
+                wait_ms = pin_wait_ms;
+            }
+        }
+        output_bank_commit(&bank);
+        if (tower_ready) {
+            update_tower();
+        }
+        xSemaphoreGive(table_mutex);
+
+        task_monitor_loop_end(&loop_stats);
+        TickType_t ticks = portMAX_DELAY;
+        if (wait_ms != INDICATOR_NO_DEADLINE) {
+            ticks = (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;  // Round up
+        }
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+}
+
+esp_err_t panel_output_start(void)
+{
+    if (owner_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    table_mutex = xSemaphoreCreateMutex();
+    if (table_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+#if CONFIG_PANEL_TOWER_LIGHT
+    tower_ready = (tower_light_init() == ESP_OK);  // Lamps still work without it
+#endif
+    if (xTaskCreate(panel_output_task, "panel_output", PANEL_OUTPUT_TASK_STACK, NULL,
+                    CONFIG_PANEL_OUTPUT_TASK_PRIORITY, &owner_task) != pdPASS) {
+        vSemaphoreDelete(table_mutex);
+        table_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t panel_output_open(panel_output_t *out, gpio_num_t pin, uint8_t priority, const char *name)
+{
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(pin)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (owner_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    out->pin = pin;
+    out->priority = priority;
+    out->name = name;
+    out->mode = PANEL_OUTPUT_RELEASE;
+    out->half_period_ms = 0;
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    output_pin_t *p = find_pin(pin);
+    if (p == NULL) {
+        p = alloc_pin(pin);
+    }
+    if (p == NULL || p->poster_count >= MAX_POSTERS) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        if (!p->ind_ready) {
+            // First poster: the pin becomes ours (kept as is after fast-restore)
+            if (!p->restored) {
+                gpio_reset_pin(pin);
+                gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+            }
+            bool on = p->restored && p->restored_on;
+            indicator_init(&p->ind, pin, on);
+            indicator_use_bank(&p->ind, &bank);
+            p->applied_mode = on ? PANEL_OUTPUT_ON : PANEL_OUTPUT_OFF;
+            p->ind_ready = true;
+        }
+        out->entry = p;
+        p->posters[p->poster_count++] = out;
+    }
+    xSemaphoreGive(table_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "GPIO %d: %s not opened: %s", pin, name, esp_err_to_name(err));
+    }
+    return err;
+}
+
+void panel_output_close(panel_output_t *out)
+{
+    if (table_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    output_pin_t *p = find_pin(out->pin);
+    for (int i = 0; p != NULL && i < p->poster_count; i++) {
+        if (p->posters[i] != out) {
+            continue;
+        }
+        // Shift down: keeps the open order for equal priorities
+        memmove(&p->posters[i], &p->posters[i + 1], (p->poster_count - i - 1) * sizeof(p->posters[0]));
+        p->poster_count--;
+        if (p->poster_count == 0) {
+            indicator_deinit(&p->ind);  // Lamp OFF, LEDC timer free again
+            output_bank_commit(&bank);
+            p->used = false;
+        }
+        break;
+    }
+    xSemaphoreGive(table_mutex);
+    xTaskNotifyGive(owner_task);  // Lower priorities may show again
+}
+
+static void post(panel_output_t *out, panel_output_mode_t mode, uint32_t half_period_ms)
+{
+    taskENTER_CRITICAL(&requests_lock);
+    bool changed = out->mode != mode || out->half_period_ms != half_period_ms;
+    out->mode = mode;
+    out->half_period_ms = half_period_ms;
+    taskEXIT_CRITICAL(&requests_lock);
+
+    // Same request again: nothing to composite, owner task stays asleep
+    if (changed && owner_task != NULL) {
+        xTaskNotifyGive(owner_task);
+    }
+}
+
+void panel_output_set(panel_output_t *out, bool on)
+{
+    post(out, on ? PANEL_OUTPUT_ON : PANEL_OUTPUT_OFF, 0);
+}
+
+void panel_output_blink(panel_output_t *out, uint32_t half_period_ms)
+{
+    if (half_period_ms == 0) {
+        post(out, PANEL_OUTPUT_ON, 0);
+    } else {
+        post(out, PANEL_OUTPUT_BLINK, half_period_ms);
+    }
+}
+
+void panel_output_release(panel_output_t *out)
+{
+    post(out, PANEL_OUTPUT_RELEASE, 0);
+}
+
+void IRAM_ATTR panel_output_set_from_isr(panel_output_t *out, bool on)
+{
+    output_pin_t *p = (output_pin_t *)out->entry;
+    BaseType_t woken = pdFALSE;
+
+    taskENTER_CRITICAL_ISR(&requests_lock);
+    out->mode = on ? PANEL_OUTPUT_ON : PANEL_OUTPUT_OFF;
+    out->half_period_ms = 0;
+    p->isr_written = true;
+    p->isr_on = on;
+    taskEXIT_CRITICAL_ISR(&requests_lock);
+    indicator_write_from_isr(&p->ind, on);
+    if (owner_task != NULL) {
+        vTaskNotifyGiveFromISR(owner_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void format_request(char *buf, size_t len, uint8_t mode, uint32_t half_ms)
+{
+    switch (mode) {
+        case PANEL_OUTPUT_OFF:   snprintf(buf, len, "OFF"); break;
+        case PANEL_OUTPUT_ON:    snprintf(buf, len, "ON"); break;
+        case PANEL_OUTPUT_BLINK: snprintf(buf, len, "BLINK %lums", (unsigned long)half_ms); break;
+        default:                 snprintf(buf, len, "-"); break;
+    }
+}
+
+void panel_output_print(void)
+{
+    if (table_mutex == NULL) {
+        printf("Output manager not started\n");
+        return;
+    }
+    char text[20];
+    printf("GPIO  output        changes  posters (priority: request, * = shown)\n");
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_PINS; i++) {
+        output_pin_t *p = &pins[i];
+        if (!p->used || p->poster_count == 0) {
+            continue;
+        }
+        format_request(text, sizeof(text), p->applied_mode, p->applied_half_ms);
+        printf("%4d  %-12s  %7lu ", p->pin, text, (unsigned long)p->changes);
+        for (int s = 0; s < p->poster_count; s++) {
+            const panel_output_t *out = p->posters[s];
+            format_request(text, sizeof(text), out->mode, out->half_period_ms);
+            printf(" %s(%d): %s%s", out->name, out->priority, text, out == p->winner ? " *" : "");
+        }
+        printf("\n");
+    }
+    printf("Output bank: %lu pin levels in %lu register commits\n",
+           (unsigned long)bank.staged, (unsigned long)bank.commits);
+    if (tower_ready) {
+        tower_light_print();
+    }
+    xSemaphoreGive(table_mutex);
+}
+
+static int cmd_outputs(int argc, char **argv)
+{
+    panel_output_print();
+    return 0;
+}
+
+esp_err_t panel_output_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "outputs",
+        .help = "Show panel output pins, the winning request and every poster",
+        .hint = NULL,
+        .func = &cmd_outputs,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,113 @@
+#ifndef PANEL_OUTPUT_H
+#define PANEL_OUTPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Panel Output Manager
+ * --------------------
+ * Several functions, one lamp.
+ *
+ * The alarm lamp and the mode status LED both default to GPIO 2. With
+ * each controller writing the pin itself, the alarm blink and the mode
+ * blink would interleave at random.
+ *
+ * Now:
+ *  - Each module POSTS what it wants on a pin (OFF / ON / BLINK) at
+ *    its own priority, or RELEASES the pin to the modules below it
+ *  - One owner task composites: the highest-priority request wins
+ *    (alarm overrides power, power overrides mode indication)
+ *  - The pin is only rewritten when the composite changes; posting
+ *    the same request again does not even wake the owner task
+ *  - Software blink timing runs in the owner task, so the controller
+ *    loops no longer wake for LED toggles
+ *
+ * TOWER LIGHT (optional, tower_light.h): the alarm, power and status
+ * requests are also shown on their own segments of one LED strip.
+ *
+ * Console: "outputs" lists pins, the winning request and every poster.
+ */
+
+typedef enum {
+    PANEL_OUTPUT_RELEASE = 0,  // No request: lower priorities show through
+    PANEL_OUTPUT_OFF,
+    PANEL_OUTPUT_ON,
+    PANEL_OUTPUT_BLINK,
+} panel_output_mode_t;
+
+/*
+ * PRIORITIES (higher wins; equal → the first opened wins):
+ */
+#define PANEL_OUTPUT_PRIO_STATUS  10   // Mode / status indication
+#define PANEL_OUTPUT_PRIO_POWER   20   // Power state and boot sequence
+#define PANEL_OUTPUT_PRIO_ALARM   30   // E-STOP alarm overrides everything
+
+/*
+ * ONE POSTER ON ONE PIN:
+ *  - Lives in the module (static or controller instance struct)
+ *  - Must stay valid until panel_output_close()
+ */
+typedef struct {
+    gpio_num_t pin;
+    uint8_t priority;
+    const char *name;
+    volatile uint8_t mode;              // panel_output_mode_t
+    volatile uint32_t half_period_ms;   // PANEL_OUTPUT_BLINK only
+    void *entry;                        // Owner's pin table entry (ISR path)
+} panel_output_t;
+
+/*
+ * @brief Drive a pin at once, before the owner task exists
+ *
+ * For the fast-restore path at the top of app_main(). The pin then
+ * keeps this level (no reset, no glitch) until the first module opens it.
+ */
+void panel_output_restore(gpio_num_t pin, bool on);
+
+/*
+ * @brief Create the owner task (call once from app_main, before the demos)
+ */
+esp_err_t panel_output_start(void);
+
+/*
+ * @brief Start posting on a pin (request: RELEASE)
+ *
+ * The first poster of a pin configures it as output.
+ * @return ESP_ERR_INVALID_STATE if the manager is not started,
+ *         ESP_ERR_NO_MEM if the pin or poster table is full
+ */
+esp_err_t panel_output_open(panel_output_t *out, gpio_num_t pin, uint8_t priority, const char *name);
+
+// Stop posting; the last poster of a pin switches it OFF and releases it
+void panel_output_close(panel_output_t *out);
+
+// Post a steady level (any task)
+void panel_output_set(panel_output_t *out, bool on);
+
+// Post a 50% blink starting ON; the same period again keeps the running phase
+void panel_output_blink(panel_output_t *out, uint32_t half_period_ms);
+
+// Withdraw the request, lower priorities show again
+void panel_output_release(panel_output_t *out);
+
+/*
+ * @brief Drive the pin and post a steady level from an interrupt handler (IRAM)
+ *
+ * For outputs that cannot wait for the owner task (E-STOP lamp latch).
+ * The pin is written at once, also when a lower priority was blinking
+ * it in LEDC. The owner task then rewrites the composite on its next
+ * pass, even if the request was already withdrawn again by then.
+ */
+void panel_output_set_from_isr(panel_output_t *out, bool on);
+
+// Print pins, composite patterns and posters
+void panel_output_print(void);
+
+// Add the "outputs" command
+esp_err_t panel_output_register_console(void);
+
+#endif
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include "panel_pm.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_sleep.h"
+#include "hal/gpio_ll.h"
+#endif
+
+#define TAG "PANEL_PM"
+
+esp_err_t panel_pm_init(void)
+{
+#if CONFIG_PANEL_PM_LIGHT_SLEEP
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_PANEL_PM_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Power management not configured: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Buttons wake the chip from light sleep through their level interrupt
+    err = esp_sleep_enable_gpio_wakeup();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Light sleep enabled: CPU %d..%d MHz, tickless idle %s",
+             CONFIG_PANEL_PM_MIN_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             pm_config.light_sleep_enable ? "ON" : "OFF");
+#else
+    ESP_LOGI(TAG, "Power management disabled (CONFIG_PM_ENABLE not set)");
+#endif
+    return ESP_OK;
+}
+
+/*
+ * Runs from IRAM (ISR service installed with ESP_INTR_FLAG_IRAM), so a
+ * button is still handled while the flash cache is disabled.
+ */
+static void IRAM_ATTR button_isr(void *arg)
+{
+    panel_pm_button_t *button = (panel_pm_button_t *)arg;
+    BaseType_t woken = pdFALSE;
+
+    // Level interrupt: disable until the task re-arms for the other level
+#if CONFIG_IDF_TARGET_LINUX
+    gpio_intr_disable(button->pin);
+#else
+    gpio_ll_intr_disable(&GPIO, button->pin);
+#endif
+    button->fired = true;
+    if (button->hook) {
+        button->hook(button->hook_arg);
+    }
+    vTaskNotifyGiveFromISR(button->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+esp_err_t panel_pm_button_init(panel_pm_button_t *button, gpio_num_t pin)
+{
+    button->pin = pin;
+    button->task = xTaskGetCurrentTaskHandle();
+    button->hook = NULL;
+    button->hook_arg = NULL;
+    button->virtual_pressed = false;
+    button->fired = false;
+    button->seen_level = 1;
+
+    // Shared ISR service: already installed by another module is fine
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+    gpio_intr_disable(pin);
+    return gpio_isr_handler_add(pin, button_isr, button);
+}
+
+void panel_pm_button_deinit(panel_pm_button_t *button)
+{
+    gpio_intr_disable(button->pin);
+    gpio_wakeup_disable(button->pin);
+    gpio_isr_handler_remove(button->pin);
+    button->task = NULL;
+}
+
+int panel_pm_button_get_level(panel_pm_button_t *button)
+{
+    button->seen_level = gpio_get_level(button->pin);
+    return button->virtual_pressed ? 0 : button->seen_level;
+}
+
+void panel_pm_button_inject(panel_pm_button_t *button, bool pressed)
+{
+    button->virtual_pressed = pressed;
+    if (button->task) {
+        xTaskNotifyGive(button->task);
+    }
+}
+
+void panel_pm_button_set_isr_hook(panel_pm_button_t *button, panel_pm_button_hook_t hook, void *arg)
+{
+    gpio_intr_disable(button->pin);   // Not while the ISR may be running
+    button->hook_arg = arg;
+    button->hook = hook;
+}
+
+void panel_pm_button_arm(panel_pm_button_t *button)
+{
+    // Sets the level interrupt type and marks the pin as light-sleep wake source
+    button->fired = false;
+    gpio_wakeup_enable(button->pin, button->seen_level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    gpio_intr_enable(button->pin);
+}
+
+void panel_pm_button_disarm(panel_pm_button_t *button)
+{
+    gpio_intr_disable(button->pin);
+}
+
+#if CONFIG_PM_ENABLE
+esp_err_t panel_pm_lock_init(panel_pm_lock_t *lock, const char *name)
+{
+    lock->held = false;
+    return esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, name, &lock->handle);
+}
+
+void panel_pm_lock_hold(panel_pm_lock_t *lock, bool hold)
+{
+    if (hold == lock->held || lock->handle == NULL) {
+        return;
+    }
+    if (hold) {
+        esp_pm_lock_acquire(lock->handle);
+    } else {
+        esp_pm_lock_release(lock->handle);
+    }
+    lock->held = hold;
+}
+
+void panel_pm_lock_deinit(panel_pm_lock_t *lock)
+{
+    panel_pm_lock_hold(lock, false);
+    if (lock->handle != NULL) {
+        esp_pm_lock_delete(lock->handle);
+        lock->handle = NULL;
+    }
+}
+#endif
+
+void panel_pm_wake_count(panel_pm_wake_counter_t *counter)
+{
+#if CONFIG_PANEL_PM_WAKE_REPORT_PERIOD > 0
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t period_ms = CONFIG_PANEL_PM_WAKE_REPORT_PERIOD * 1000;
+
+    counter->count++;
+    if (now_ms - counter->window_start_ms >= period_ms) {
+        uint32_t elapsed_ms = now_ms - counter->window_start_ms;
+        uint32_t per_10s = counter->count * 10000 / elapsed_ms;  // one decimal place
+        ESP_LOGI(TAG, "%s: %lu wakeups in %lu ms (%lu.%lu /s)",
+                 counter->name, (unsigned long)counter->count, (unsigned long)elapsed_ms,
+                 (unsigned long)(per_10s / 10), (unsigned long)(per_10s % 10));
+        counter->count = 0;
+        counter->window_start_ms = now_ms;
+    }
+#endif
+}
@@ -0,0 +1,137 @@
+#ifndef PANEL_PM_H
+#define PANEL_PM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+/*
+ * Panel Power Management
+ * ----------------------
+ * Battery-backed remote panels spend almost all their life doing
+ * nothing. Instead of waking every 50 ms to poll a button, each
+ * controller loop blocks until:
+ *  - The button level changes   → GPIO interrupt / GPIO light-sleep wakeup
+ *  - The next LED transition    → FreeRTOS timeout (tickless idle timer)
+ * 
+ * With CONFIG_PM_ENABLE + CONFIG_FREERTOS_USE_TICKLESS_IDLE the chip
+ * then drops into light sleep between those events.
+ * Without CONFIG_PM_ENABLE the lock helpers compile to nothing.
+ */
+
+#define PANEL_PM_WAIT_FOREVER  UINT32_MAX
+
+/*
+ * @brief Configure frequency scaling and automatic light sleep
+ * 
+ * Call once from app_main(). Does nothing without CONFIG_PM_ENABLE.
+ */
+esp_err_t panel_pm_init(void);
+
+/*
+ * BUTTON WAKE SOURCE:
+ * -------------------
+ * The pin interrupt is armed for the OPPOSITE of the level the loop
+ * just read (released → wait for LOW, pressed → wait for HIGH).
+ * Level triggering is required for light-sleep GPIO wakeup and
+ * cannot miss a change that happened between read and wait.
+ */
+typedef void (*panel_pm_button_hook_t)(void *arg);
+
+typedef struct {
+    gpio_num_t pin;
+    TaskHandle_t task;   // Task notified on level change
+    panel_pm_button_hook_t hook;   // Optional, runs in the ISR before the task is notified
+    void *hook_arg;
+    volatile bool virtual_pressed; // Injected press (console / soak test), pin not touched
+    volatile bool fired; // Interrupt ran since the last panel_pm_button_arm()
+    int seen_level;      // Physical level at the last panel_pm_button_get_level()
+} panel_pm_button_t;
+
+/*
+ * @brief Prepare a (pull-up) button pin as wake source for the calling task
+ */
+esp_err_t panel_pm_button_init(panel_pm_button_t *button, gpio_num_t pin);
+
+// Remove the interrupt handler and wake source again
+void panel_pm_button_deinit(panel_pm_button_t *button);
+
+/*
+ * @brief Read the button: 1 = released, 0 = pressed (pin LOW or injected)
+ * 
+ * Remembers the physical level for the next panel_pm_button_arm().
+ */
+int panel_pm_button_get_level(panel_pm_button_t *button);
+
+/*
+ * @brief Virtual press / release, as if the operator used the button
+ * 
+ * Wakes the owner task. Safe to call from any task.
+ */
+void panel_pm_button_inject(panel_pm_button_t *button, bool pressed);
+
+/*
+ * @brief Run hook(arg) inside the button interrupt (IRAM, no blocking calls)
+ * 
+ * For outputs that must react faster than the owner task can be
+ * scheduled (e.g. E-STOP lamp latch). The hook must be IRAM_ATTR.
+ */
+void panel_pm_button_set_isr_hook(panel_pm_button_t *button, panel_pm_button_hook_t hook, void *arg);
+
+/*
+ * @brief Arm / disarm the wake interrupt without blocking
+ * 
+ * Armed, the interrupt fires when the pin leaves the level seen by
+ * the last panel_pm_button_get_level(). The owner task (input_bus)
+ * arms all its buttons, blocks on its task notification, disarms all.
+ */
+void panel_pm_button_arm(panel_pm_button_t *button);
+void panel_pm_button_disarm(panel_pm_button_t *button);
+
+/*
+ * NO-LIGHT-SLEEP LOCK:
+ * --------------------
+ * Held while an operator interaction is in progress (debounce,
+ * long-press timing, boot sequence). Sleeping between 50 ms samples
+ * costs more than it saves and adds wake-up latency.
+ */
+typedef struct {
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t handle;
+#endif
+    bool held;
+} panel_pm_lock_t;
+
+#if CONFIG_PM_ENABLE
+esp_err_t panel_pm_lock_init(panel_pm_lock_t *lock, const char *name);
+void panel_pm_lock_hold(panel_pm_lock_t *lock, bool hold);
+void panel_pm_lock_deinit(panel_pm_lock_t *lock);
+#else
+static inline esp_err_t panel_pm_lock_init(panel_pm_lock_t *lock, const char *name) { lock->held = false; return ESP_OK; }
+static inline void panel_pm_lock_hold(panel_pm_lock_t *lock, bool hold) { lock->held = hold; }
+static inline void panel_pm_lock_deinit(panel_pm_lock_t *lock) { lock->held = false; }
+#endif
+
+/*
+ * WAKEUP COUNTER:
+ * ---------------
+ * Count every loop iteration and periodically log wakeups per second.
+ * Old polling loops: ~20 wakeups/s even when nothing happens.
+ */
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t window_start_ms;
+} panel_pm_wake_counter_t;
+
+#define PANEL_PM_WAKE_COUNTER(label)  { .name = (label), .count = 0, .window_start_ms = 0 }
+
+void panel_pm_wake_count(panel_pm_wake_counter_t *counter);
+
+#endif
@@ -0,0 +1,499 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "panel_soak.h"
+#include "debounce.h"
+#include "gesture.h"
+#include "estop_logic.h"
+#include "power_logic.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#define MAX_REPORTED_VIOLATIONS  5
+#define MAX_FEEDS_SAME_TIME      8         // More feeds at one timestamp = logic stuck
+#define MAX_CHATTER              2         // Extra bounce pulses per edge
+#define MAX_HOLD_DROPOUTS        2         // Contact openings in the middle of one hold
+#define YIELD_PERIOD_US          1000000   // Let the idle task run (task watchdog)
+#define DEFAULT_OPERATIONS       100000
+
+/*
+ * SIMULATED BUTTON + LOGIC UNDER TEST:
+ * ------------------------------------
+ * Each machine has its own millisecond clock. Time only moves forward
+ * by jumping to the next raw edge or to the deadline the logic asked
+ * for - exactly what the controller loops do with their waits.
+ */
+typedef enum {
+    MACHINE_ESTOP,
+    MACHINE_POWER,
+    MACHINE_MODE,
+    MACHINE_COUNT,
+} machine_id_t;
+
+static const char *machine_names[] = { "estop", "power", "mode" };
+
+#define EVENT_SLOTS 5   // Largest event enum (gesture_type_t) + 1
+
+typedef struct {
+    machine_id_t id;
+    uint32_t debounce_ms;
+    uint32_t long_press_ms;        // Power / mode
+    uint32_t click_window_ms;      // Mode
+    uint32_t bounce_max_ms;        // Longest single bounce level (< debounce)
+    uint32_t now_ms;
+    bool raw_pressed;
+    uint32_t count[EVENT_SLOTS];   // Events since the operation started, by event enum
+    uint8_t last_clicks;
+    estop_logic_t estop;
+    power_logic_t power;
+    debounce_t mode_debounce;
+    gesture_t gesture;
+} machine_t;
+
+typedef struct {
+    uint32_t rng;
+    uint32_t op;
+    const char *op_name;
+    bool model_alarm;              // E-STOP alarm state the operator expects
+    panel_soak_result_t *result;
+} soak_t;
+
+// xorshift32: fast, reproducible from the seed, never 0
+static uint32_t rng_next(soak_t *s)
+{
+    uint32_t x = s->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s->rng = x;
+    return x;
+}
+
+static uint32_t rng_range(soak_t *s, uint32_t lo, uint32_t hi)
+{
+    if (hi <= lo) {
+        return lo;
+    }
+    return lo + rng_next(s) % (hi - lo + 1);
+}
+
+static void violation(soak_t *s, const machine_t *m, const char *what)
+{
+    if (s->result->violations < MAX_REPORTED_VIOLATIONS) {
+        printf("soak: op %lu %s/%s @ %lu ms: %s\n", (unsigned long)s->op, machine_names[m->id],
+               s->op_name, (unsigned long)m->now_ms, what);
+    }
+    s->result->violations++;
+}
+
+static void count_event(soak_t *s, machine_t *m, int event)
+{
+    m->count[event]++;
+    s->result->events++;
+}
+
+static void machine_feed(soak_t *s, machine_t *m)
+{
+    s->result->feeds++;
+    switch (m->id) {
+        case MACHINE_ESTOP: {
+            estop_event_t event = estop_logic_feed(&m->estop, m->raw_pressed, m->now_ms);
+            if (event != ESTOP_EVENT_NONE) {
+                count_event(s, m, event);
+            }
+            break;
+        }
+        case MACHINE_POWER: {
+            power_event_t event = power_logic_feed(&m->power, m->raw_pressed, m->now_ms);
+            if (event != POWER_EVENT_NONE) {
+                count_event(s, m, event);
+            }
+            break;
+        }
+        case MACHINE_MODE: {
+            // Same pipeline as mode_selector_run(): debounce → gesture
+            gesture_event_t event;
+            if (debounce_feed(&m->mode_debounce, m->raw_pressed, m->now_ms) &&
+                gesture_feed(&m->gesture, m->mode_debounce.stable_pressed, m->now_ms, &event)) {
+                count_event(s, m, event.type);
+                m->last_clicks = event.clicks;
+            }
+            while (gesture_poll(&m->gesture, m->now_ms, &event)) {
+                count_event(s, m, event.type);
+                m->last_clicks = event.clicks;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static uint32_t machine_ms_to_deadline(const machine_t *m)
+{
+    switch (m->id) {
+        case MACHINE_ESTOP:
+            return estop_logic_ms_to_deadline(&m->estop, m->now_ms);
+        case MACHINE_POWER:
+            return power_logic_ms_to_deadline(&m->power, m->now_ms);
+        case MACHINE_MODE: {
+            uint32_t wait_ms = debounce_ms_to_deadline(&m->mode_debounce, m->now_ms);
+            uint32_t gesture_wait_ms = gesture_ms_to_deadline(&m->gesture, m->now_ms);
+            return gesture_wait_ms < wait_ms ? gesture_wait_ms : wait_ms;
+        }
+        default:
+            return DEBOUNCE_NO_DEADLINE;
+    }
+}
+
+// Let duration_ms pass with the current raw level, serving every deadline on the way
+static void machine_advance(soak_t *s, machine_t *m, uint32_t duration_ms)
+{
+    uint32_t end_ms = m->now_ms + duration_ms;  // May wrap: differences stay correct
+    int feeds_same_time = 0;
+
+    while (1) {
+        uint32_t wait_ms = machine_ms_to_deadline(m);
+        if (wait_ms > end_ms - m->now_ms) {
+            break;
+        }
+        if (wait_ms > 0) {
+            feeds_same_time = 0;
+        } else if (++feeds_same_time > MAX_FEEDS_SAME_TIME) {
+            violation(s, m, "deadline never cleared (loop would spin)");
+            break;
+        }
+        m->now_ms += wait_ms;
+        machine_feed(s, m);
+    }
+    m->now_ms = end_ms;
+}
+
+// Raw level change after_ms from now
+static void machine_edge(soak_t *s, machine_t *m, uint32_t after_ms, bool pressed)
+{
+    machine_advance(s, m, after_ms);
+    m->raw_pressed = pressed;
+    s->result->edges++;
+    machine_feed(s, m);
+}
+
+/*
+ * Contact bounce: up to MAX_CHATTER short pulses, then the final edge.
+ * Every bounce level is shorter than debounce, so only the final
+ * level may be accepted. Takes at most 4 × bounce_max_ms.
+ */
+static void machine_bounce_to(soak_t *s, machine_t *m, uint32_t first_after_ms, bool pressed)
+{
+    uint32_t after_ms = first_after_ms;
+    uint32_t chatter = rng_range(s, 0, MAX_CHATTER);
+
+    for (uint32_t i = 0; i < chatter; i++) {
+        machine_edge(s, m, after_ms, pressed);
+        machine_edge(s, m, rng_range(s, 1, m->bounce_max_ms), !pressed);
+        after_ms = rng_range(s, 1, m->bounce_max_ms);
+    }
+    machine_edge(s, m, after_ms, pressed);
+}
+
+// Noise: LOW pulses all shorter than debounce, nothing may happen
+static void op_glitch(soak_t *s, machine_t *m)
+{
+    s->op_name = "glitch";
+    uint32_t pulses = rng_range(s, 1, 8);
+    for (uint32_t i = 0; i < pulses; i++) {
+        machine_edge(s, m, rng_range(s, 1, 2 * m->debounce_ms), true);
+        machine_edge(s, m, rng_range(s, 1, m->debounce_ms - 1), false);
+    }
+}
+
+/*
+ * One press: hold_ms counts from the last bounce of the press to the
+ * first bounce of the release.
+ * Mid-hold bounce: up to MAX_HOLD_DROPOUTS contact openings shorter
+ * than debounce, each with a settled press (over debounce) before and
+ * after it, so the press is accepted first and the hold time stays
+ * hold_ms. Nothing may see them as a release.
+ */
+static void op_press(soak_t *s, machine_t *m, uint32_t idle_ms, uint32_t hold_ms)
+{
+    machine_bounce_to(s, m, idle_ms, true);
+
+    uint32_t left_ms = hold_ms;
+    uint32_t dropouts = rng_range(s, 0, MAX_HOLD_DROPOUTS);
+    for (uint32_t i = 0; i < dropouts; i++) {
+        uint32_t open_ms = rng_range(s, 1, m->debounce_ms - 1);
+        if (left_ms < 2 * (m->debounce_ms + 1) + open_ms) {
+            break;  // Hold too short for another settled opening
+        }
+        uint32_t closed_ms = rng_range(s, m->debounce_ms + 1, left_ms - open_ms - m->debounce_ms - 1);
+        machine_edge(s, m, closed_ms, false);
+        machine_edge(s, m, open_ms, true);
+        left_ms -= closed_ms + open_ms;
+    }
+    machine_bounce_to(s, m, left_ms, false);
+}
+
+static uint32_t events_total(const machine_t *m)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < EVENT_SLOTS; i++) {
+        total += m->count[i];
+    }
+    return total;
+}
+
+static void run_estop(soak_t *s, machine_t *m)
+{
+    if (rng_range(s, 0, 3) == 0) {
+        op_glitch(s, m);
+        machine_advance(s, m, m->debounce_ms + 1);
+        if (events_total(m) != 0) {
+            violation(s, m, "alarm toggled by a glitch");
+        }
+        return;
+    }
+
+    s->op_name = "press";
+    op_press(s, m, rng_range(s, 1, 1000), rng_range(s, m->debounce_ms, 20 * m->debounce_ms));
+    machine_advance(s, m, m->debounce_ms + 1);
+
+    s->model_alarm = !s->model_alarm;
+    if (events_total(m) == 0) {
+        violation(s, m, "E-STOP press missed");
+    } else if (events_total(m) > 1) {
+        violation(s, m, "alarm toggled more than once by one press");
+    } else if (m->estop.alarm_active != s->model_alarm ||
+               m->count[s->model_alarm ? ESTOP_EVENT_ALARM_ON : ESTOP_EVENT_ALARM_OFF] != 1) {
+        violation(s, m, "alarm toggled the wrong way");
+    }
+    s->model_alarm = m->estop.alarm_active;  // Report a wrong state once, not forever
+}
+
+static void run_power(soak_t *s, machine_t *m)
+{
+    uint32_t kind = rng_range(s, 0, 3);
+    uint32_t bounce_total_ms = 4 * m->bounce_max_ms;
+
+    if (kind == 0) {
+        op_glitch(s, m);
+        machine_advance(s, m, m->debounce_ms + 1);
+        if (events_total(m) != 0) {
+            violation(s, m, "glitch reported as a press");
+        }
+        return;
+    }
+
+    bool is_long = (kind == 3);
+    uint32_t hold_ms;
+    if (is_long) {
+        s->op_name = "long";
+        hold_ms = rng_range(s, m->long_press_ms + m->debounce_ms, 2 * m->long_press_ms);
+    } else {
+        // Released (after bounce + debounce) well before the long-press time
+        s->op_name = "short";
+        hold_ms = rng_range(s, m->debounce_ms, m->long_press_ms - bounce_total_ms - 2 * m->debounce_ms);
+    }
+    op_press(s, m, rng_range(s, 1, 1000), hold_ms);
+    machine_advance(s, m, m->debounce_ms + 1);
+
+    if (m->count[POWER_EVENT_PRESS] != 1) {
+        violation(s, m, "press not confirmed exactly once");
+    } else if (is_long && m->count[POWER_EVENT_LONG_PRESS] != 1) {
+        violation(s, m, m->count[POWER_EVENT_LONG_PRESS] ? "long press handled twice" : "long press missed");
+    } else if (is_long && m->count[POWER_EVENT_SHORT_PRESS] != 0) {
+        violation(s, m, "long press also reported as short");
+    } else if (!is_long && (m->count[POWER_EVENT_LONG_PRESS] != 0 || m->count[POWER_EVENT_SHORT_PRESS] != 1)) {
+        violation(s, m, "short press switched power");
+    } else if (m->power.timing || m->power.wait_release) {
+        violation(s, m, "still busy after release");
+    }
+}
+
+static void run_mode(soak_t *s, machine_t *m)
+{
+    uint32_t kind = rng_range(s, 0, 4);
+    uint32_t settle_ms = m->debounce_ms + m->click_window_ms + 1;
+
+    if (kind == 0) {
+        op_glitch(s, m);
+        machine_advance(s, m, settle_ms);
+        if (events_total(m) != 0) {
+            violation(s, m, "glitch recognised as a gesture");
+        }
+        return;
+    }
+
+    if (kind == 1) {
+        s->op_name = "long";
+        op_press(s, m, rng_range(s, 1, 1000),
+                 rng_range(s, m->long_press_ms + m->debounce_ms, 2 * m->long_press_ms));
+        machine_advance(s, m, settle_ms);
+        if (m->count[GESTURE_LONG_PRESS] != 1 || m->count[GESTURE_LONG_RELEASE] != 1 ||
+            events_total(m) != 2) {
+            violation(s, m, "long hold not LONG_PRESS + LONG_RELEASE");
+        }
+        return;
+    }
+
+    // Click sequence: every gap well inside the click window
+    s->op_name = "clicks";
+    uint32_t clicks = rng_range(s, 1, m->gesture.cfg.max_clicks);
+    uint32_t idle_ms = rng_range(s, 1, 1000);
+    for (uint32_t i = 0; i < clicks; i++) {
+        op_press(s, m, idle_ms, rng_range(s, m->debounce_ms, m->long_press_ms / 4));
+        idle_ms = rng_range(s, m->debounce_ms, m->click_window_ms / 4);
+    }
+    machine_advance(s, m, settle_ms);
+    if (m->count[GESTURE_CLICK] != 1 || events_total(m) != 1) {
+        violation(s, m, "click sequence not reported exactly once");
+    } else if (m->last_clicks != clicks) {
+        violation(s, m, "wrong click count");
+    }
+}
+
+static void machine_init(machine_t *m, machine_id_t id, uint32_t start_ms)
+{
+    memset(m, 0, sizeof(*m));
+    m->id = id;
+    m->now_ms = start_ms;
+
+    switch (id) {
+        case MACHINE_ESTOP:
+            m->debounce_ms = CONFIG_EMERGENCY_DEBOUNCE_MS;
+            estop_logic_init(&m->estop, m->debounce_ms, false);
+            break;
+        case MACHINE_POWER:
+            m->debounce_ms = CONFIG_LONG_PRESS_POWER_DEBOUNCE_MS;
+            m->long_press_ms = CONFIG_LONG_PRESS_POWER_LONG_PRESS_MS;
+            power_logic_init(&m->power, m->debounce_ms, m->long_press_ms);
+            break;
+        case MACHINE_MODE: {
+            m->debounce_ms = CONFIG_MODE_SELECTOR_DEBOUNCE_MS;
+            m->long_press_ms = CONFIG_MODE_SELECTOR_LONG_PRESS_MS;
+            m->click_window_ms = CONFIG_MODE_SELECTOR_CLICK_WINDOW_MS;
+            gesture_config_t cfg = GESTURE_CONFIG_DEFAULT();
+            cfg.click_window_ms = m->click_window_ms;
+            cfg.long_press_ms = m->long_press_ms;
+            debounce_init(&m->mode_debounce, m->debounce_ms, false);
+            gesture_init(&m->gesture, &cfg);
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Mode clicks must fit into the click window: keep bounce short there
+    m->bounce_max_ms = m->debounce_ms - 1;
+    if (id == MACHINE_MODE) {
+        uint32_t limit_ms = m->click_window_ms < m->long_press_ms ? m->click_window_ms : m->long_press_ms;
+        if (limit_ms / 16 < m->bounce_max_ms) {
+            m->bounce_max_ms = limit_ms / 16;
+        }
+    }
+    if (m->bounce_max_ms == 0) {
+        m->bounce_max_ms = 1;
+    }
+}
+
+esp_err_t panel_soak_run(uint32_t seed, uint32_t operations, panel_soak_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+    result->seed = seed;
+
+    // Short and long must stay clearly apart, or no invariant can hold
+    if (CONFIG_LONG_PRESS_POWER_LONG_PRESS_MS < 8 * CONFIG_LONG_PRESS_POWER_DEBOUNCE_MS ||
+        CONFIG_MODE_SELECTOR_LONG_PRESS_MS < 4 * CONFIG_MODE_SELECTOR_DEBOUNCE_MS ||
+        CONFIG_MODE_SELECTOR_CLICK_WINDOW_MS < 4 * CONFIG_MODE_SELECTOR_DEBOUNCE_MS) {
+        printf("soak: debounce too long for the configured long-press / click window\n");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    soak_t s = {
+        .rng = seed ? seed : 1,
+        .result = result,
+    };
+
+    // Clocks start shortly before the 32-bit wrap: every run crosses it
+    machine_t machines[MACHINE_COUNT];
+    for (int i = 0; i < MACHINE_COUNT; i++) {
+        machine_init(&machines[i], (machine_id_t)i, UINT32_MAX - rng_range(&s, 0, 600000));
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int64_t yield_us = start_us;
+    for (s.op = 0; s.op < operations; s.op++) {
+        machine_t *m = &machines[rng_next(&s) % MACHINE_COUNT];
+        memset(m->count, 0, sizeof(m->count));
+
+        switch (m->id) {
+            case MACHINE_ESTOP: run_estop(&s, m); break;
+            case MACHINE_POWER: run_power(&s, m); break;
+            case MACHINE_MODE:  run_mode(&s, m);  break;
+            default: break;
+        }
+
+        if ((s.op & 0x3ff) == 0 && esp_timer_get_time() - yield_us > YIELD_PERIOD_US) {
+            vTaskDelay(1);
+            yield_us = esp_timer_get_time();
+        }
+    }
+    result->operations = operations;
+    result->elapsed_us = esp_timer_get_time() - start_us;
+    return ESP_OK;
+}
+
+void panel_soak_print(const panel_soak_result_t *result)
+{
+    uint64_t per_s = result->elapsed_us > 0 ?
+                     (uint64_t)result->feeds * 1000000 / (uint64_t)result->elapsed_us : 0;
+
+    printf("Soak seed %lu: %lu operations, %lu raw edges, %lu logic feeds, %lu events\n",
+           (unsigned long)result->seed, (unsigned long)result->operations,
+           (unsigned long)result->edges, (unsigned long)result->feeds, (unsigned long)result->events);
+    printf("  %lld ms, %llu logic feeds/s (%llu per minute)\n",
+           (long long)(result->elapsed_us / 1000), (unsigned long long)per_s,
+           (unsigned long long)(per_s * 60));
+    if (result->violations == 0) {
+        printf("  PASS: all invariants held\n");
+    } else {
+        printf("  FAIL: %lu invariant violations (rerun with the same seed to reproduce)\n",
+               (unsigned long)result->violations);
+    }
+}
+
+static int cmd_soak(int argc, char **argv)
+{
+    uint32_t operations = DEFAULT_OPERATIONS;
+    uint32_t seed = (uint32_t)esp_timer_get_time();
+
+    if (argc > 1) {
+        operations = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        seed = strtoul(argv[2], NULL, 0);
+    }
+
+    panel_soak_result_t result;
+    if (panel_soak_run(seed, operations, &result) != ESP_OK) {
+        return 1;
+    }
+    panel_soak_print(&result);
+    return result.violations ? 1 : 0;
+}
+
+esp_err_t panel_soak_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "soak",
+        .help = "Randomised button soak test of the E-STOP, power and mode logic "
+                "(default 100000 operations, random seed)",
+        .hint = "[operations] [seed]",
+        .func = &cmd_soak,
+    };
+    return esp_console_cmd_register(&cmd);
+}
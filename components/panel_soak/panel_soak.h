@@ -0,0 +1,61 @@
+#ifndef PANEL_SOAK_H
+#define PANEL_SOAK_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * Button Logic Soak Test
+ * ----------------------
+ * Rare input timing (bounce in the middle of a long press, a glitch
+ * right after a release, a press across the 32-bit ms wrap...) is
+ * where button code breaks, and nobody can press a button a million
+ * times by hand.
+ * 
+ * This harness drives the same pure logic the controllers use
+ * (estop_logic.h, power_logic.h, debounce.h + gesture.h) with
+ * randomised operator actions on a simulated millisecond clock:
+ *  - Contact bounce on every edge, contact openings shorter than
+ *    debounce in the middle of a hold, noise glitches shorter than
+ *    debounce
+ *  - Short presses, long presses, 1..3 click sequences
+ * 
+ * and checks after every action:
+ *  - E-STOP:  every real press toggles the alarm exactly once,
+ *             glitches never do (no missed E-STOP, no double toggle)
+ *  - Power:   every long press is reported exactly once, short
+ *             presses never switch power
+ *  - Mode:    a click sequence gives one CLICK with the right count,
+ *             a long hold gives LONG_PRESS + LONG_RELEASE only
+ *  - Logic never asks to be fed again and again at the same time
+ * 
+ * No GPIO and no sleeping: runs on the ESP32 and in the Linux host
+ * build at millions of logic feeds per minute. A seed reproduces a run.
+ */
+
+typedef struct {
+    uint32_t seed;
+    uint32_t operations;      // Generated operator actions
+    uint32_t edges;           // Raw level changes (including bounce)
+    uint32_t feeds;           // Logic calls: edges + deadline wake-ups
+    uint32_t events;          // Logic events checked
+    uint32_t violations;      // Invariant failures (0 = pass)
+    int64_t elapsed_us;
+} panel_soak_result_t;
+
+/*
+ * @brief Run a soak test with the menuconfig timing of each controller
+ * 
+ * Prints the first violations with the operation number.
+ * @return ESP_ERR_INVALID_ARG if the configured timings leave no room
+ *         between "short" and "long" (e.g. debounce >= long press / 4)
+ */
+esp_err_t panel_soak_run(uint32_t seed, uint32_t operations, panel_soak_result_t *result);
+
+// Print a result summary including logic feeds per second
+void panel_soak_print(const panel_soak_result_t *result);
+
+// Add the "soak" command: soak [operations] [seed]
+esp_err_t panel_soak_register_console(void);
+
+#endif
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <string.h>
+#include "task_monitor.h"
+#include "freertos/semphr.h"
+#include "esp_console.h"
+#include "esp_log.h"
+
+#define TAG "TASK_MONITOR"
+
+#define MONITOR_TASK_STACK     3072
+#define MONITOR_TASK_PRIORITY  1     // Just above idle: never disturbs the controllers
+
+#if CONFIG_TASK_MONITOR_ENABLE
+
+#define MAX_TASKS  CONFIG_TASK_MONITOR_MAX_TASKS
+#define MAX_LOOPS  CONFIG_TASK_MONITOR_MAX_LOOPS
+#define SNAPSHOT_SIZE  TASK_MONITOR_SNAPSHOT_MAX_SIZE(MAX_TASKS, MAX_LOOPS)
+
+// Registered controller loops
+static task_monitor_loop_t *loops[MAX_LOOPS];
+static int loop_count = 0;
+static portMUX_TYPE loops_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * SAMPLER STATE (only touched by the sampler task):
+ *  - status:    raw uxTaskGetSystemState() output
+ *  - prev_*:    counters of the previous sample, for per-window deltas
+ *  - work:      snapshot being built
+ */
+static TaskStatus_t status[MAX_TASKS];
+static struct {
+    TaskHandle_t task;
+    uint32_t run_time;
+} prev_tasks[MAX_TASKS];
+static int prev_task_count = 0;
+static uint32_t prev_total_run_time = 0;
+static int64_t prev_sample_us = 0;
+static struct {
+    uint32_t iterations;
+    uint32_t busy_total_us;
+} prev_loops[MAX_LOOPS];
+static uint8_t work[SNAPSHOT_SIZE];
+
+// Latest complete snapshot, copied out under the mutex
+static uint8_t latest[SNAPSHOT_SIZE];
+static size_t latest_len = 0;
+static SemaphoreHandle_t latest_mutex = NULL;
+
+esp_err_t task_monitor_loop_register(task_monitor_loop_t *loop, const char *name)
+{
+    memset(loop, 0, sizeof(*loop));
+    loop->name = name;
+    loop->task = xTaskGetCurrentTaskHandle();
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&loops_lock);
+    if (loop_count < MAX_LOOPS) {
+        // The slot may hold the counters of an unregistered loop: start the new one from 0
+        prev_loops[loop_count].iterations = 0;
+        prev_loops[loop_count].busy_total_us = 0;
+        loops[loop_count++] = loop;
+        err = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&loops_lock);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Loop '%s' not monitored: raise CONFIG_TASK_MONITOR_MAX_LOOPS", name);
+    }
+    return err;
+}
+
+void task_monitor_loop_unregister(task_monitor_loop_t *loop)
+{
+    /*
+     * Keep the order of the others: prev_loops[] is indexed like loops[].
+     * The sampler is blocked meanwhile, so it never sees a half update.
+     */
+    if (latest_mutex) {
+        xSemaphoreTake(latest_mutex, portMAX_DELAY);
+    }
+    taskENTER_CRITICAL(&loops_lock);
+    for (int i = 0; i < loop_count; i++) {
+        if (loops[i] == loop) {
+            for (int j = i; j < loop_count - 1; j++) {
+                loops[j] = loops[j + 1];
+                prev_loops[j] = prev_loops[j + 1];
+            }
+            loop_count--;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&loops_lock);
+    if (latest_mutex) {
+        xSemaphoreGive(latest_mutex);
+    }
+}
+
+static uint32_t previous_run_time(TaskHandle_t task, uint32_t fallback)
+{
+    for (int i = 0; i < prev_task_count; i++) {
+        if (prev_tasks[i].task == task) {
+            return prev_tasks[i].run_time;
+        }
+    }
+    return fallback;  // New task: counts from its creation
+}
+
+// Called with latest_mutex held: loops cannot be unregistered meanwhile
+static void take_sample_locked(void)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint32_t total_run_time = 0;
+
+    // Returns 0 when there are more tasks than buffer entries
+    UBaseType_t task_count = uxTaskGetSystemState(status, MAX_TASKS, &total_run_time);
+    if (task_count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks - sample skipped", MAX_TASKS);
+        return;
+    }
+
+    uint32_t window_run_time = total_run_time - prev_total_run_time;
+    task_monitor_header_t *header = (task_monitor_header_t *)work;
+    task_monitor_task_entry_t *task_entries = (task_monitor_task_entry_t *)(header + 1);
+
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        const TaskStatus_t *t = &status[i];
+        task_monitor_task_entry_t *entry = &task_entries[i];
+        uint32_t delta = t->ulRunTimeCounter - previous_run_time(t->xHandle, 0);
+
+        strncpy(entry->name, t->pcTaskName, TASK_MONITOR_NAME_LEN);
+        entry->cpu_permille = window_run_time ? (uint16_t)((uint64_t)delta * 1000 / window_run_time) : 0;
+        entry->stack_free = t->usStackHighWaterMark > UINT16_MAX ? UINT16_MAX : (uint16_t)t->usStackHighWaterMark;
+        entry->priority = (uint8_t)t->uxCurrentPriority;
+        entry->state = (uint8_t)t->eCurrentState;
+    }
+
+    // Remember counters for the next window
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        prev_tasks[i].task = status[i].xHandle;
+        prev_tasks[i].run_time = status[i].ulRunTimeCounter;
+    }
+    prev_task_count = task_count;
+    prev_total_run_time = total_run_time;
+
+    task_monitor_loop_entry_t *loop_entries = (task_monitor_loop_entry_t *)&task_entries[task_count];
+    int loops_now = __atomic_load_n(&loop_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < loops_now; i++) {
+        task_monitor_loop_t *loop = loops[i];
+        task_monitor_loop_entry_t *entry = &loop_entries[i];
+        uint32_t iterations = loop->iterations;
+        uint32_t busy_total_us = loop->busy_total_us;
+        uint32_t window_iterations = iterations - prev_loops[i].iterations;
+        uint32_t window_busy_us = busy_total_us - prev_loops[i].busy_total_us;
+
+        strncpy(entry->name, loop->name, TASK_MONITOR_NAME_LEN);
+        entry->iterations = window_iterations;
+        entry->busy_avg_us = window_iterations ? window_busy_us / window_iterations : 0;
+        entry->busy_max_us = loop->busy_max_us;
+        loop->busy_max_us = 0;  // Worst case per window (a racing update is just lost once)
+
+        prev_loops[i].iterations = iterations;
+        prev_loops[i].busy_total_us = busy_total_us;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    header->version = TASK_MONITOR_SNAPSHOT_VERSION;
+    header->task_count = (uint8_t)task_count;
+    header->loop_count = (uint8_t)loops_now;
+    header->cores = portNUM_PROCESSORS;
+    header->uptime_ms = (uint32_t)(now_us / 1000);
+    header->window_ms = (uint32_t)((now_us - prev_sample_us) / 1000);
+    int64_t sample_us = now_us - start_us;
+    header->sample_us = sample_us > UINT16_MAX ? UINT16_MAX : (uint16_t)sample_us;
+    prev_sample_us = now_us;
+
+    size_t len = (const uint8_t *)&loop_entries[loops_now] - work;
+    memcpy(latest, work, len);
+    latest_len = len;
+}
+
+static void take_sample(void)
+{
+    xSemaphoreTake(latest_mutex, portMAX_DELAY);
+    take_sample_locked();
+    xSemaphoreGive(latest_mutex);
+}
+
+static void monitor_task(void *arg)
+{
+    uint32_t samples = 0;
+
+    take_sample();  // First sample only sets the baseline
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_TASK_MONITOR_PERIOD_MS));
+        take_sample();
+        samples++;
+#if CONFIG_TASK_MONITOR_LOG_PERIOD > 0
+        if (samples % CONFIG_TASK_MONITOR_LOG_PERIOD == 0) {
+            task_monitor_print();
+        }
+#endif
+    }
+}
+
+esp_err_t task_monitor_start(void)
+{
+    if (latest_mutex != NULL) {
+        return ESP_ERR_INVALID_STATE;  // Already running
+    }
+    latest_mutex = xSemaphoreCreateMutex();
+    if (latest_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(monitor_task, "task_mon", MONITOR_TASK_STACK, NULL, MONITOR_TASK_PRIORITY, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Sampling %d tasks / %d loops every %d ms",
+             MAX_TASKS, MAX_LOOPS, CONFIG_TASK_MONITOR_PERIOD_MS);
+    return ESP_OK;
+}
+
+size_t task_monitor_snapshot(void *buf, size_t buf_len)
+{
+    if (latest_mutex == NULL) {
+        return 0;
+    }
+    size_t len = 0;
+    xSemaphoreTake(latest_mutex, portMAX_DELAY);
+    if (latest_len <= buf_len) {
+        memcpy(buf, latest, latest_len);
+        len = latest_len;
+    }
+    xSemaphoreGive(latest_mutex);
+    return len;
+}
+
+#else  // CONFIG_TASK_MONITOR_ENABLE
+
+#define SNAPSHOT_SIZE  TASK_MONITOR_SNAPSHOT_MAX_SIZE(0, 0)
+
+esp_err_t task_monitor_start(void)
+{
+    ESP_LOGW(TAG, "Disabled: enable FreeRTOS trace facility + run time stats");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+size_t task_monitor_snapshot(void *buf, size_t buf_len)
+{
+    return 0;
+}
+
+#endif  // CONFIG_TASK_MONITOR_ENABLE
+
+static const char *state_name(uint8_t state)
+{
+    static const char *names[] = {"RUN", "RDY", "BLK", "SUSP", "DEL"};
+    return state < sizeof(names) / sizeof(names[0]) ? names[state] : "?";
+}
+
+void task_monitor_print(void)
+{
+    static uint8_t snapshot[SNAPSHOT_SIZE];  // Too big for small console stacks
+    size_t len = task_monitor_snapshot(snapshot, sizeof(snapshot));
+    if (len < sizeof(task_monitor_header_t)) {
+        printf("No task sample yet\n");
+        return;
+    }
+
+    const task_monitor_header_t *header = (const task_monitor_header_t *)snapshot;
+    const task_monitor_task_entry_t *tasks = (const task_monitor_task_entry_t *)(header + 1);
+    const task_monitor_loop_entry_t *loops_in = (const task_monitor_loop_entry_t *)&tasks[header->task_count];
+
+    printf("Uptime %lu ms, window %lu ms, %d core(s), sample took %u us\n",
+           (unsigned long)header->uptime_ms, (unsigned long)header->window_ms,
+           header->cores, header->sample_us);
+    printf("%-12s %6s %9s %4s %5s\n", "TASK", "CPU%", "STACKFREE", "PRIO", "STATE");
+    for (int i = 0; i < header->task_count; i++) {
+        printf("%-12.*s %4u.%u %9u %4u %5s\n",
+               TASK_MONITOR_NAME_LEN, tasks[i].name,
+               tasks[i].cpu_permille / 10, tasks[i].cpu_permille % 10,
+               tasks[i].stack_free, tasks[i].priority, state_name(tasks[i].state));
+    }
+    if (header->loop_count > 0) {
+        printf("%-12s %10s %10s %10s\n", "LOOP", "ITER", "AVG_US", "MAX_US");
+        for (int i = 0; i < header->loop_count; i++) {
+            printf("%-12.*s %10lu %10lu %10lu\n",
+                   TASK_MONITOR_NAME_LEN, loops_in[i].name,
+                   (unsigned long)loops_in[i].iterations,
+                   (unsigned long)loops_in[i].busy_avg_us,
+                   (unsigned long)loops_in[i].busy_max_us);
+        }
+    }
+}
+
+static int cmd_tasks(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "bin") == 0) {
+        static uint8_t snapshot[SNAPSHOT_SIZE];
+        size_t len = task_monitor_snapshot(snapshot, sizeof(snapshot));
+        for (size_t i = 0; i < len; i++) {
+            printf("%02x%s", snapshot[i], (i % 32 == 31) ? "\n" : "");
+        }
+        printf("\n%u bytes\n", (unsigned)len);
+        return 0;
+    }
+    task_monitor_print();
+    return 0;
+}
+
+esp_err_t task_monitor_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "tasks",
+        .help = "Per-task CPU %, free stack and loop timing. 'tasks bin' = binary snapshot as hex",
+        .hint = "[bin]",
+        .func = &cmd_tasks,
+    };
+    return esp_console_cmd_register(&cmd);
+}
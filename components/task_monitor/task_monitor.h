@@ -0,0 +1,144 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#if CONFIG_TASK_MONITOR_ENABLE
+#include "esp_timer.h"
+#endif
+
+/*
+ * Task Monitor
+ * ------------
+ * Answers the questions every commissioning engineer asks:
+ *  - How much CPU does each controller task use?
+ *  - How close is each stack to overflowing?
+ *  - How long does one loop iteration take (average / worst)?
+ *
+ * A low-priority sampler task calls uxTaskGetSystemState() once per
+ * CONFIG_TASK_MONITOR_PERIOD_MS into static buffers (no heap, bounded
+ * work). Controller loops only add two timestamp reads per iteration.
+ *
+ * Results are available as:
+ *  - A compact binary snapshot (for a host tool / fieldbus register)
+ *  - The console command "tasks" (text table, "tasks bin" = hex dump)
+ */
+
+/*
+ * LOOP TIMING:
+ *  - task_monitor_loop_begin() right after the loop wakes up
+ *  - task_monitor_loop_end()   right before it blocks again
+ * Counters are 32-bit and only ever written by the owner task, the
+ * sampler works with differences (wrap-around safe).
+ */
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    uint32_t iterations;      // Completed iterations
+    uint32_t busy_total_us;   // Sum of iteration times
+    uint32_t busy_max_us;     // Worst iteration since last sample
+    int64_t begin_us;
+} task_monitor_loop_t;
+
+#if CONFIG_TASK_MONITOR_ENABLE
+
+// Register a loop of the calling task (loop struct must stay alive)
+esp_err_t task_monitor_loop_register(task_monitor_loop_t *loop, const char *name);
+
+// Remove a loop again (before its task exits)
+void task_monitor_loop_unregister(task_monitor_loop_t *loop);
+
+static inline void task_monitor_loop_begin(task_monitor_loop_t *loop)
+{
+    loop->begin_us = esp_timer_get_time();
+}
+
+static inline void task_monitor_loop_end(task_monitor_loop_t *loop)
+{
+    uint32_t busy_us = (uint32_t)(esp_timer_get_time() - loop->begin_us);
+    loop->busy_total_us += busy_us;
+    if (busy_us > loop->busy_max_us) {
+        loop->busy_max_us = busy_us;
+    }
+    loop->iterations++;
+}
+
+#else
+
+static inline esp_err_t task_monitor_loop_register(task_monitor_loop_t *loop, const char *name)
+{
+    loop->name = name;
+    return ESP_OK;
+}
+static inline void task_monitor_loop_unregister(task_monitor_loop_t *loop) { }
+static inline void task_monitor_loop_begin(task_monitor_loop_t *loop) { }
+static inline void task_monitor_loop_end(task_monitor_loop_t *loop) { }
+
+#endif
+
+/*
+ * BINARY SNAPSHOT (little endian, packed):
+ *   header
+ *   task_count × task entry
+ *   loop_count × loop entry
+ * Names are zero-padded, not always zero-terminated.
+ */
+#define TASK_MONITOR_SNAPSHOT_VERSION  1
+#define TASK_MONITOR_NAME_LEN          12
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;          // TASK_MONITOR_SNAPSHOT_VERSION
+    uint8_t task_count;
+    uint8_t loop_count;
+    uint8_t cores;            // CPU percentages are per core
+    uint32_t uptime_ms;       // Time of the sample
+    uint32_t window_ms;       // Time covered by CPU / loop figures
+    uint16_t sample_us;       // Cost of taking this sample
+} task_monitor_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[TASK_MONITOR_NAME_LEN];
+    uint16_t cpu_permille;    // Of one core, over the window
+    uint16_t stack_free;      // Stack high-water mark: bytes never used
+    uint8_t priority;
+    uint8_t state;            // eTaskState
+} task_monitor_task_entry_t;
+
+typedef struct __attribute__((packed)) {
+    char name[TASK_MONITOR_NAME_LEN];
+    uint32_t iterations;      // In the window
+    uint32_t busy_avg_us;
+    uint32_t busy_max_us;
+} task_monitor_loop_entry_t;
+
+/*
+ * @brief Start the sampler task
+ *
+ * @return ESP_ERR_NOT_SUPPORTED without CONFIG_TASK_MONITOR_ENABLE
+ */
+esp_err_t task_monitor_start(void);
+
+/*
+ * @brief Copy the latest sample as binary snapshot
+ *
+ * @return bytes written, 0 if no sample yet or buf too small
+ */
+size_t task_monitor_snapshot(void *buf, size_t buf_len);
+
+// Buffer size that always fits a snapshot
+#define TASK_MONITOR_SNAPSHOT_MAX_SIZE(max_tasks, max_loops)            \
+    (sizeof(task_monitor_header_t) +                                     \
+     (max_tasks) * sizeof(task_monitor_task_entry_t) +                   \
+     (max_loops) * sizeof(task_monitor_loop_entry_t))
+
+// Log the latest sample as a table
+void task_monitor_print(void);
+
+// Add the "tasks" command to the esp_console command set
+esp_err_t task_monitor_register_console(void);
+
+#endif
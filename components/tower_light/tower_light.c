@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tower_light.h"
+#include "esp_log.h"
+
+#if CONFIG_PANEL_TOWER_LIGHT
+#include "led_strip.h"
+#include "led_anim.h"
+#include "led_dither.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#define TAG "TOWER_LIGHT"
+
+#if defined(CONFIG_PANEL_TOWER_BENCH_GPIO) && CONFIG_PANEL_TOWER_BENCH_GPIO >= 0
+#define TOWER_BENCH  1
+#else
+#define TOWER_BENCH  0
+#endif
+#define BENCH_LEDS   256
+
+#if CONFIG_PANEL_TOWER_LIGHT
+
+#define TOWER_LEDS     (CONFIG_PANEL_TOWER_STATUS_LEDS + CONFIG_PANEL_TOWER_POWER_LEDS + CONFIG_PANEL_TOWER_ALARM_LEDS)
+#define SCALE(c)       ((c) * CONFIG_PANEL_TOWER_BRIGHTNESS / 255)
+#define TOWER_FADE_MS  150    // Switching ON / OFF
+
+/*
+ * ONE SEGMENT:
+ *  - layer: drawn by the animation engine
+ *  - pattern / half_period_ms: last posted, compared before every play
+ *  - hard_blink: BLINK as hard on / off (alarm) instead of a pulse
+ */
+typedef struct {
+    const char *name;
+    led_anim_rgb_t color;
+    uint16_t first;
+    uint16_t count;
+    bool hard_blink;
+    uint8_t pattern;            // tower_pattern_t
+    uint32_t half_period_ms;
+    led_anim_layer_t layer;
+} tower_segment_state_t;
+
+static tower_segment_state_t segments[TOWER_SEGMENT_COUNT] = {
+    [TOWER_SEGMENT_STATUS] = {
+        .name = "status", .color = { .b = SCALE(255) },
+        .first = 0, .count = CONFIG_PANEL_TOWER_STATUS_LEDS,
+    },
+    [TOWER_SEGMENT_POWER] = {
+        .name = "power", .color = { .g = SCALE(255) },
+        .first = CONFIG_PANEL_TOWER_STATUS_LEDS, .count = CONFIG_PANEL_TOWER_POWER_LEDS,
+    },
+    [TOWER_SEGMENT_ALARM] = {
+        .name = "alarm", .color = { .r = SCALE(255) },
+        .first = CONFIG_PANEL_TOWER_STATUS_LEDS + CONFIG_PANEL_TOWER_POWER_LEDS,
+        .count = CONFIG_PANEL_TOWER_ALARM_LEDS,
+        .hard_blink = true,
+    },
+};
+
+static led_strip_handle_t strip = NULL;
+static uint32_t frame_errors = 0;
+#if CONFIG_PANEL_TOWER_DITHER
+static led_strip_frame_t direct_frame;     // Pixel buffer of the RMT strip, pixels_8 NULL on SPI
+#endif
+
+// Driver object and pixel buffer: sized at build time, no heap
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+static LED_STRIP_STATIC_STORAGE(strip_storage, LED_STRIP_RMT_STATIC_SIZE(TOWER_LEDS, 3, LED_STRIP_COMPONENT_WIDTH_8, 0));
+#else
+static LED_STRIP_STATIC_STORAGE(strip_storage, LED_STRIP_SPI_STATIC_SIZE(TOWER_LEDS, 3, LED_STRIP_COMPONENT_WIDTH_8, 0));
+
+/*
+ * SPI BUS: initialised here, not by the strip, so the bench strip can
+ * join it. Sized for the longest transfer on it: the tower, or the
+ * bench at 4 components; 3 SPI bytes per colour byte.
+ */
+#if TOWER_BENCH && BENCH_LEDS > TOWER_LEDS
+#define SPI_BUS_LEDS      BENCH_LEDS
+#else
+#define SPI_BUS_LEDS      TOWER_LEDS
+#endif
+#define SPI_BUS_MAX_BYTES (SPI_BUS_LEDS * 4 * 3)
+#endif
+
+#if CONFIG_PANEL_TOWER_DITHER
+/*
+ * PUSH WITH DITHERING:
+ *  - Animation engine task, once per frame: the 16-bit frame goes to
+ *    the dithering engine (RAM only)
+ *  - Dithering task, at its refresh rate: 8-bit pixels into the
+ *    driver's buffer (written in place where the driver allows it),
+ *    one refresh for the whole tower
+ */
+static void push_frame(const uint16_t *rgb, uint16_t leds, void *ctx)
+{
+    led_dither_write(rgb, leds);
+}
+
+static void push_dithered(const uint8_t *rgb, uint16_t leds, void *ctx)
+{
+    if (direct_frame.pixels_8 != NULL) {
+        for (uint32_t i = 0; i < leds; i++) {
+            led_strip_frame_set_pixel(&direct_frame, i, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+        }
+    } else {
+        for (uint32_t i = 0; i < leds; i++) {
+            led_strip_set_pixel(strip, i, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+        }
+    }
+    if (led_strip_commit_frame(strip) != ESP_OK) {
+        frame_errors++;
+    }
+}
+#else
+/*
+ * PUSH (animation engine task, once per frame):
+ *  - Pixels into the driver's buffer (RAM only), rounded to 8 bits
+ *  - One refresh: the whole tower in one RMT / SPI transfer
+ */
+static void push_frame(const uint16_t *rgb, uint16_t leds, void *ctx)
+{
+    for (uint32_t i = 0; i < leds; i++) {
+        led_strip_set_pixel_16(strip, i, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+    }
+    if (led_strip_refresh(strip) != ESP_OK) {
+        frame_errors++;
+    }
+}
+#endif
+
+/*
+ * STRIP SETUP:
+ *  - WS2812, GRB byte order, created in strip_storage
+ *  - RMT: 10 MHz resolution, no DMA (a tower is a few dozen LEDs)
+ *  - SPI: SPI2, DMA (the encoded frame is sent in one transaction),
+ *    on a bus owned by this module, MOSI routed by the strip
+ */
+esp_err_t tower_light_init(void)
+{
+    if (strip != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = CONFIG_BLINK_GPIO,
+        .max_leds = TOWER_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+        .flags = {
+            .invert_out = false,
+        },
+    };
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+    led_strip_rmt_config_t rmt_config = {
+        .resolution_hz = 10 * 1000 * 1000,
+        .flags = {
+            .with_dma = false,
+        },
+    };
+    esp_err_t err = led_strip_rmt_init_static(&strip_config, &rmt_config, strip_storage, sizeof(strip_storage), &strip);
+#else
+    spi_bus_config_t bus_config = {
+        .mosi_io_num = -1,
+        .miso_io_num = -1,
+        .sclk_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = SPI_BUS_MAX_BYTES,
+    };
+    esp_err_t err = spi_bus_initialize(SPI2_HOST, &bus_config, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus not initialised: %s", esp_err_to_name(err));
+        return err;
+    }
+    led_strip_spi_config_t spi_config = {
+        .clk_src = SPI_CLK_SRC_DEFAULT,
+        .spi_bus = SPI2_HOST,
+        .flags = {
+            .with_dma = true,
+            .shared_bus = true,
+        },
+    };
+    err = led_strip_spi_init_static(&strip_config, &spi_config, strip_storage, sizeof(strip_storage), &strip);
+    if (err != ESP_OK) {
+        spi_bus_free(SPI2_HOST);
+    }
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Strip on GPIO %d not created: %s", CONFIG_BLINK_GPIO, esp_err_to_name(err));
+        strip = NULL;
+        return err;
+    }
+    led_strip_clear(strip);
+
+#if CONFIG_PANEL_TOWER_DITHER
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+    // SPI keeps its buffer bit-encoded: no direct frame there, set_pixel does the encoding
+    if (led_strip_get_frame(strip, &direct_frame) != ESP_OK ||
+        direct_frame.component_width != LED_STRIP_COMPONENT_WIDTH_8) {
+        direct_frame.pixels_8 = NULL;
+    }
+#endif
+    err = led_dither_start(TOWER_LEDS, push_dithered, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Dithering engine not started: %s", esp_err_to_name(err));
+        return err;
+    }
+#endif
+    err = led_anim_start(TOWER_LEDS, push_frame, NULL);
+    for (int s = 0; s < TOWER_SEGMENT_COUNT && err == ESP_OK; s++) {
+        err = led_anim_add(&segments[s].layer, segments[s].first, segments[s].count, segments[s].name);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Animation engine not started: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "%d LEDs on GPIO %d: status %d, power %d, alarm %d", TOWER_LEDS, CONFIG_BLINK_GPIO,
+             CONFIG_PANEL_TOWER_STATUS_LEDS, CONFIG_PANEL_TOWER_POWER_LEDS, CONFIG_PANEL_TOWER_ALARM_LEDS);
+    return ESP_OK;
+}
+
+void tower_light_post(tower_segment_t segment, tower_pattern_t pattern, uint32_t half_period_ms)
+{
+    tower_segment_state_t *seg = &segments[segment];
+
+    if (pattern == TOWER_PATTERN_BLINK && half_period_ms == 0) {
+        pattern = TOWER_PATTERN_ON;
+    }
+    if (pattern != TOWER_PATTERN_BLINK) {
+        half_period_ms = 0;
+    }
+    if (pattern == seg->pattern && half_period_ms == seg->half_period_ms) {
+        return;  // Same request: keep the running animation
+    }
+    seg->pattern = pattern;
+    seg->half_period_ms = half_period_ms;
+
+    switch (pattern) {
+        case TOWER_PATTERN_ON:
+            led_anim_play(&seg->layer, LED_ANIM_FADE_IN, seg->color, TOWER_FADE_MS, LED_ANIM_EASE_OUT_QUAD);
+            break;
+        case TOWER_PATTERN_BLINK:
+            led_anim_play(&seg->layer, seg->hard_blink ? LED_ANIM_BLINK : LED_ANIM_PULSE, seg->color,
+                          2 * half_period_ms, LED_ANIM_EASE_SMOOTHSTEP);
+            break;
+        default:
+            led_anim_play(&seg->layer, LED_ANIM_FADE_OUT, seg->color, TOWER_FADE_MS, LED_ANIM_EASE_IN_QUAD);
+            break;
+    }
+}
+
+void tower_light_print(void)
+{
+    static const char *patterns[] = { "OFF", "ON", "BLINK" };
+
+#if CONFIG_PANEL_TOWER_DITHER
+    printf("Tower light: %lu failed refreshes (frame counters: \"anim\", \"dither\")\n", (unsigned long)frame_errors);
+#else
+    printf("Tower light: %lu failed refreshes (frame counters: \"anim\")\n", (unsigned long)frame_errors);
+#endif
+    for (int s = 0; s < TOWER_SEGMENT_COUNT; s++) {
+        const tower_segment_state_t *seg = &segments[s];
+        if (seg->count == 0) {
+            printf("  %-6s  not fitted\n", seg->name);
+        } else if (seg->pattern == TOWER_PATTERN_BLINK) {
+            printf("  %-6s  LED %2u..%-2u  BLINK %lums\n", seg->name, seg->first,
+                   seg->first + seg->count - 1, (unsigned long)seg->half_period_ms);
+        } else {
+            printf("  %-6s  LED %2u..%-2u  %s\n", seg->name, seg->first,
+                   seg->first + seg->count - 1, patterns[seg->pattern]);
+        }
+    }
+}
+
+#if TOWER_BENCH
+
+#define BENCH_DEFAULT_PASSES  200
+#define BENCH_YIELD_US        100000    // Let lower priority tasks run during long benches
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+#define BENCH_BACKEND         "RMT"
+#else
+#define BENCH_BACKEND         "SPI"
+#endif
+
+/*
+ * BENCH ROWS:
+ *  - GRB / RGB: the driver's pixel op has the component order compiled in
+ *  - BGR / GRBW: the generic op, format looked up on every pixel
+ *  - GRB direct: inline writes into the frame, no call per pixel;
+ *    skipped on SPI, whose 8-bit buffer is bit-encoded (no frame)
+ */
+static const struct {
+    const char *name;
+    const char *pixel_op;
+    bool direct;
+    led_color_component_format_t format;
+} bench_rows[TOWER_BENCH_ROWS] = {
+    { "GRB", "fixed order", false, LED_STRIP_COLOR_COMPONENT_FMT_GRB },
+    { "RGB", "fixed order", false, LED_STRIP_COLOR_COMPONENT_FMT_RGB },
+    { "BGR", "format lookup", false, { .format = { .r_pos = 2, .g_pos = 1, .b_pos = 0, .w_pos = 3, .num_components = 3 } } },
+    { "GRBW", "format lookup", false, LED_STRIP_COLOR_COMPONENT_FMT_GRBW },
+    { "GRB", "direct frame", true, LED_STRIP_COLOR_COMPONENT_FMT_GRB },
+};
+
+/*
+ * BENCH STRIP: same backend and timing as the tower, on the bench pin.
+ * SPI joins the bus tower_light_init set up for both strips
+ * (shared_bus); nothing is sent anyway.
+ */
+static esp_err_t bench_strip_new(led_color_component_format_t format, led_strip_handle_t *ret_strip)
+{
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = CONFIG_PANEL_TOWER_BENCH_GPIO,
+        .max_leds = BENCH_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = format,
+    };
+#if CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+    led_strip_rmt_config_t rmt_config = {
+        .resolution_hz = 10 * 1000 * 1000,
+    };
+    return led_strip_new_rmt_device(&strip_config, &rmt_config, ret_strip);
+#else
+    if (strip == NULL) {
+        return ESP_ERR_INVALID_STATE;   // Bus comes with the tower strip
+    }
+    led_strip_spi_config_t spi_config = {
+        .clk_src = SPI_CLK_SRC_DEFAULT,
+        .spi_bus = SPI2_HOST,
+        .flags = {
+            .with_dma = true,
+            .shared_bus = true,
+        },
+    };
+    return led_strip_new_spi_device(&strip_config, &spi_config, ret_strip);
+#endif
+}
+
+/*
+ * BENCH:
+ *  - Every LED written once per pass through led_strip_set_pixel (the
+ *    driver's vtable) or straight into the frame, values changing
+ *    from pixel to pixel
+ *  - Only the passes are timed; the strip is never refreshed
+ */
+esp_err_t tower_light_bench(uint32_t row, uint32_t passes, tower_bench_result_t *result)
+{
+    if (row >= TOWER_BENCH_ROWS || passes == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+#if !CONFIG_BLINK_LED_STRIP_BACKEND_RMT
+    if (bench_rows[row].direct) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
+    led_strip_handle_t bench_strip;
+    esp_err_t err = bench_strip_new(bench_rows[row].format, &bench_strip);
+    if (err != ESP_OK) {
+        return err;
+    }
+    led_strip_frame_t frame = {0};
+    if (bench_rows[row].direct) {
+        err = led_strip_get_frame(bench_strip, &frame);
+        if (err != ESP_OK) {
+            led_strip_del(bench_strip);
+            return err;
+        }
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->format = bench_rows[row].name;
+    result->pixel_op = bench_rows[row].pixel_op;
+    result->leds = BENCH_LEDS;
+    result->passes = passes;
+    int64_t yield_us = esp_timer_get_time();
+
+    for (uint32_t p = 0; p < passes; p++) {
+        int64_t start_us = esp_timer_get_time();
+        if (bench_rows[row].direct) {
+            for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+                led_strip_frame_set_pixel(&frame, i, i + p, i ^ p, p);
+            }
+        } else {
+            for (uint32_t i = 0; i < BENCH_LEDS; i++) {
+                led_strip_set_pixel(bench_strip, i, i + p, i ^ p, p);
+            }
+        }
+        result->total_us += esp_timer_get_time() - start_us;
+        if (esp_timer_get_time() - yield_us > BENCH_YIELD_US) {
+            vTaskDelay(1);
+            yield_us = esp_timer_get_time();
+        }
+    }
+    return led_strip_del(bench_strip);
+}
+
+// stripbench [passes]
+static int cmd_stripbench(int argc, char **argv)
+{
+    uint32_t passes = BENCH_DEFAULT_PASSES;
+    if (argc > 1) {
+        char *end;
+        passes = strtoul(argv[1], &end, 0);
+        if (*argv[1] == '\0' || *end != '\0') {
+            printf("'%s' is not a number\n", argv[1]);
+            return 1;
+        }
+    }
+
+    printf("Backend %s, %d LEDs on GPIO %d\n", BENCH_BACKEND, BENCH_LEDS, CONFIG_PANEL_TOWER_BENCH_GPIO);
+    printf("Format  pixel op       passes  ns/pixel\n");
+    for (uint32_t row = 0; row < TOWER_BENCH_ROWS; row++) {
+        tower_bench_result_t r;
+        esp_err_t err = tower_light_bench(row, passes, &r);
+        if (err == ESP_ERR_NOT_SUPPORTED) {
+            printf("%-6s  %-13s  skipped, no direct frame on %s\n", bench_rows[row].name, bench_rows[row].pixel_op, BENCH_BACKEND);
+            continue;
+        }
+        if (err != ESP_OK) {
+            printf("%-6s  failed: %s\n", bench_rows[row].name, esp_err_to_name(err));
+            return 1;
+        }
+        printf("%-6s  %-13s  %6lu  %8lld\n", r.format, r.pixel_op, (unsigned long)r.passes,
+               (long long)(r.total_us * 1000 / ((int64_t)r.passes * r.leds)));
+    }
+    return 0;
+}
+
+esp_err_t tower_light_register_console(void)
+{
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "stripbench",
+            .help = "Time led_strip_set_pixel per colour format and direct frame writes on the bench pin (default 200 passes)",
+            .hint = "[passes]",
+            .func = &cmd_stripbench,
+        },
+    };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        esp_err_t err = esp_console_cmd_register(&commands[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+#else  // !TOWER_BENCH
+
+esp_err_t tower_light_bench(uint32_t row, uint32_t passes, tower_bench_result_t *result)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t tower_light_register_console(void)
+{
+    return ESP_OK;
+}
+
+#endif
+
+#else  // !CONFIG_PANEL_TOWER_LIGHT
+
+esp_err_t tower_light_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void tower_light_post(tower_segment_t segment, tower_pattern_t pattern, uint32_t half_period_ms)
+{
+}
+
+void tower_light_print(void)
+{
+}
+
+esp_err_t tower_light_bench(uint32_t row, uint32_t passes, tower_bench_result_t *result)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t tower_light_register_console(void)
+{
+    return ESP_OK;
+}
+
+#endif
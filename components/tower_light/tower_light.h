@@ -0,0 +1,96 @@
+#ifndef TOWER_LIGHT_H
+#define TOWER_LIGHT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * LED Strip Tower Light
+ * ---------------------
+ * A signal tower built from one WS2812 strip: one data pin, any
+ * number of LEDs, split into segments (from the strip input up):
+ *  - STATUS (blue):  mode indication
+ *  - POWER  (green): power state / boot sequence
+ *  - ALARM  (red):   E-STOP alarm
+ * 
+ * Each segment shows OFF / ON / BLINK like a single lamp, drawn as a
+ * layer of the animation engine (led_anim.h): switching fades in and
+ * out, the alarm blinks hard, power and mode pulse smoothly. The
+ * engine sends ALL segments in ONE refresh per frame, and no frames
+ * at all while the tower is steady. Fades are rendered in 16 bits and
+ * dithered down to the 8-bit strip (led_dither.h), so they stay smooth
+ * at the low panel brightness.
+ * 
+ * Strip pin and backend (RMT / SPI): menuconfig → "Example
+ * Configuration" (BLINK_LED_STRIP, BLINK_GPIO). Segment sizes and
+ * brightness: menuconfig → "Tower Light".
+ *
+ * Console: "stripbench" times led_strip_set_pixel for GRB (the
+ * tower's format, component order compiled into the driver) against
+ * formats the driver looks up per pixel, and direct frame writes
+ * (led_strip_get_frame) against both (PANEL_TOWER_BENCH_GPIO).
+ */
+
+typedef enum {
+    TOWER_SEGMENT_STATUS = 0,
+    TOWER_SEGMENT_POWER,
+    TOWER_SEGMENT_ALARM,
+    TOWER_SEGMENT_COUNT,
+} tower_segment_t;
+
+typedef enum {
+    TOWER_PATTERN_OFF = 0,
+    TOWER_PATTERN_ON,
+    TOWER_PATTERN_BLINK,
+} tower_pattern_t;
+
+#define TOWER_BENCH_ROWS  5       // Format / pixel write pairs timed by tower_light_bench
+
+// Result of one benchmark row (tower_light_bench)
+typedef struct {
+    const char *format;         // "GRB", "RGB", "BGR", "GRBW"
+    const char *pixel_op;       // "fixed order", "format lookup" (led_strip_set_pixel) or "direct frame"
+    uint32_t leds;
+    uint32_t passes;
+    int64_t total_us;           // Time spent inside the set_pixel passes only
+} tower_bench_result_t;
+
+/*
+ * @brief Create the strip device and start the animation engine on it
+ * 
+ * @return ESP_ERR_NOT_SUPPORTED without CONFIG_PANEL_TOWER_LIGHT
+ */
+esp_err_t tower_light_init(void);
+
+/*
+ * @brief Set a segment pattern (owner task only)
+ * 
+ * Posting the same pattern again does nothing (a running blink keeps
+ * its phase).
+ */
+void tower_light_post(tower_segment_t segment, tower_pattern_t pattern, uint32_t half_period_ms);
+
+// Print segments and their patterns (frames: "anim" command)
+void tower_light_print(void);
+
+/*
+ * @brief Time one way of writing pixels for one colour format
+ *
+ * Creates a strip of that format on PANEL_TOWER_BENCH_GPIO (tower
+ * backend, nothing sent), writes every LED 'passes' times through
+ * led_strip_set_pixel or its direct frame, and deletes it again.
+ * CPU cost only.
+ *
+ * @param row  0 .. TOWER_BENCH_ROWS - 1
+ * @return ESP_ERR_NOT_SUPPORTED without a bench pin, or for the
+ *         direct frame row on SPI (8-bit buffer kept bit-encoded),
+ *         ESP_ERR_INVALID_STATE on SPI before tower_light_init()
+ */
+esp_err_t tower_light_bench(uint32_t row, uint32_t passes, tower_bench_result_t *result);
+
+// Add the "stripbench" command (if there is a bench pin)
+esp_err_t tower_light_register_console(void);
+
+#endif
@@ -2,11 +2,19 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_err.h"
 
 // Our three training demos
 #include "emergency.h"        // Single press toggle emergency alarm
 #include "mode_selector.h"    // Multi-press mode selection (MANUAL/AUTO/MAINT)
 #include "long_press_power.h" // Long-press power on/off controller
+#include "fast_boot.h"        // Restore last state right after reset
+#include "panel_pm.h"         // Light sleep while the panel is idle
+#include "task_monitor.h"     // CPU / stack / loop timing per task
+#include "input_bus.h"        // Buttons configured once, events to every subscriber
+#include "panel_output.h"     // Shared lamps: highest-priority request wins
+#include "panel_manager.h"    // Many button/lamp channels from one task
+#include "panel_console.h"    // start / stop / status / press commands
 
 #define TAG "MAIN_CONTROL_PANEL"
 
@@ -14,25 +22,96 @@
  * HOW TO USE THIS MAIN FILE (FOR TRAINEES):
  * ----------------------------------------
  * We have 3 separate applications, each in its own .c/.h file:
- *  1) Emergency alarm     → emergency_alarm_run()
- *  2) Mode selector       → mode_selector_run()
- *  3) Long-press power    → long_press_power_run()
+ *  1) Emergency alarm     → emergency_alarm_start()
+ *  2) Mode selector       → mode_selector_start()
+ *  3) Long-press power    → long_press_power_start()
  * 
- * To run a specific demo:
- *  - Go to app_main()
- *  - Comment out the others
- *  - Uncomment the one you want to try
+ * To choose the demos:
+ *  - idf.py menuconfig → "Control Panel Demos"
+ *  - Pins and timing of each demo live in their own menus
+ *    ("Emergency Alarm", "Mode Selector", "Long-Press Power")
  * 
- * Only ONE of these functions should be active at a time because
- * each contains an infinite while(1) loop.
+ * Every enabled demo runs in its own FreeRTOS task, so several can
+ * be active at once. Demos MAY share pins:
+ *  - A button: the input bus hands every press to all of them
+ *  - A lamp:   the output manager shows the highest priority
+ *              (alarm > power > mode indication)
+ * 
+ * COMMISSIONING CONSOLE:
+ *  - "help" on the serial monitor lists the commands
+ *  - "start mode 0 4 26" runs a demo without reflashing,
+ *    "press power 3500" simulates a long press
+ * 
+ * FAST RESTORE:
+ *  - The *_fast_restore() calls at the top of app_main() put the
+ *    lamps back to the last state before anything else.
  */
 
 void app_main(void)
 {
+#if CONFIG_PANEL_RUN_EMERGENCY
+    static const emergency_config_t emergency_cfg = EMERGENCY_CONFIG_DEFAULT();
+#endif
+#if CONFIG_PANEL_RUN_MODE_SELECTOR
+    static const mode_selector_config_t mode_cfg = MODE_SELECTOR_CONFIG_DEFAULT();
+#endif
+#if CONFIG_PANEL_RUN_LONG_PRESS_POWER
+    static const long_press_power_config_t power_cfg = LONG_PRESS_POWER_CONFIG_DEFAULT();
+#endif
+
+    /*
+     * FAST-BOOT PATH (must stay first):
+     *  - After a soft reset / watchdog / brownout the last alarm, mode
+     *    or power state is read back from RTC memory
+     *  - Lamps are driven immediately, before logging and button setup
+     *  - After a cold power-on these calls do nothing
+     */
+    fast_boot_mark("app_main entry");
+#if CONFIG_PANEL_RUN_EMERGENCY
+    emergency_alarm_fast_restore(&emergency_cfg);
+#endif
+#if CONFIG_PANEL_RUN_MODE_SELECTOR
+    mode_selector_fast_restore(&mode_cfg);
+#endif
+#if CONFIG_PANEL_RUN_LONG_PRESS_POWER
+    long_press_power_fast_restore(&power_cfg);
+#endif
+    fast_boot_mark("outputs restored");
+
+    /*
+     * POWER MANAGEMENT:
+     *  - With CONFIG_PM_ENABLE + tickless idle the chip light-sleeps
+     *    whenever every demo loop is waiting for its button or LED timer
+     */
+    panel_pm_init();
+
+    /*
+     * TASK MONITOR:
+     *  - Low-priority sampler: CPU %, free stack, loop timing per task
+     *  - Logged every CONFIG_TASK_MONITOR_LOG_PERIOD samples
+     */
+    task_monitor_start();
+
+    /*
+     * INPUT BUS (before the demos):
+     *  - Owns every button pin: one interrupt, one debounce per pin
+     *  - Each demo subscribes to its button and gets its own event queue
+     */
+    ESP_ERROR_CHECK(input_bus_start());
+
+    /*
+     * OUTPUT MANAGER (before the demos):
+     *  - Owns every lamp pin, composites the demos' requests
+     *  - Keeps the fast-restored levels until the demos take over
+     *  - With an LED strip ("Tower Light" menu) it also drives the
+     *    alarm / power / mode segments of the signal tower
+     */
+    ESP_ERROR_CHECK(panel_output_start());
+
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "Industrial Automation Training - Button & LED Demos");
     ESP_LOGI(TAG, "Board: ESP32  |  OS: FreeRTOS");
-    ESP_LOGI(TAG, "Select which demo to run by editing app_main()");
+    ESP_LOGI(TAG, "Select the demos in menuconfig → Control Panel Demos");
     ESP_LOGI(TAG, "========================================");
     
     /*
@@ -43,7 +122,9 @@ void app_main(void)
      * Typical use:
      *  - Panic/E-STOP button indicator
      */
-    // emergency_alarm_run();
+#if CONFIG_PANEL_RUN_EMERGENCY
+    ESP_ERROR_CHECK(emergency_alarm_start(&emergency_cfg));
+#endif
     
     /*
      * DEMO 2: Machine Mode Selector
@@ -53,7 +134,9 @@ void app_main(void)
      *  
      * LED blink speed shows current mode.
      */
-    // mode_selector_run();
+#if CONFIG_PANEL_RUN_MODE_SELECTOR
+    ESP_ERROR_CHECK(mode_selector_start(&mode_cfg));
+#endif
     
     /*
      * DEMO 3: Long-Press Power Control
@@ -61,12 +144,32 @@ void app_main(void)
      *  - Short presses are ignored (safety)
      *  - LED shows power state (OFF/BOOTING/ON/SHUTTING_DOWN)
      */
-    long_press_power_run();
+#if CONFIG_PANEL_RUN_LONG_PRESS_POWER
+    ESP_ERROR_CHECK(long_press_power_start(&power_cfg));
+#endif
+
+    /*
+     * PANEL MANAGER: many channels, one task
+     *  - Each channel: button + lamp + TOGGLE / CYCLE / LONG_PRESS
+     *  - For 20-40 buttons instead of one demo task per button
+     *  - "channel add ..." on the console, "panelbench" for the cost
+     */
+#if CONFIG_PANEL_RUN_PANEL_MANAGER
+    ESP_ERROR_CHECK(panel_manager_start());
+#endif
+
+    /*
+     * CONSOLE (last, after the boot log):
+     *  - Demos can also be started / stopped / driven from here
+     */
+#if CONFIG_PANEL_CONSOLE_ENABLE
+    ESP_ERROR_CHECK(panel_console_start());
+#endif
     
     /*
      * NOTE:
-     *  The selected function above never returns (infinite loop).
-     *  In advanced projects, each demo would run in its own FreeRTOS task
-     *  and a higher-level menu would control which task is active.
+     *  app_main() returns here - the demo tasks keep running.
+     *  A second E-STOP station, for example, is just another config
+     *  with its own pins and .instance = 1 passed to *_start().
      */
 }
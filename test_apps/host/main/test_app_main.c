@@ -0,0 +1,14 @@
+#include "unity.h"
+
+/*
+ * Host test runner (ESP-IDF Linux target)
+ * ---------------------------------------
+ * Runs every TEST_CASE of this app once and prints the Unity summary,
+ * which pytest_host.py checks.
+ */
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include "unity.h"
+#include "emergency.h"
+#include "input_bus.h"
+#include "panel_output.h"
+#include "gpio_sim.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+ * E-STOP LATCH THROUGH THE SIMULATED PIN:
+ * ---------------------------------------
+ * gpio_sim runs the button interrupt inside gpio_sim_set_input(), so
+ * the lamp must already be ON when that call returns. The test task
+ * runs above every panel task: the bus samples the pin only when the
+ * test sleeps, as if the edge hit while the bus was waiting.
+ */
+
+static const emergency_config_t estop_cfg = EMERGENCY_CONFIG_DEFAULT();
+
+static void estop_start(void)
+{
+    static bool panel_started = false;  // Bus and output manager live for the whole app
+    if (!panel_started) {
+        TEST_ASSERT_EQUAL(ESP_OK, input_bus_start());
+        TEST_ASSERT_EQUAL(ESP_OK, panel_output_start());
+        panel_started = true;
+    }
+    vTaskPrioritySet(NULL, configMAX_PRIORITIES - 1);
+    gpio_sim_set_input(estop_cfg.button_pin, 1);
+    TEST_ASSERT_EQUAL(ESP_OK, emergency_alarm_start(&estop_cfg));
+    vTaskDelay(pdMS_TO_TICKS(100));  // Loop ready, latch armed
+}
+
+static void estop_stop(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, emergency_alarm_stop(estop_cfg.instance));
+    vTaskPrioritySet(NULL, 1);
+}
+
+// Operator press held past the debounce, then released
+static void estop_press(void)
+{
+    gpio_sim_set_input(estop_cfg.button_pin, 0);
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    gpio_sim_set_input(estop_cfg.button_pin, 1);
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+}
+
+static emergency_status_t estop_status(void)
+{
+    emergency_status_t status;
+    TEST_ASSERT_EQUAL(ESP_OK, emergency_alarm_get_status(estop_cfg.instance, &status));
+    return status;
+}
+
+TEST_CASE("E-STOP edge switches the lamp within the reaction bound", "[estop]")
+{
+    estop_start();
+    TEST_ASSERT_EQUAL(0, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+
+    int64_t edge_us = esp_timer_get_time();
+    gpio_sim_set_input(estop_cfg.button_pin, 0);
+    int64_t lamp_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(1, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(CONFIG_EMERGENCY_REACTION_BOUND_US, lamp_us - edge_us);
+
+    // Debounce confirms the press: the latch becomes the alarm
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    gpio_sim_set_input(estop_cfg.button_pin, 1);
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    emergency_status_t status = estop_status();
+    TEST_ASSERT_TRUE(status.alarm_active);
+    TEST_ASSERT_EQUAL_UINT32(1, status.alarm_count);
+    TEST_ASSERT_EQUAL_UINT32(1, status.isr_latches);
+    TEST_ASSERT_EQUAL_UINT32(0, status.glitches);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(CONFIG_EMERGENCY_REACTION_BOUND_US, status.busy_max_us);
+
+    // Acknowledge: task only, lamp released
+    estop_press();
+    TEST_ASSERT_FALSE(estop_status().alarm_active);
+    TEST_ASSERT_EQUAL(0, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+    estop_stop();
+}
+
+TEST_CASE("E-STOP spike gone before the bus samples releases the lamp and re-arms", "[estop]")
+{
+    estop_start();
+    gpio_sim_set_input(estop_cfg.button_pin, 0);
+    TEST_ASSERT_EQUAL(1, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+    gpio_sim_set_input(estop_cfg.button_pin, 1);  // Bus has not run yet
+
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    emergency_status_t status = estop_status();
+    TEST_ASSERT_FALSE(status.alarm_active);
+    TEST_ASSERT_EQUAL_UINT32(1, status.glitches);
+    TEST_ASSERT_EQUAL(0, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+
+    // Latch armed again: the next edge is caught in the interrupt
+    gpio_sim_set_input(estop_cfg.button_pin, 0);
+    TEST_ASSERT_EQUAL(1, gpio_sim_get_output(estop_cfg.alarm_led_pin));
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    gpio_sim_set_input(estop_cfg.button_pin, 1);
+    vTaskDelay(pdMS_TO_TICKS(2 * estop_cfg.debounce_ms));
+    TEST_ASSERT_TRUE(estop_status().alarm_active);
+
+    estop_press();
+    TEST_ASSERT_FALSE(estop_status().alarm_active);
+    estop_stop();
+}
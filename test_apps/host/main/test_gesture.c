@@ -0,0 +1,117 @@
+#include "unity.h"
+#include "gesture.h"
+
+/*
+ * GESTURE RECOGNIZER:
+ * -------------------
+ * Edges and polls are fed with plain timestamps, so every threshold
+ * is checked to the millisecond. Default config: click window 400 ms,
+ * long press 1000 ms, up to 3 clicks.
+ */
+
+static gesture_t g;
+static gesture_event_t event;
+
+static void start(uint32_t repeat_interval_ms)
+{
+    gesture_config_t cfg = GESTURE_CONFIG_DEFAULT();
+    cfg.repeat_interval_ms = repeat_interval_ms;
+    gesture_init(&g, &cfg);
+}
+
+TEST_CASE("tap released before the hold threshold is a click", "[gesture]")
+{
+    start(0);
+    TEST_ASSERT_FALSE(gesture_feed(&g, true, 0, &event));
+    TEST_ASSERT_EQUAL_UINT32(1000, gesture_ms_to_deadline(&g, 0));
+    TEST_ASSERT_FALSE(gesture_poll(&g, 999, &event));
+    TEST_ASSERT_FALSE(gesture_feed(&g, false, 999, &event));
+
+    // One click is only reported once the window for a second one closed
+    TEST_ASSERT_EQUAL_UINT32(400, gesture_ms_to_deadline(&g, 999));
+    TEST_ASSERT_FALSE(gesture_poll(&g, 1398, &event));
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1399, &event));
+    TEST_ASSERT_EQUAL(GESTURE_CLICK, event.type);
+    TEST_ASSERT_EQUAL_UINT8(1, event.clicks);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_NO_DEADLINE, gesture_ms_to_deadline(&g, 1399));
+}
+
+TEST_CASE("hold reaching the threshold is a long press, not a click", "[gesture]")
+{
+    start(0);
+    gesture_feed(&g, true, 0, &event);
+    TEST_ASSERT_FALSE(gesture_poll(&g, 999, &event));
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1000, &event));
+    TEST_ASSERT_EQUAL(GESTURE_LONG_PRESS, event.type);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_NO_DEADLINE, gesture_ms_to_deadline(&g, 1000));
+
+    TEST_ASSERT_TRUE(gesture_feed(&g, false, 1500, &event));
+    TEST_ASSERT_EQUAL(GESTURE_LONG_RELEASE, event.type);
+    TEST_ASSERT_FALSE(gesture_poll(&g, 5000, &event));
+}
+
+TEST_CASE("second press inside the click window makes a double click", "[gesture]")
+{
+    start(0);
+    gesture_feed(&g, true, 0, &event);
+    gesture_feed(&g, false, 100, &event);
+    TEST_ASSERT_FALSE(gesture_feed(&g, true, 499, &event));  // 399 ms after the release
+    TEST_ASSERT_FALSE(gesture_feed(&g, false, 600, &event));
+    TEST_ASSERT_FALSE(gesture_poll(&g, 999, &event));
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1000, &event));
+    TEST_ASSERT_EQUAL(GESTURE_CLICK, event.type);
+    TEST_ASSERT_EQUAL_UINT8(2, event.clicks);
+}
+
+TEST_CASE("press after the click window closed starts a new sequence", "[gesture]")
+{
+    start(0);
+    gesture_feed(&g, true, 0, &event);
+    gesture_feed(&g, false, 100, &event);
+
+    // Nobody polled at 500: the press itself reports the finished single click
+    TEST_ASSERT_TRUE(gesture_feed(&g, true, 500, &event));
+    TEST_ASSERT_EQUAL(GESTURE_CLICK, event.type);
+    TEST_ASSERT_EQUAL_UINT8(1, event.clicks);
+    TEST_ASSERT_EQUAL_UINT32(500, event.time_ms);
+
+    gesture_feed(&g, false, 600, &event);
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1000, &event));
+    TEST_ASSERT_EQUAL_UINT8(1, event.clicks);
+}
+
+TEST_CASE("max_clicks reports at once without waiting for the window", "[gesture]")
+{
+    start(0);
+    for (uint32_t t = 0; t < 400; t += 200) {
+        TEST_ASSERT_FALSE(gesture_feed(&g, true, t, &event));
+        TEST_ASSERT_FALSE(gesture_feed(&g, false, t + 100, &event));
+    }
+    gesture_feed(&g, true, 400, &event);
+    TEST_ASSERT_TRUE(gesture_feed(&g, false, 500, &event));
+    TEST_ASSERT_EQUAL(GESTURE_CLICK, event.type);
+    TEST_ASSERT_EQUAL_UINT8(3, event.clicks);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_NO_DEADLINE, gesture_ms_to_deadline(&g, 500));
+}
+
+TEST_CASE("release during hold repeat ends the hold", "[gesture]")
+{
+    start(200);
+    gesture_feed(&g, true, 0, &event);
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1000, &event));
+    TEST_ASSERT_EQUAL(GESTURE_LONG_PRESS, event.type);
+    TEST_ASSERT_EQUAL_UINT32(200, gesture_ms_to_deadline(&g, 1000));
+
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1200, &event));
+    TEST_ASSERT_EQUAL(GESTURE_HOLD_REPEAT, event.type);
+    TEST_ASSERT_EQUAL_UINT16(1, event.repeats);
+    TEST_ASSERT_TRUE(gesture_poll(&g, 1400, &event));
+    TEST_ASSERT_EQUAL_UINT16(2, event.repeats);
+
+    // Released between two repeats: no further repeat, no click
+    TEST_ASSERT_TRUE(gesture_feed(&g, false, 1500, &event));
+    TEST_ASSERT_EQUAL(GESTURE_LONG_RELEASE, event.type);
+    TEST_ASSERT_EQUAL_UINT16(2, event.repeats);
+    TEST_ASSERT_EQUAL_UINT32(GESTURE_NO_DEADLINE, gesture_ms_to_deadline(&g, 1500));
+    TEST_ASSERT_FALSE(gesture_poll(&g, 1600, &event));
+}
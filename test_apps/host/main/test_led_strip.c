@@ -0,0 +1,167 @@
+#include <string.h>
+#include "unity.h"
+#include "led_strip.h"
+#include "led_strip_virtual.h"
+#include "led_strip_sim.h"
+
+/*
+ * LED STRIP ON THE SIMULATED PERIPHERALS:
+ * ---------------------------------------
+ * led_strip_sim records per GPIO the bytes of the last transfer in
+ * wire order, so every case checks what the LEDs would receive.
+ * Each case runs on the RMT and on the SPI backend.
+ */
+
+#define STRIP_GPIO  8
+#define STRIP_LEDS  4
+
+static led_strip_handle_t strip_new(bool spi, led_color_component_format_t format)
+{
+    led_strip_config_t config = {
+        .strip_gpio_num = STRIP_GPIO,
+        .max_leds = STRIP_LEDS,
+        .led_model = LED_MODEL_WS2812,
+        .color_component_format = format,
+    };
+    led_strip_handle_t strip = NULL;
+    if (spi) {
+        led_strip_spi_config_t spi_config = { .spi_bus = SPI2_HOST };
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_spi_device(&config, &spi_config, &strip));
+    } else {
+        led_strip_rmt_config_t rmt_config = { .resolution_hz = 10 * 1000 * 1000 };
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_rmt_device(&config, &rmt_config, &strip));
+    }
+    led_strip_sim_reset();
+    return strip;
+}
+
+// Last transfer on the strip GPIO, 0 transfers if there was none
+static led_strip_sim_line_t wire(uint8_t *data)
+{
+    led_strip_sim_line_t line = { 0 };
+    memset(data, 0xEE, 3 * STRIP_LEDS);
+    led_strip_sim_get(STRIP_GPIO, &line, data, 3 * STRIP_LEDS);
+    return line;
+}
+
+static void check_index_bounds(bool spi)
+{
+    led_strip_handle_t strip = strip_new(spi, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(strip, STRIP_LEDS - 1, 1, 2, 3));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixel(strip, STRIP_LEDS, 1, 2, 3));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixel(strip, UINT32_MAX, 1, 2, 3));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_del(strip));
+}
+
+static void check_component_order(bool spi)
+{
+    uint8_t data[3 * STRIP_LEDS];
+    led_strip_handle_t strip = strip_new(spi, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    led_strip_set_pixel(strip, 1, 0x11, 0x22, 0x33);
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+    const uint8_t grb[] = { 0, 0, 0, 0x22, 0x11, 0x33 };
+    wire(data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(grb, data, sizeof(grb));
+    led_strip_del(strip);
+
+    strip = strip_new(spi, LED_STRIP_COLOR_COMPONENT_FMT_RGB);
+    led_strip_set_pixel(strip, 1, 0x11, 0x22, 0x33);
+    led_strip_refresh(strip);
+    const uint8_t rgb[] = { 0, 0, 0, 0x11, 0x22, 0x33 };
+    wire(data);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(rgb, data, sizeof(rgb));
+    led_strip_del(strip);
+}
+
+static void check_clear(bool spi)
+{
+    uint8_t data[3 * STRIP_LEDS];
+    led_strip_handle_t strip = strip_new(spi, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+    for (uint32_t i = 0; i < STRIP_LEDS; i++) {
+        led_strip_set_pixel(strip, i, 255, 128, 1);
+    }
+    led_strip_refresh(strip);
+
+    // Clear is sent at once, and later refreshes do not bring the old frame back
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_clear(strip));
+    led_strip_sim_line_t line = wire(data);
+    TEST_ASSERT_EQUAL_UINT32(2, line.transfers);
+    TEST_ASSERT_EACH_EQUAL_HEX8(0, data, sizeof(data));
+    led_strip_refresh(strip);
+    wire(data);
+    TEST_ASSERT_EACH_EQUAL_HEX8(0, data, sizeof(data));
+    led_strip_del(strip);
+}
+
+static void check_refresh(bool spi)
+{
+    uint8_t data[3 * STRIP_LEDS];
+    led_strip_handle_t strip = strip_new(spi, LED_STRIP_COLOR_COMPONENT_FMT_GRB);
+
+    // set_pixel only changes the buffer: nothing on the wire until refresh
+    led_strip_set_pixel(strip, 0, 1, 2, 3);
+    TEST_ASSERT_EQUAL_UINT32(0, wire(data).transfers);
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh(strip));
+    led_strip_sim_line_t line = wire(data);
+    TEST_ASSERT_EQUAL_UINT32(1, line.transfers);
+    TEST_ASSERT_EQUAL(3 * STRIP_LEDS, line.len);
+    TEST_ASSERT_GREATER_THAN(0, line.wire_us);
+
+    // Every refresh sends the whole frame again, async as well
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_async(strip));
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_refresh_wait_done(strip));
+    line = wire(data);
+    TEST_ASSERT_EQUAL_UINT32(2, line.transfers);
+    const uint8_t first[] = { 2, 1, 3 };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(first, data, sizeof(first));
+    led_strip_del(strip);
+}
+
+TEST_CASE("set_pixel rejects indexes past max_leds", "[led_strip]")
+{
+    check_index_bounds(false);
+    check_index_bounds(true);
+}
+
+TEST_CASE("GRB and RGB strips send components in their order", "[led_strip]")
+{
+    check_component_order(false);
+    check_component_order(true);
+}
+
+TEST_CASE("clear sends an all-off frame", "[led_strip]")
+{
+    check_clear(false);
+    check_clear(true);
+}
+
+TEST_CASE("refresh sends the whole frame once per call", "[led_strip]")
+{
+    check_refresh(false);
+    check_refresh(true);
+}
+
+TEST_CASE("serpentine segment with a short last row stays inside the segment", "[led_strip]")
+{
+    uint8_t data[3 * STRIP_LEDS];
+    led_strip_handle_t strip = strip_new(false, LED_STRIP_COLOR_COMPONENT_FMT_RGB);
+
+    // 3 LEDs in rows of 2: the second row holds 1 LED
+    led_strip_segment_t segment = { .strip = strip, .first = 1, .count = 3, .serpentine_width = 2 };
+    led_strip_virtual_config_t config = { .segments = &segment, .num_segments = 1 };
+    led_strip_handle_t virt = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_strip_new_virtual(&config, &virt));
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, led_strip_set_pixel(virt, i, i + 1, 0, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_strip_set_pixel(virt, 3, 9, 0, 0));
+    led_strip_refresh(virt);
+
+    // LED 0 untouched, then the segment in order
+    wire(data);
+    const uint8_t expected[] = { 0, 0, 0, 1, 0, 0, 2, 0, 0, 3, 0, 0 };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, data, sizeof(expected));
+    led_strip_del(virt);
+    led_strip_del(strip);
+}
@@ -0,0 +1,14 @@
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+from pytest_embedded_idf.utils import idf_parametrize
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_panel_host(dut: IdfDut) -> None:
+    # Unity summary printed by UNITY_END() in test_app_main.c
+    match = dut.expect(r'(\d+) Tests (\d+) Failures (\d+) Ignored', timeout=120)
+    assert int(match.group(1)) > 0
+    assert int(match.group(2)) == 0